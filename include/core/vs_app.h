@@ -1,7 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <map>
+#include <memory>
 #include <string>
 #include <thread>
 
@@ -9,6 +11,7 @@ class VSUI;
 class VSWorld;
 class VSGame;
 class VSInputHandler;
+class VSThreadPool;
 
 struct GLFWwindow;
 
@@ -17,6 +20,9 @@ class VSApp
 public:
     VSApp();
 
+    // Stops the thread pool if mainLoop did not run or returned early
+    ~VSApp();
+
     int initialize();
 
     int mainLoop();
@@ -35,6 +41,9 @@ public:
 
     [[nodiscard]] GLFWwindow* getWindow() const;
 
+    // Workers for background jobs like chunk visibility and shadow updates
+    [[nodiscard]] VSThreadPool* getThreadPool() const;
+
     [[nodiscard]] std::chrono::high_resolution_clock::time_point getStartTime() const;
 
     static VSApp* getInstance();
@@ -50,12 +59,20 @@ private:
 
     VSInputHandler* inputHandler;
 
+    std::unique_ptr<VSThreadPool> threadPool;
+
     GLFWwindow* window;
 
     std::string glslVersion;
 
     std::chrono::high_resolution_clock::time_point appStart;
 
+    // Rays (and as many sun queries) per run of the debug UI's trace benchmark
+    static constexpr std::size_t traceBenchmarkRayCount = 100000;
+
+    // Chunk sized tiles per run of the debug UI's noise benchmark
+    static constexpr std::size_t noiseBenchmarkTileCount = 256;
+
     static VSApp* instance;
 
     int initializeGLFW();
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run submitted jobs.
+// Every worker owns a queue, submitted jobs are spread round robin over the queues. A worker takes
+// the oldest job of its own queue and steals the newest job of another queue once its own is
+// empty, so a few long jobs do not hold back the rest.
+// Jobs are not cancelled by the pool, long running jobs have to check a flag themselves.
+// Jobs still queued when the pool is destroyed are run before the workers stop.
+class VSThreadPool
+{
+public:
+    using VSJob = std::function<void()>;
+
+    // threadCount 0 picks std::thread::hardware_concurrency (or 4 if that is unknown)
+    explicit VSThreadPool(std::size_t threadCount = 0);
+
+    ~VSThreadPool();
+
+    VSThreadPool(VSThreadPool const&) = delete;
+    VSThreadPool& operator=(VSThreadPool const&) = delete;
+
+    void submit(VSJob job);
+
+    // Runs task(0) to task(taskCount - 1) on the workers and the calling thread, returns once all
+    // of them are done. Tasks are taken from a shared counter, so the calling thread finishes the
+    // loop on its own if every worker is busy. This also makes it safe to call from a job.
+    void parallelFor(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+
+    [[nodiscard]] std::size_t getThreadCount() const;
+
+    // Jobs submitted but not yet picked up by a worker
+    [[nodiscard]] std::size_t getQueuedJobCount() const;
+
+    [[nodiscard]] std::size_t getRunningJobCount() const;
+
+    [[nodiscard]] std::uint64_t getCompletedJobCount() const;
+
+    // Average time between submit and a worker starting the job
+    [[nodiscard]] float getAverageJobLatencyMilliseconds() const;
+
+    // Average time a worker spent running a job
+    [[nodiscard]] float getAverageJobRunMilliseconds() const;
+
+private:
+    using VSClock = std::chrono::steady_clock;
+
+    struct VSQueuedJob
+    {
+        VSJob job;
+        VSClock::time_point submitTime;
+    };
+
+    struct VSWorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<VSQueuedJob> jobs;
+    };
+
+    std::vector<std::unique_ptr<VSWorkerQueue>> queues;
+
+    std::vector<std::thread> workers;
+
+    std::atomic<std::size_t> nextQueue = 0;
+
+    std::atomic<std::size_t> queuedJobCount = 0;
+
+    std::atomic<std::size_t> runningJobCount = 0;
+
+    std::atomic<std::uint64_t> completedJobCount = 0;
+
+    std::atomic<std::uint64_t> jobLatencyNanoseconds = 0;
+
+    std::atomic<std::uint64_t> jobRunNanoseconds = 0;
+
+    std::mutex wakeMutex;
+
+    std::condition_variable wakeCondition;
+
+    bool bShouldStop = false;
+
+    void workerLoop(std::size_t workerIndex);
+
+    bool popJob(std::size_t workerIndex, VSQueuedJob& outJob);
+};
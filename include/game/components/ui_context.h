@@ -6,6 +6,8 @@
 #include <filesystem>
 #include <imgui.h>
 #include <array>
+#include <cstdint>
+#include <random>
 #include <string>
 #include "renderer/vs_textureloader.h"
 #include "ui/imgui_impl/imfilebrowser.h"
@@ -48,6 +50,8 @@ struct UIContext
 
     // Game config
     int worldSize = 0;  // 0 = Small, 1 = Medium, 2 = Large
+    // Drives the terrain generation, the same seed gives the same world
+    std::uint32_t worldSeed = std::random_device()();
 
     // Minimap
     Minimap minimap;
@@ -2,6 +2,7 @@
 
 #include <entt/entity/entity.hpp>
 #include <entt/entity/fwd.hpp>
+#include <glm/common.hpp>
 #include "game/components/bounds.h"
 #include "game/components/location.h"
 #include "game/components/ui_context.h"
@@ -19,16 +20,8 @@ void deleteSelectedBuilding(entt::registry& mainRegistry, entt::registry& buildi
     const auto low = location + bounds.min;
     const auto high = location + bounds.max;
 
-    for (int x = low.x; x < high.x; x++)
-    {
-        for (int y = low.y; y < high.y; y++)
-        {
-            for (int z = low.z; z < high.z; z++)
-            {
-                worldContext.world->getChunkManager()->setBlock({x, y, z}, 0);
-            }
-        }
-    }
+    worldContext.world->getChunkManager()->fillBlocks(
+        glm::ivec3(low), glm::ivec3(glm::ceil(high)), 0);
 
     (void) buildingRegistry;
     unemployPopulationFromEntity(mainRegistry, buildingRegistry, uiContext.selectedBuildingEntity);
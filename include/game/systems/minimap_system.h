@@ -28,10 +28,12 @@ void updateMinimapSystem(entt::registry& mainRegistry)
         {
             for (int j = -minimap.height / 2; j < minimap.height / 2; j++)
             {
-                for (int y = worldSizeHalf.y - 1; y >= -worldSizeHalf.y; y--)
+                int x = (int)std::round(i * stepX);
+                int z = (int)std::round(j * stepZ);
+                // Highest block of the column from the heightmap
+                int y = chunkManager->getSurfaceHeight(x, z) - 1;
+                if (y >= -worldSizeHalf.y)
                 {
-                    int x = (int)std::round(i * stepX);
-                    int z = (int)std::round(j * stepZ);
                     VSBlockID blockID = chunkManager->getBlock({x, y, z});
                     if (blockID > 0 && blockID < minimap.blockID2MinimapColor.size())
                     {
@@ -47,8 +49,6 @@ void updateMinimapSystem(entt::registry& mainRegistry)
                             (j + minimap.height / 2) * minimap.width * minimap.nrComponents +
                             (i + minimap.width / 2) * minimap.nrComponents + 2) =
                             minimap.blockID2MinimapColor.at(blockID).z;
-                        // TODO: Are breaks still cool? Otherwise will do a while loop
-                        break;
                     }
                 }
             }
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <map>
+
+// GPU resident buffer of fixed size elements (e.g. instance data) which hands out ranges.
+// A range keeps its content until it is freed, so data only has to be uploaded when it changes.
+// Growing the buffer copies the existing content on the GPU, the buffer name changes in that case.
+// Offsets and counts are in elements, not bytes.
+class VSInstanceBuffer
+{
+public:
+    struct VSRange
+    {
+        std::size_t offset = 0;
+        std::size_t count = 0;
+    };
+
+    explicit VSInstanceBuffer(std::size_t inElementSize);
+
+    ~VSInstanceBuffer();
+
+    VSInstanceBuffer(VSInstanceBuffer const&) = delete;
+    VSInstanceBuffer& operator=(VSInstanceBuffer const&) = delete;
+
+    // Allocates count elements (first fit), grows the buffer if no free range is large enough
+    [[nodiscard]] VSRange allocate(std::size_t count);
+
+    // Returns the range to the free list and resets it to an empty range
+    void free(VSRange& range);
+
+    // Uploads range.count elements from data to the range
+    void write(const VSRange& range, const void* data) const;
+
+    [[nodiscard]] GLuint getBuffer() const;
+
+    [[nodiscard]] std::size_t getElementSize() const;
+
+    [[nodiscard]] std::size_t getCapacity() const;
+
+    [[nodiscard]] std::size_t getUsedCount() const;
+
+private:
+    static constexpr std::size_t minGrowCount = 4096;
+
+    GLuint buffer = 0;
+
+    std::size_t elementSize = 0;
+
+    std::size_t capacity = 0;
+
+    std::size_t usedCount = 0;
+
+    // offset -> count, adjacent free ranges are always merged
+    std::map<std::size_t, std::size_t> freeRanges;
+
+    void grow(std::size_t minCapacity);
+
+    void addFreeRange(std::size_t offset, std::size_t count);
+};
@@ -14,4 +14,11 @@ struct aiMaterial;
 
 VSVertexContext* loadVertexContext(std::string const& path);
 
+// Appends the vertices and triangle indices of the file's first mesh, the indices start at 0 for
+// every mesh. False if the file could not be read.
+bool appendMeshData(
+    std::string const& path,
+    std::vector<VSVertexData>& vertexData,
+    std::vector<GLuint>& triangleIndices);
+
 VSVertexContext* processMeshVertices(aiMesh*& mesh);
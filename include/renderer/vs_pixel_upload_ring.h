@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Equally sized slots of one persistently mapped GL_PIXEL_UNPACK_BUFFER.
+// Slots are acquired and released on the GL thread, but any thread may fill an acquired slot
+// through its pointer. With the buffer bound, texture uploads take the slot offset instead of a
+// pointer and return without copying on the CPU. A released slot is only handed out again once
+// the GPU finished reading it (fence).
+// Needs GL 4.4 (glBufferStorage), without it isAvailable is false and no slot can be acquired.
+class VSPixelUploadRing
+{
+public:
+    static constexpr int invalidSlot = -1;
+
+    VSPixelUploadRing(std::size_t inSlotCount, std::size_t inSlotSize);
+
+    ~VSPixelUploadRing();
+
+    VSPixelUploadRing(VSPixelUploadRing const&) = delete;
+    VSPixelUploadRing& operator=(VSPixelUploadRing const&) = delete;
+
+    [[nodiscard]] bool isAvailable() const;
+
+    // invalidSlot if every slot is acquired or still read by the GPU
+    [[nodiscard]] int acquire();
+
+    // Call after the last upload from slot was issued
+    void release(int slot);
+
+    // Returns a slot no upload was issued from, it can be acquired again right away
+    void discard(int slot);
+
+    [[nodiscard]] std::uint8_t* getSlotData(int slot) const;
+
+    // Offset of the slot in the buffer, the pixel pointer of uploads while the buffer is bound
+    [[nodiscard]] std::size_t getSlotOffset(int slot) const;
+
+    [[nodiscard]] std::size_t getSlotSize() const;
+
+    [[nodiscard]] GLuint getBuffer() const;
+
+private:
+    enum class VSSlotState
+    {
+        Free,
+        Acquired,
+        Uploading
+    };
+
+    GLuint buffer = 0;
+
+    std::uint8_t* mappedData = nullptr;
+
+    std::size_t slotSize = 0;
+
+    std::vector<VSSlotState> slotStates;
+
+    // Set while the slot is Uploading
+    std::vector<GLsync> slotFences;
+};
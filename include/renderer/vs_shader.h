@@ -74,6 +74,9 @@ public:
 
     VSShader(const char* name, bool bIsComputeShader = false);
 
+    // Shares a fragment shader between programs, e.g. ("ChunkGreedy", "Chunk")
+    VSShader(const char* vertexShaderName, const char* fragmentShaderName);
+
     [[nodiscard]] GLuint getID() const;
 
     void use() const;
@@ -90,4 +93,8 @@ private:
     static bool checkProgramLinkErrors(unsigned int programID);
 
     static GLuint compileShader(const std::filesystem::path& shaderPath, GLenum shaderType);
+
+    void linkProgram(
+        const std::filesystem::path& vertexShaderPath,
+        const std::filesystem::path& fragmentShaderPath);
 };
\ No newline at end of file
@@ -25,6 +25,8 @@ public:
 
     GLint indexCount = 0;
 
+    GLint vertexCount = 0;
+
     VSVertexContext(VSVertexContext const&) = delete;
     VSVertexContext& operator=(VSVertexContext const&) = delete;
 
@@ -75,6 +77,7 @@ public:
             GL_STATIC_DRAW);
 
         indexCount = triangleIndices.size();
+        vertexCount = vertexData.size();
 
         glBindVertexArray(0);
     };
@@ -20,10 +20,41 @@ struct VSUIState
     bool bShouldShowUV = false;
     bool bShouldShowNormals = false;
     bool bShouldShowLight = false;
+    bool bIsMultiDrawIndirectEnabled = true;
+    bool bIsGreedyMeshingEnabled = false;
+    bool bIsBitmaskVisibilityEnabled = true;
+    bool bIsSkyLightEnabled = true;
+    bool bIsDistanceTransformEnabled = true;
     int totalBlockCount = 0;
     int visibleBlockCount = 0;
     int drawnBlockCount = 0;
     int drawCallCount = 0;
+    std::size_t drawnTriangleCount = 0;
+    std::size_t drawnVertexCount = 0;
+    float visibilityKernelMicroseconds = 0.F;
+    float shadowKernelMilliseconds = 0.F;
+    int totalChunkCount = 0;
+    std::size_t blockStorageByteCount = 0;
+    std::size_t instanceUploadByteCount = 0;
+    std::size_t instanceBufferByteCount = 0;
+    std::size_t shadowUploadByteCount = 0;
+    std::size_t threadPoolThreadCount = 0;
+    std::size_t queuedJobCount = 0;
+    std::size_t runningJobCount = 0;
+    float jobLatencyMilliseconds = 0.F;
+    float jobRunMilliseconds = 0.F;
+    float firstVisibleFrameMilliseconds = 0.F;
+    std::size_t lightUpdateBlockCount = 0;
+    std::size_t shadowRegionBlockCount = 0;
+    bool bShouldRunTraceBenchmark = false;
+    float traceRaysPerSecond = 0.F;
+    float batchedTraceRaysPerSecond = 0.F;
+    float sunQueriesPerSecond = 0.F;
+    bool bShouldRunNoiseBenchmark = false;
+    float noiseSamplesPerSecond = 0.F;
+    float batchedNoiseSamplesPerSecond = 0.F;
+    float noiseMaxError = 0.F;
+    float noiseVoxelHeightMismatchRatio = 0.F;
     std::ostringstream logStream;
     glm::vec3 directLightDir = {-0.4F, 0.7F, -0.6F};
 
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <array>
+#include <glm/vec2.hpp>
 
 class VSHeightmap
 {
@@ -13,14 +16,49 @@ public:
         float frequency = 0.01F,
         float amplitude = 1.0F,
         float lacunarity = 2.0F,
-        float persistence = 0.5F);
+        float persistence = 0.5F,
+        std::uint32_t seed = 0);
 
     // Return integer height scaled with maxHeight
     virtual int getVoxelHeight(int x, int y);
 
     void setMaxHeight(int maxHeight);
 
-    float getHeight(int x, int y);
+    // Same noise as getHeights for a single column, the results are bit identical
+    float getHeight(int x, int y) const;
+
+    // The scalar glm::perlin noise getHeight and getHeights replaced, the reference for
+    // runBenchmark and the checks
+    float getReferenceHeight(int x, int y) const;
+
+    // getHeight and getHeights stay within this of getReferenceHeight (heights are -1 to 1)
+    static constexpr float maxReferenceError = 1e-5F;
+
+    // Share of voxel heights that may round differently than the reference, by one block at most
+    static constexpr float maxVoxelHeightMismatchRatio = 1e-3F;
+
+    // Heights of the tile starting at tileMin, outHeights[x + y * tileSize.x] is the height at
+    // tileMin + {x, y}. Evaluates four columns at once (SSE2 where available).
+    void getHeights(const glm::ivec2& tileMin, const glm::ivec2& tileSize, float* outHeights) const;
+
+    // getHeights scaled like getVoxelHeight
+    void
+    getVoxelHeights(const glm::ivec2& tileMin, const glm::ivec2& tileSize, int* outHeights) const;
+
+    struct VSBenchmarkResult
+    {
+        // getReferenceHeight, one column per call
+        float samplesPerSecond = 0.F;
+        float batchedSamplesPerSecond = 0.F;
+        // Largest difference between getReferenceHeight and getHeights
+        float maxError = 0.F;
+        // Share of voxel heights that differ from the rounded reference and the largest difference
+        float voxelHeightMismatchRatio = 0.F;
+        int maxVoxelHeightDifference = 0;
+    };
+
+    // Samples tileCount tiles of tileSize with getReferenceHeight and with getHeights
+    VSBenchmarkResult runBenchmark(const glm::ivec2& tileSize, std::size_t tileCount) const;
 
 private:
     unsigned int mMaxHeight;  // maximum height that is allowed, defaults to 256
@@ -32,4 +70,7 @@ private:
                          ///< octaves (default to 2.0).
     float mPersistence;  ///< Persistence is the loss of amplitude between successive octaves
                          ///< (usually 1/lacunarity)
+    glm::vec2 mOffset;   ///< Noise space offset derived from the seed, same for every octave
+
+    int toVoxelHeight(float height) const;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "world/generator/vs_heightmap.h"
 #include "world/vs_chunk_manager.h"
 #include "world/vs_world.h"
@@ -7,9 +9,11 @@
 namespace VSTerrainGeneration
 {
     void buildTerrain(VSWorld* world);
-    void buildDesert(VSWorld* world);
-    void buildMountains(VSWorld* world);
-    void buildStandard(VSWorld* world);
+    // seed drives every random engine and noise map, the same seed and world size always give
+    // the same blocks. Only the blocks are written, so any chunk manager works.
+    void buildDesert(VSChunkManager* chunkManager, std::uint32_t seed);
+    void buildMountains(VSChunkManager* chunkManager, std::uint32_t seed);
+    void buildStandard(VSChunkManager* chunkManager, std::uint32_t seed);
     void buildEditorPlane(VSWorld* world);
 
     void treeAt(VSWorld* world, int x, int y, int z);
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
+#include "world/vs_block.h"
+
+// Palette compressed block storage.
+// Every distinct block id is stored once in a palette, the blocks themselves only store an index
+// into that palette packed into 64 bit words with 1, 2, 4 or 8 bits per entry.
+// The entry width is picked from the palette size and widened automatically if a set adds an id
+// that does not fit anymore. Palette slots of ids that are no longer used get reused.
+// A storage that only ever held one id needs no packed data at all (0 bits per entry).
+// Reads and writes are guarded by a shared mutex so worker threads can read while the game
+// thread edits (widening reallocates the packed data).
+class VSBlockStorage
+{
+public:
+    // Holds the shared lock while it exists, so a reader that looks at many blocks locks once
+    // instead of once per get(). Writers wait until it is destroyed, the owning thread must not
+    // call get() or any setter of the same storage meanwhile.
+    class VSReadLock
+    {
+    public:
+        explicit VSReadLock(const VSBlockStorage& inStorage);
+
+        [[nodiscard]] VSBlockID get(std::size_t index) const;
+
+    private:
+        const VSBlockStorage& storage;
+        std::shared_lock<std::shared_mutex> lock;
+    };
+
+    VSBlockStorage() = default;
+
+    VSBlockStorage(VSBlockStorage const&) = delete;
+    VSBlockStorage& operator=(VSBlockStorage const&) = delete;
+
+    // Resets the storage to newSize blocks of blockID
+    void resize(std::size_t newSize, VSBlockID blockID = VS_DEFAULT_BLOCK_ID);
+
+    // Locks for this one read, use VSReadLock for many
+    [[nodiscard]] VSBlockID get(std::size_t index) const;
+
+    // Returns the replaced id, read under the same lock as the write
+    VSBlockID set(std::size_t index, VSBlockID blockID);
+
+    // Sets count blocks starting at index under a single lock. The replaced ids are written to
+    // outPreviousBlockIDs, both arrays hold count entries.
+    void setRange(
+        std::size_t index,
+        std::size_t count,
+        const VSBlockID* blockIDs,
+        VSBlockID* outPreviousBlockIDs);
+
+    // Replaces the whole content with count block ids, the palette is rebuilt from scratch
+    void assign(const VSBlockID* blockIDs, std::size_t count);
+
+    // Unpacks all block ids to outBlockIDs, which has to hold at least size() entries
+    void copyTo(VSBlockID* outBlockIDs) const;
+
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] std::uint8_t getBitsPerEntry() const;
+
+    // Number of distinct block ids currently in use
+    [[nodiscard]] std::size_t getPaletteSize() const;
+
+    // True if every block has the same id, O(1)
+    [[nodiscard]] bool isUniform() const;
+
+    // Only meaningful if isUniform() is true
+    [[nodiscard]] VSBlockID getUniformBlockID() const;
+
+    // True if every block is blockID, O(1)
+    [[nodiscard]] bool isFilledWith(VSBlockID blockID) const;
+
+    // Memory used by packed data and palette
+    [[nodiscard]] std::size_t getByteSize() const;
+
+private:
+    using VSWord = std::uint64_t;
+
+    static constexpr std::int16_t invalidPaletteIndex = -1;
+
+    std::size_t blockCount = 0;
+
+    std::uint8_t bitsPerEntry = 0;
+
+    std::vector<VSWord> words;
+
+    std::vector<VSBlockID> palette;
+
+    std::vector<std::uint32_t> paletteRefCounts;
+
+    std::array<std::int16_t, 256> paletteLookup{};
+
+    std::size_t usedPaletteEntries = 0;
+
+    mutable std::shared_mutex mutex;
+
+    static std::uint8_t bitsForPaletteSize(std::size_t paletteSize);
+
+    static std::size_t wordCountFor(std::size_t count, std::uint8_t bits);
+
+    static std::uint32_t
+    readEntry(const std::vector<VSWord>& data, std::uint8_t bits, std::size_t index);
+
+    static void
+    writeEntry(std::vector<VSWord>& data, std::uint8_t bits, std::size_t index, std::uint32_t value);
+
+    // Expects the lock to be held
+    VSBlockID getUnlocked(std::size_t index) const;
+
+    // Expects the lock to be held, returns the replaced id
+    VSBlockID setUnlocked(std::size_t index, VSBlockID blockID);
+
+    std::uint32_t getOrAddPaletteIndex(VSBlockID blockID);
+
+    void repack(std::uint8_t newBitsPerEntry);
+};
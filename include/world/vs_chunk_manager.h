@@ -1,27 +1,39 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <concurrentqueue/concurrentqueue.h>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <glm/fwd.hpp>
 #include <glm/gtx/component_wise.hpp>
 #include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/vector_float2.hpp>
 #include <vector>
 #include <array>
 #include <bitset>
+#include <deque>
 #include <renderer/vs_shader.h>
+#include <functional>
 #include <future>
+#include <memory>
+#include <shared_mutex>
+#include <utility>
 
 #include "core/vs_core.h"
 
 #include "renderer/vs_drawable.h"
+#include "renderer/vs_instance_buffer.h"
+#include "renderer/vs_pixel_upload_ring.h"
 #include "renderer/vs_vertex_context.h"
 
+#include "world/vs_block_storage.h"
 #include "world/vs_chunk_update.h"
 
 #include "vs_block.h"
 
 struct VSVertexContext;
+class VSCamera;
 
 class VSShader;
 
@@ -29,35 +41,108 @@ class VSChunkManager : public IVSDrawable
 {
     struct VSChunk
     {
+        // Packed per instance data, decoded in Chunk.vs.
+        // The lower 24 bits of the light words hold a 3 bit light level (see lightLevels) for
+        // every corner of two faces, 12 bits per face.
         struct VSVisibleBlockInfo
         {
-            glm::vec3 locationWorldSpace;
-            VSBlockID id;
-            std::uint32_t lightRight;
-            std::uint32_t lightLeft;
-            std::uint32_t lightTop;
-            std::uint32_t lightBottom;
-            std::uint32_t lightFront;
-            std::uint32_t lightBack;
-            glm::vec3 lightColor;
+            // x (11 bits), y (8 bits), z (11 bits) relative to the world's min corner
+            std::uint32_t location;
+            // right & left face light, block id in the upper 8 bits
+            std::uint32_t lightRightLeftAndID;
+            // top & bottom face light, 4 bit red and green light color in the upper 8 bits
+            std::uint32_t lightTopBottomAndColorRG;
+            // front & back face light, 4 bit blue light color in bits 24-27
+            std::uint32_t lightFrontBackAndColorB;
         };
 
+        static_assert(sizeof(VSVisibleBlockInfo) == 16);
+
         using VSVisibleBlockInfos = std::array<std::vector<VSVisibleBlockInfo>, 64>;
 
-        std::vector<VSBlockID> blocks;
+        // Vertex of a greedy meshed quad, decoded in ChunkGreedy.vs
+        struct VSGreedyVertex
+        {
+            glm::vec3 position;
+            glm::vec3 normal;
+            glm::vec2 texCoord;
+            float lightLevel;
+            // block id (8 bits), 4 bit red, green and blue light color
+            std::uint32_t blockIDAndLightColor;
+        };
+
+        struct VSGreedyMesh
+        {
+            std::vector<VSGreedyVertex> vertices;
+            std::vector<GLuint> indices;
+        };
 
-        std::vector<float> lightLevel;
+        // Block indices of all visible blocks of a chunk, ascending
+        using VSVisibleBlockIndices = std::vector<std::uint32_t>;
 
+        struct VSVisibilityResult
+        {
+            VSVisibleBlockInfos visibleBlockInfos;
+            VSVisibleBlockIndices visibleBlockIndices;
+            // Only built if greedy meshing was enabled when the update started
+            VSGreedyMesh greedyMesh;
+            // Packed like VSChunk::sunLight, empty if sky light was disabled
+            std::vector<std::uint8_t> sunLight;
+        };
+
+        // Vertical slices of sectionHeight blocks, each with its own palette.
+        // Uniform sections (all air, all stone...) are detected in O(1) and can be skipped.
+        std::vector<VSBlockStorage> sections;
+
+        // Block light level (0 - maxBlockLight) written by propagateBlockLight
+        std::vector<std::uint8_t> blockLight;
+
+        // Color of the emitter the block light came from, only set where blockLight is. Both
+        // are written under blockLightMutex.
         std::vector<glm::vec3> lightColor;
 
-        std::vector<bool> bIsBlockVisible;
+        // Per column (x + z * chunkSize.x) the y of the highest non-air block + 1, 0 if the
+        // column is empty. Kept up to date by setBlock and assignChunkBlocks.
+        std::vector<std::atomic<std::int16_t>> heightmap;
+
+        // Non-air blocks per brickSize^3 brick (see blockCoordinatesToBrickIndex), so traceRay
+        // can skip empty bricks of non-empty sections. Kept up to date by setBlock and
+        // assignChunkBlocks. Atomic since edits run on the game thread and the pool (structures)
+        // while traces read them, each edit counts the id its storage write replaced.
+        std::vector<std::atomic<std::uint8_t>> brickBlockCounts;
+
+        // Sunlight level (0 - maxSunLight) of every block from the last visibility update,
+        // two levels per byte (even block index in the low nibble). Swapped as a whole, use
+        // std::atomic_load since the game thread reads it.
+        std::shared_ptr<const std::vector<std::uint8_t>> sunLight;
+
+        // Produced together with visibleBlockInfos and only replaced on the main thread, shadow
+        // updates keep a reference to the list they were started with
+        std::shared_ptr<const VSVisibleBlockIndices> visibleBlockIndices;
 
         std::atomic<bool> bIsDirty;
 
         std::atomic<bool> bShouldRebuildShadows;
 
+        // Set when an edit was too large for updateShadowRegions, the next visibility update
+        // then rebuilds the shadows of the chunk and its neighbours
+        std::atomic<bool> bShouldRebuildNeighbourShadows;
+
         VSVisibleBlockInfos visibleBlockInfos;
 
+        // Where visibleBlockInfos live in the instance buffers, only rewritten when they change
+        std::array<VSInstanceBuffer::VSRange, 64> visibleBlockInfoRanges;
+
+        GLuint greedyVertexArray = 0;
+
+        GLuint greedyVertexBuffer = 0;
+
+        GLuint greedyIndexBuffer = 0;
+
+        GLsizei greedyIndexCount = 0;
+
+        std::size_t greedyVertexCount = 0;
+
         glm::vec3 chunkLocation = glm::vec3(0.F);
     };
 
@@ -68,6 +153,8 @@ public:
         glm::ivec3 chunkSize;
         glm::ivec2 chunkCount;
         std::vector<VSBlockID> blocks;
+        // Seed the world was generated with, 0 for files written before seeds were saved
+        std::uint32_t seed = 0;
     };
 
     struct VSBuildingData
@@ -82,21 +169,65 @@ public:
         glm::vec3 hitLocation = {};
         glm::vec3 hitNormal = {};
         VSBlockID blockID = VS_DEFAULT_BLOCK_ID;
+        // World coordinates of the hit block
+        glm::ivec3 blockLocation = {};
+    };
+
+    struct VSRay
+    {
+        glm::vec3 origin = {};
+        glm::vec3 direction = {};
+        float maxDistance = 0.F;
     };
 
-    VSChunkManager();
+    // Without render resources no GL object is created, for tools and checks that only need the
+    // blocks: generation, edits and traces work, updateChunks and draw must not be called.
+    explicit VSChunkManager(bool bShouldCreateRenderResources = true);
+
+    ~VSChunkManager() override;
 
     VSBlockID getBlock(const glm::vec3& location) const;
 
     void setBlock(const glm::vec3& location, VSBlockID blockID);
 
-    void addEmission(const glm::vec3& location, float emission, glm::vec3 color, VSBlockID previousBlock);
+    // Bulk edits, world coordinates, clipped to the world. Every x row of a chunk is written
+    // with one storage call, light and shadow updates are queued for changed blocks only and
+    // each chunk (plus the neighbours whose border changed) is marked dirty once per call.
+    // A column span is a box one block wide, whole chunks go through generateChunks.
+
+    // Sets every block in [boxMin, boxMax) to blockID
+    void fillBlocks(const glm::ivec3& boxMin, const glm::ivec3& boxMax, VSBlockID blockID);
+
+    // Copies boxSize blocks in x, y, z order (like VSBuildingData) to the box at boxMin
+    void setBlocks(const glm::ivec3& boxMin, const glm::ivec3& boxSize, const VSBlockID* blockIDs);
+
+    struct VSStructure
+    {
+        // World coordinates of the min corner
+        glm::ivec3 location = {};
+        // Has to outlive placeStructures
+        const VSBuildingData* build = nullptr;
+        // Air blocks of the build clear the world, otherwise they keep what is there
+        bool bShouldPlaceAir = false;
+    };
+
+    // Writes the structures with one task per chunk on the thread pool. Structures reaching over
+    // a chunk border are clipped, every chunk writes its part. Overlapping structures are written
+    // in list order. Returns once all are placed, game thread only.
+    void placeStructures(const std::vector<VSStructure>& structures);
 
     glm::ivec3 getWorldSize() const;
 
+    glm::ivec3 getChunkSize() const;
+
     void draw(VSWorld* world) override;
 
-    void updateChunks();
+    // Starts and finishes chunk updates, chunks in view of camera and close to it go first
+    void updateChunks(const VSCamera* camera);
+
+    // Applies the last setChunkDimensions, all blocks are air afterwards. updateChunks does this
+    // on its own, call it directly to use the chunks without render updates.
+    void initializeChunks();
 
     [[nodiscard]] glm::vec3 getOrigin() const;
 
@@ -110,6 +241,8 @@ public:
 
     void setColorOverride(const glm::vec3& newColorOverride);
 
+    // Rounds down to even sizes and counts, worlds wider than maxWorldWidth or higher than
+    // maxWorldHeight are clamped with a warning
     void setChunkDimensions(const glm::ivec3& inChunkSize, const glm::ivec2& inChunkCount);
 
     void setWorldData(const VSWorldData& worldData);
@@ -126,12 +259,154 @@ public:
 
     std::size_t getDrawCallCount() const;
 
+    std::size_t getDrawnTriangleCount() const;
+
+    std::size_t getDrawnVertexCount() const;
+
+    // Average time of the visibility kernel per chunk update since the kernel was last switched
+    float getAverageVisibilityKernelMicroseconds() const;
+
+    // Average time of the shadow distance field kernel per chunk since it was last switched
+    float getAverageShadowKernelMilliseconds() const;
+
+    std::size_t getBlockStorageByteCount() const;
+
+    // Bytes written to the instance buffers during the last updateChunks
+    std::size_t getInstanceUploadByteCount() const;
+
+    // GPU memory reserved by the instance buffers
+    std::size_t getInstanceBufferByteCount() const;
+
+    // Bytes of shadow distances uploaded during the last updateChunks
+    std::size_t getShadowUploadByteCount() const;
+
+    // World y of the first block above the highest non-air block of the column at x, z (world
+    // coordinates), -getWorldSize().y / 2 if the column is empty. O(1).
+    int getSurfaceHeight(int x, int z) const;
+
+    // Sunlight level (0 - maxSunLight) of the block at location from the last visibility update
+    // of its chunk, maxSunLight if sky light is disabled
+    std::uint8_t getSunLight(const glm::vec3& location) const;
+
+    // Blocks whose light changed during the last light update
+    std::size_t getLightUpdateBlockCount() const;
+
+    // Size of the last shadow distance field box updated for edits instead of whole chunks
+    std::size_t getLastShadowRegionBlockCount() const;
+
+    // Time from the last chunk reinitialization until every chunk in view was built, 0 until then
+    float getFirstVisibleFrameMilliseconds() const;
+
     bool shouldReinitializeChunks() const;
 
     bool isLocationInBounds(const glm::vec3& location) const;
 
     VSTraceResult lineTrace(const glm::vec3& start, const glm::vec3& end) const;
 
+    // Exact voxel traversal (Amanatides & Woo) visiting every block the ray passes through, up to
+    // maxDistance. Empty sections and bricks are skipped as a whole. The hit location lies on the
+    // entered face, nudged into the block in front of it.
+    VSTraceResult
+    traceRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+
+    // Whether no block is in the way from location towards the sun. CPU fallback for the shadow
+    // distance field, which only exists on the GPU and only once a chunk's shadows were built.
+    // location should be in air, e.g. on top of a block.
+    bool isSunVisible(const glm::vec3& location, const glm::vec3& sunDirection) const;
+
+    // traceRay for rayCount rays, outResults[i] belongs to rays[i]. Batches of at least
+    // minParallelRayCount rays are split into packets of rayPacketSize that the calling thread
+    // and the pool workers take from a shared counter. Returns once every ray is traced, the
+    // world must not change until then.
+    void traceRays(const VSRay* rays, std::size_t rayCount, VSTraceResult* outResults) const;
+
+    struct VSTraceBenchmarkResult
+    {
+        float raysPerSecond = 0.F;
+        float batchedRaysPerSecond = 0.F;
+        float sunQueriesPerSecond = 0.F;
+    };
+
+    // Traces rayCount random rays through the world one by one and as a traceRays batch, and as
+    // many sun queries from random column tops. The seed is fixed so runs can be compared.
+    VSTraceBenchmarkResult
+    runTraceBenchmark(std::size_t rayCount, const glm::vec3& sunDirection) const;
+
+    // Receives the world coordinates of a chunk's min corner and its blocks in block index order,
+    // all air. Called from several threads at once.
+    using VSChunkGenerator =
+        std::function<void(const glm::ivec3& chunkMin, std::vector<VSBlockID>& blocks)>;
+
+    // Replaces the blocks of every chunk with the ones generateChunk fills in, one chunk per task
+    // on the thread pool. Skips setBlock: every chunk is assigned and marked dirty once and only
+    // emitting blocks are queued for the light update, so it is meant for freshly created
+    // chunks. Returns once all chunks are generated, game thread only.
+    void generateChunks(const VSChunkGenerator& generateChunk);
+
+    // Seed of the generated world, set by the terrain generation and saved with the world
+    std::uint32_t getWorldSeed() const;
+
+    void setWorldSeed(std::uint32_t newWorldSeed);
+
+    // FNV-1a hash of every block in chunk order, hashed per chunk on the thread pool. Equal
+    // worlds give equal hashes on every platform.
+    std::uint64_t computeBlockHash() const;
+
+    // Recounts the blocks of every brick and compares them with the counts edits keep up to
+    // date. For checks, the world must not change meanwhile.
+    bool validateBrickCounts() const;
+
+    struct VSVisibilityKernelComparison
+    {
+        bool bDoKernelsMatchReference = true;
+        // Average time per chunk
+        float scalarMicroseconds = 0.F;
+        float bitmaskMicroseconds = 0.F;
+    };
+
+    // Runs computeBlockTypesScalar and computeBlockTypesBitmask on every chunk and compares them
+    // with isBlockVisible called for every block, without the shortcuts of either kernel. For
+    // checks, the world must not change meanwhile.
+    VSVisibilityKernelComparison compareVisibilityKernels() const;
+
+    // Compares getCachedLightInformation with getLightInformation for every block of the chunk,
+    // with sky light. For checks, the world must not change meanwhile.
+    bool validateLightInformation(std::size_t chunkIndex) const;
+
+    struct VSDistanceFieldComparison
+    {
+        bool bDoKernelsMatch = true;
+        float bruteForceMicroseconds = 0.F;
+        float transformMicroseconds = 0.F;
+    };
+
+    // Runs computeDistanceFieldBruteForce and computeDistanceFieldTransform on the chunk, with the
+    // visible blocks of isBlockVisible, and compares the distance fields chunkUpdateShadow would
+    // upload. For checks, the world must not change meanwhile.
+    VSDistanceFieldComparison validateDistanceField(std::size_t chunkIndex) const;
+
+    // Sets the blocks at the world locations of edits, recomputes the boxes updateShadowRegions
+    // would for them on top of the previous distance fields and compares every chunk with a full
+    // computeDistanceFieldTransform. For checks, nothing else may change the world meanwhile.
+    bool validateShadowRegions(const std::vector<std::pair<glm::ivec3, VSBlockID>>& edits);
+
+    struct VSDrawPathComparison
+    {
+        bool bDoPathsMatch = true;
+        // Pixels the chunks cover, an empty frame would match as well
+        std::size_t coveredPixelCount = 0;
+        std::uint32_t instancedDrawCallCount = 0;
+        std::uint32_t multiIndirectDrawCallCount = 0;
+    };
+
+    // Needs render resources and a current GL 4.3 context. Uploads the visible blocks of every
+    // chunk, renders all chunks with drawInstanced and with drawMultiIndirect into an offscreen
+    // framebuffer and compares the pixels. For checks, the world must not change meanwhile.
+    VSDrawPathComparison compareDrawPaths(
+        const glm::vec3& viewPos,
+        const glm::mat4& VP,
+        const glm::ivec2& framebufferSize);
+
     // This method is used to retrieve the data to save a scene.
     [[nodiscard]] VSWorldData getData() const;
 
@@ -158,31 +433,128 @@ private:
 
     glm::ivec3 newWorldSizeHalf{};
 
-    VSShader chunkShader = VSShader("Chunk");
+    bool bHasRenderResources = true;
+
+    std::unique_ptr<VSShader> chunkShader;
+
+    std::unique_ptr<VSShader> greedyChunkShader;
 
     std::atomic<bool> bShouldReinitializeChunks = false;
 
     std::atomic<bool> bShouldInitializeFromData = false;
 
+    // Set by generateChunks from any thread, updateChunks cancels the running updates
+    std::atomic<bool> bShouldCancelChunkUpdates = false;
+
     bool bIsFrustumCullingEnabled = true;
 
+    // Draw one greedy meshed vertex buffer per chunk instead of instanced cubes
+    bool bIsGreedyMeshingEnabled = false;
+
+    // Use computeBlockTypesBitmask instead of computeBlockTypesScalar
+    bool bIsBitmaskVisibilityEnabled = true;
+
+    // Scale the ambient light of air by its sunlight, so caves and overhangs get darker
+    bool bIsSkyLightEnabled = true;
+
+    mutable std::atomic<std::uint64_t> visibilityKernelNanoseconds = 0;
+
+    mutable std::atomic<std::uint32_t> visibilityKernelRunCount = 0;
+
+    // Use computeDistanceFieldTransform instead of computeDistanceFieldBruteForce
+    bool bIsDistanceTransformEnabled = true;
+
+    mutable std::atomic<std::uint64_t> shadowKernelNanoseconds = 0;
+
+    mutable std::atomic<std::uint32_t> shadowKernelRunCount = 0;
+
     glm::vec3 colorOverride{1.F, 1.F, 1.F};
 
     VSWorldData worldDataFromFile;
 
+    std::uint32_t worldSeed = 0;
+
     static constexpr auto faceCombinationCount = 64;
 
-    std::array<VSVertexContext*, faceCombinationCount> vertexContexts;
+    static constexpr auto sectionHeight = 16;
+
+    // packVisibleBlockInfo has 11 bits for zero based x and z and 8 bits for y,
+    // setChunkDimensions keeps the world inside
+    static constexpr int maxWorldWidth = 1 << 11;
+    static constexpr int maxWorldHeight = 1 << 8;
+
+    // Rays traceRays hands out at once, and the batch size from which it uses the thread pool
+    static constexpr std::size_t rayPacketSize = 64;
+    static constexpr std::size_t minParallelRayCount = 4 * rayPacketSize;
+
+    // Edge length of the bricks counted in VSChunk::brickBlockCounts
+    static constexpr int brickSize = 4;
+    static_assert(brickSize * brickSize * brickSize <= 255);
+
+    // Where the cube of a face combination lies in cubeVertexContext
+    struct VSCubeMesh
+    {
+        GLuint firstIndex = 0;
+        GLint baseVertex = 0;
+        GLsizei indexCount = 0;
+        GLsizei vertexCount = 0;
+    };
+
+    // The cubes of all 63 face combinations in one vertex and index buffer
+    std::unique_ptr<VSVertexContext> cubeVertexContext;
+
+    std::array<VSCubeMesh, faceCombinationCount> cubeMeshes{};
 
-    std::array<GLuint, faceCombinationCount> visibleBlockInfoBuffers;
+    // Instances of every face combination, a chunk has one range per combination
+    std::unique_ptr<VSInstanceBuffer> visibleBlockInfoBuffer;
+
+    std::size_t instanceUploadByteCount = 0;
+
+    // Layout defined by GL for glMultiDrawElementsIndirect
+    struct VSDrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // Instance ranges of the chunks that passed culling this frame, per face combination
+    std::array<std::vector<VSInstanceBuffer::VSRange>, faceCombinationCount> drawRanges;
+
+    // One command per range of drawRanges, both draw paths submit these
+    std::vector<VSDrawElementsIndirectCommand> drawCommands;
+
+    GLuint drawCommandBuffer = 0;
 
     glm::mat4 frozenVPMatrix;
     glm::vec3 frozenCameraPos;
 
+    struct VSChunkUpdatePriority
+    {
+        bool bIsInView;
+        float distanceSquared;
+        std::size_t chunkIndex;
+    };
+
+    // All chunks, sorted every frame so chunks in view and close to the camera start updates first
+    std::vector<VSChunkUpdatePriority> chunkUpdateOrder;
+
+    std::chrono::high_resolution_clock::time_point loadStartTime;
+
+    bool bIsWaitingForFirstVisibleFrame = false;
+
+    float firstVisibleFrameMilliseconds = 0.F;
+
     std::uint32_t drawCallCount;
 
     std::uint32_t drawnBlockCount;
 
+    std::size_t drawnTriangleCount = 0;
+
+    std::size_t drawnVertexCount = 0;
+
     GLuint spriteTexture;
 
     GLuint spriteTextureID;
@@ -191,16 +563,140 @@ private:
 
     GLuint shadowTextureID;
 
-    using VSShadwoChunkUpdate = VSChunkUpdate<std::vector<float>>;
+    // Distances in the shadow distance field are clamped to this, so a block edit only changes
+    // the field this close to it. Shadows are only softened by closer blocks anyway.
+    static constexpr int maxShadowDistance = 16;
+
+    // The shadow texture stores distance * shadowDistanceStepsPerBlock + shadowDistanceZero in
+    // 8 bits (GL_R8), -0.5 (inside) to maxShadowDistance map to 0 - 231
+    static constexpr int shadowDistanceStepsPerBlock = 14;
+    static constexpr int shadowDistanceZero = shadowDistanceStepsPerBlock / 2;
+    static_assert(maxShadowDistance * shadowDistanceStepsPerBlock + shadowDistanceZero <= 255);
+
+    // Mip level 1 holds a lower bound of the distance anywhere in each 2x2x2 cell. Every point
+    // of the cell is at most sqrt(3) / 2 blocks from one of its block centers.
+    static constexpr int shadowCoarseReachSteps = 13;
+
+    // Quantized distances of the box [boxMin, boxMin + boxSize) followed by its mip level 1.
+    // Boxes start and end on even coordinates.
+    struct VSShadowRegionResult
+    {
+        glm::ivec3 boxMin{};
+        glm::ivec3 boxSize{};
+        // Empty if the distances were written to an upload ring slot
+        std::vector<std::uint8_t> distances;
+    };
+
+    using VSShadwoChunkUpdate = VSChunkUpdate<VSShadowRegionResult>;
 
-    std::map<VSChunk*, std::shared_ptr<VSShadwoChunkUpdate>> activeShadowBuildTasks;
+    // A shadow update and the upload ring slot its worker writes to, if it got one
+    struct VSShadowBuildTask
+    {
+        std::shared_ptr<VSShadwoChunkUpdate> update;
+        int uploadSlot = VSPixelUploadRing::invalidSlot;
+    };
+
+    std::map<VSChunk*, VSShadowBuildTask> activeShadowBuildTasks;
+
+    // Shadow updates write their results straight into mapped upload memory, one slot fits a
+    // chunk. Recreated with the chunks.
+    std::unique_ptr<VSPixelUploadRing> shadowUploadRing;
+
+    // Finished shadow updates beyond this wait for the next frame, at least one is uploaded
+    static constexpr std::size_t maxShadowUploadBytesPerFrame = 1024 * 1024;
+
+    std::size_t shadowUploadByteCount = 0;
+
+    // Edits queued for updateShadowRegions per frame, more rebuild whole chunks
+    static constexpr std::size_t maxPendingShadowEdits = 256;
 
-    using VSVisibilityChunkUpdate = VSChunkUpdate<VSChunk::VSVisibleBlockInfos>;
+    // Largest box updateShadowRegions updates on its own
+    static constexpr int maxShadowRegionVolume = 96 * 96 * 96;
+
+    // Zero based locations of setBlock calls that turned air solid or back
+    moodycamel::ConcurrentQueue<glm::ivec3> pendingShadowEdits;
+
+    std::atomic<std::size_t> pendingShadowEditCount = 0;
+
+    // In submission order
+    std::deque<VSShadowBuildTask> activeShadowRegionUpdates;
+
+    std::size_t lastShadowRegionBlockCount = 0;
+
+    using VSVisibilityChunkUpdate = VSChunkUpdate<VSChunk::VSVisibilityResult>;
 
     std::map<VSChunk*, std::shared_ptr<VSVisibilityChunkUpdate>> activeVisibilityBuildTasks;
 
-    const static inline auto maxShadowUpdateThreads =
-        std::thread::hardware_concurrency() == 0 ? 4 : std::thread::hardware_concurrency() + 1;
+    // Updates of one kind in flight per pool thread, enough to keep the workers busy while
+    // most dirty chunks wait here and can still be merged or cancelled cheaply
+    const static inline std::size_t maxActiveUpdatesPerThread = 2;
+
+    // Light levels a corner can be quantized to, in units of getLightInformationForFace's light
+    // value (0-32). Keep in sync with lightLevels in Chunk.vs.
+    // Without emission and in full sunlight the values are always multiples of 2 up to 8, those
+    // stay exact.
+    static constexpr std::array<float, 8> lightLevels = {0.F, 2.F, 4.F, 6.F, 8.F, 14.F, 22.F, 32.F};
+
+    // Highest block light level, a block with emission e lights blocks up to e - 1 steps away
+    static constexpr std::uint8_t maxBlockLight = 15;
+
+    // Sunlight of air above the heightmap, it loses one level per step below it
+    static constexpr std::uint8_t maxSunLight = 15;
+
+    // Light samples of air are blockLight * blockLightSampleWeight + sunLight *
+    // sunLightSampleWeight, which is lightSampleScale times the light value (0-32): full block
+    // light gives 32, full sunlight the ambient 8. Integer samples make the corner sums
+    // independent of the order they are added in.
+    static constexpr std::uint32_t lightSampleScale = 15;
+    static constexpr std::uint32_t blockLightSampleWeight = 32 * lightSampleScale / maxBlockLight;
+    static constexpr std::uint32_t sunLightSampleWeight = 8 * lightSampleScale / maxSunLight;
+
+    // Light samples around one chunk, computed on first use during a visibility update.
+    // Neighbouring visible blocks share most of their samples.
+    struct VSLightSampleCache
+    {
+        static constexpr std::uint16_t unset = 0xFFFF;
+
+        // Zero based location of the first sample, one block below and before the chunk
+        glm::ivec3 origin{};
+        glm::ivec3 size{};
+        std::vector<std::uint16_t> samples;
+    };
+
+    // Sunlight of the blocks of a chunk and everything up to maxSunLight blocks around it,
+    // the extra border makes the values of the chunk and its direct neighbours exact
+    struct VSSunLightRegion
+    {
+        glm::ivec3 origin{};
+        glm::ivec3 size{};
+        std::vector<std::uint8_t> levels;
+
+        // zeroBaseLocation has to be inside the region
+        std::uint8_t get(const glm::ivec3& zeroBaseLocation) const;
+    };
+
+    // Block light of a chunk and the blocks next to it. propagateBlockLight keeps writing while
+    // visibility updates run, so they work on a copy taken under blockLightMutex.
+    struct VSBlockLightRegion
+    {
+        glm::ivec3 origin{};
+        glm::ivec3 size{};
+        std::vector<std::uint8_t> levels;
+        // Light color rounded to 0-255 per channel, red in the lowest byte
+        std::vector<std::uint32_t> colors;
+        // Only air is sampled, false outside the world
+        std::vector<bool> isAir;
+
+        // zeroBaseLocation has to be inside the region
+        std::uint8_t getLevel(const glm::ivec3& zeroBaseLocation) const;
+
+        // Light color of the block at zeroBaseLocation (inside the chunk of the region): the
+        // colors of the block and its face neighbours weighted by their level. Opaque blocks only
+        // get light through their air neighbours, emitters add their own color.
+        glm::vec3 getBlockColor(const glm::ivec3& zeroBaseLocation) const;
+
+        std::size_t getIndex(const glm::ivec3& zeroBaseLocation) const;
+    };
 
     const static inline std::vector<float> blockEmission = {/*Air=0*/ 0.F,
                                                             /*Stone=1*/ 0.F,
@@ -256,7 +752,38 @@ private:
                                                                       {0.F, 255.F, 0.F},
                                                                       {0.F, 0.F, 255.F}};
 
-    void initializeChunks();
+    struct VSLightRemoval
+    {
+        glm::ivec3 zeroBaseLocation;
+        std::uint8_t level;
+    };
+
+    // Locations of block edits that may change block light. setBlock runs on the game thread,
+    // the edits are applied once per frame in updateChunks.
+    moodycamel::ConcurrentQueue<glm::ivec3> pendingLightEdits;
+
+    // Held exclusively by propagateBlockLight while it writes blockLight and lightColor, readers
+    // on other threads (edits, visibility updates) hold it shared
+    mutable std::shared_mutex blockLightMutex;
+
+    // Reused by propagateBlockLight
+    std::vector<glm::ivec3> lightEdits;
+    std::vector<VSLightRemoval> lightRemovalQueue;
+    std::vector<glm::ivec3> lightAddQueue;
+
+    std::size_t lightUpdateBlockCount = 0;
+
+    // Same bounding sphere test draw uses for culling
+    bool isChunkInView(
+        const VSChunk* chunk,
+        const glm::mat4& VP,
+        const glm::vec3& cameraPos,
+        float zFar) const;
+
+    void updateChunkUpdateOrder(const VSCamera* camera);
+
+    // Stops the load timer once no chunk in view waits for a visibility update anymore
+    void updateFirstVisibleFrame();
 
     glm::ivec2 getChunkCount() const;
 
@@ -266,33 +793,325 @@ private:
 
     void updateShadows(std::size_t chunkIndex);
 
-    std::vector<float> chunkUpdateShadow(
+    // Recomputes the shadow distance field only around the blocks set since the last frame and
+    // uploads finished boxes. Falls back to rebuilding the touched chunks for large batches or
+    // while shadows are disabled.
+    void updateShadowRegions(bool bAreShadowsEnabled);
+
+    // Takes the edits setBlock queued for updateShadowRegions
+    std::vector<glm::ivec3> dequeueShadowEdits();
+
+    // Zero based box [boxMin, boxMax)
+    struct VSShadowEditBox
+    {
+        glm::ivec3 boxMin{};
+        glm::ivec3 boxMax{};
+    };
+
+    // The boxes updateShadowRegions recomputes for zero based edits. Edits further than
+    // 2 * maxShadowDistance apart get separate boxes, so distant edits in one frame do not
+    // rebuild everything between them.
+    std::vector<VSShadowEditBox> groupShadowEdits(const std::vector<glm::ivec3>& edits) const;
+
+    // Visible blocks of a chunk at the time a shadow update was started
+    struct VSChunkVisibilitySnapshot
+    {
+        glm::vec3 chunkLocation;
+        std::shared_ptr<const VSChunk::VSVisibleBlockIndices> visibleBlockIndices;
+    };
+
+    VSShadowRegionResult chunkUpdateShadow(
         const std::atomic<bool>& bShouldCancel,
         std::atomic<bool>& bIsReady,
+        std::size_t chunkIndex,
+        const VSChunkVisibilitySnapshot& chunkVisibility,
+        const std::vector<VSChunkVisibilitySnapshot>& neighbourVisibilities,
+        bool bShouldUseDistanceTransform,
+        std::uint8_t* uploadData) const;
+
+    // Bytes of both mip levels of a box
+    static std::size_t getShadowRegionByteCount(const glm::ivec3& boxSize);
+
+    // Quantizes distanceField of the box and builds its mip level, into uploadData if it is not
+    // null (getShadowRegionByteCount bytes) and into the result otherwise
+    static VSShadowRegionResult packShadowRegion(
+        const glm::ivec3& boxMin,
+        const glm::ivec3& boxSize,
+        const std::vector<float>& distanceField,
+        std::uint8_t* uploadData);
+
+    // Acquires a slot of shadowUploadRing for a box, null if there is none or it is too small
+    std::uint8_t* acquireShadowUploadSlot(const glm::ivec3& boxSize, int& outSlot);
+
+    // Cancels the update and returns its slot
+    void cancelShadowBuildTask(VSShadowBuildTask& task);
+
+    // Whether a box still fits into this frame's maxShadowUploadBytesPerFrame
+    bool hasShadowUploadBudget(const glm::ivec3& boxSize) const;
+
+    // Writes both mip levels of the finished task to shadowTexture
+    void uploadShadowRegion(VSShadowBuildTask& task);
+
+    // Distance fields below return false if cancelled. Air gets the distance from its center
+    // to the nearest visible block center of the chunk and its neighbours, other blocks -0.5.
+
+    // Every air block against every visible block of neighbourVisibilities
+    bool computeDistanceFieldBruteForce(
+        const std::atomic<bool>& bShouldCancel,
+        std::size_t chunkIndex,
+        const std::vector<VSBlockID>& blocks,
+        const std::vector<VSChunkVisibilitySnapshot>& neighbourVisibilities,
+        std::vector<float>& outDistanceField) const;
+
+    // isBlockVisible for every block of the chunk and its neighbours, the chunk comes first.
+    // Stands in for visibleBlockIndices, which headless chunk managers never build.
+    std::vector<VSChunkVisibilitySnapshot> computeReferenceVisibilities(
         std::size_t chunkIndex) const;
 
+    // Same result as computeDistanceFieldBruteForce in linear time, computeDistanceFieldBox
+    // of the chunk
+    bool computeDistanceFieldTransform(
+        const std::atomic<bool>& bShouldCancel,
+        std::size_t chunkIndex,
+        std::vector<float>& outDistanceField) const;
+
+    // Exact separable Euclidean distance transform of the zero based box [boxMin, boxMax) and
+    // maxShadowDistance blocks around it, to the blocks isBlockVisible reports. Visible blocks
+    // are 0 and hidden ones -0.5, like chunkUpdateShadow. outDistanceField has the box size, x
+    // fastest.
+    bool computeDistanceFieldBox(
+        const std::atomic<bool>& bShouldCancel,
+        const glm::ivec3& boxMin,
+        const glm::ivec3& boxMax,
+        std::vector<float>& outDistanceField) const;
+
+    // Buffers of distanceTransformLine, sized for the longest line
+    struct VSDistanceTransformScratch
+    {
+        std::vector<float> values;
+        std::vector<int> parabolaVertices;
+        std::vector<float> parabolaBoundaries;
+
+        void resize(int count);
+    };
+
+    // 1D squared distance transform of count values stride apart, in place.
+    // Infinite values have no non-air block yet, they stay infinite if the whole line is.
+    static void distanceTransformLine(
+        float* squaredDistances,
+        int count,
+        int stride,
+        VSDistanceTransformScratch& scratch);
+
     void updateVisibleBlocks(std::size_t chunkIndex);
 
-    VSChunk::VSVisibleBlockInfos chunkUpdateVisibility(
+    // Replaces the chunk's ranges in the instance buffers with its current visibleBlockInfos
+    void uploadVisibleBlockInfos(VSChunk* chunk);
+
+    void freeVisibleBlockInfos(VSChunk* chunk);
+
+    void setInstanceAttribPointer(std::size_t firstInstance) const;
+
+    // Appends the ranges of the chunks with instances of the face combination to its drawRanges
+    void collectDrawRanges(std::size_t faceCombination, const std::vector<VSChunk*>& visibleChunks);
+
+    // Fills drawCommands from drawRanges
+    void buildDrawCommands();
+
+    // One instanced draw per command
+    void drawInstanced();
+
+    // A single multi draw indirect call for all commands (GL 4.3)
+    void drawMultiIndirect();
+
+    VSChunk::VSVisibilityResult chunkUpdateVisibility(
         const std::atomic<bool>& bShouldCancel,
         std::atomic<bool>& bIsReady,
-        std::size_t chunkIndex) const;
+        std::size_t chunkIndex,
+        bool bShouldBuildGreedyMesh,
+        bool bShouldUseBitmaskKernel,
+        bool bShouldComputeSkyLight) const;
+
+    // Flood fills sunlight below the heightmaps, returns an empty region if cancelled
+    VSSunLightRegion
+    computeSunLight(const std::atomic<bool>& bShouldCancel, std::size_t chunkIndex) const;
+
+    // Copies the block light and air around the chunk under blockLightMutex, with one
+    // VSBlockStorage::VSReadLock per section
+    VSBlockLightRegion copyBlockLight(std::size_t chunkIndex) const;
+
+    // Column height of the heightmaps for zero based x, z
+    std::int16_t getColumnHeight(int x, int z) const;
+
+    // Keeps the heightmap of the chunk up to date after blockID was written to blockIndex
+    void updateColumnHeight(VSChunk* chunk, std::size_t blockIndex, VSBlockID blockID);
+
+    // Heightmap, brick counts, light and shadow queues after a block changed from
+    // previousBlockID to blockID. Does not mark any chunk dirty.
+    void onBlockChanged(
+        std::size_t chunkIndex,
+        std::size_t blockIndex,
+        const glm::ivec3& zeroBaseLocation,
+        VSBlockID previousBlockID,
+        VSBlockID blockID);
+
+    // Source of a bulk write. Block (x, y, z) of the box is read from
+    // blockIDs[x + y * rowStride + z * sliceStride], fillBlocks passes a single row and 0 strides.
+    struct VSBlockBox
+    {
+        glm::ivec3 zeroBaseMin;
+        glm::ivec3 size;
+        const VSBlockID* blockIDs;
+        std::size_t rowStride;
+        std::size_t sliceStride;
+        bool bShouldPlaceAir;
+    };
 
-    std::uint8_t isBlockVisible(std::size_t chunkIndex, std::size_t blockIndex) const;
+    void writeBlocks(const VSBlockBox& box);
 
-    std::uint8_t
-    isCenterBlockVisible(std::size_t chunkIndex, const glm::ivec3& blockCoordinates) const;
+    // Writes the part of the box inside the chunk. Only touches that chunk's blocks, so
+    // different chunks can be written in parallel.
+    void writeChunkBlocks(std::size_t chunkIndex, const VSBlockBox& box);
+
+    // Marks every chunk dirty whose visible blocks can change with the blocks between changedMin
+    // and changedMax (zero based, inclusive), including the sunlight they get
+    void markChangedBlocksDirty(const glm::ivec3& changedMin, const glm::ivec3& changedMax);
+
+    // Visible faces (see VSCubeFace) of every block, one block at a time via isBlockVisible
+    void computeBlockTypesScalar(
+        std::size_t chunkIndex,
+        const std::vector<VSBlockID>& blocks,
+        std::vector<std::uint8_t>& blockTypes) const;
+
+    // Same result as computeBlockTypesScalar, computed from per row occupancy bitmasks with a one
+    // block apron from the neighbour chunks, 64 blocks at a time
+    void computeBlockTypesBitmask(
+        std::size_t chunkIndex,
+        const std::vector<VSBlockID>& blocks,
+        std::vector<std::uint8_t>& blockTypes) const;
+
+    // Merges coplanar faces with the same block id and light into quads.
+    // faceKeys holds one key per block and face (light information order), 0 if not visible.
+    VSChunk::VSGreedyMesh buildGreedyMesh(
+        const std::atomic<bool>& bShouldCancel,
+        const VSChunk* chunk,
+        const std::array<std::vector<std::uint32_t>, 6>& faceKeys) const;
+
+    void uploadGreedyMesh(VSChunk* chunk, const VSChunk::VSGreedyMesh& greedyMesh);
+
+    void drawGreedy(const std::vector<VSChunk*>& visibleChunks);
+
+    std::uint8_t isBlockVisible(
+        const std::vector<VSBlockID>& blocks,
+        std::size_t chunkIndex,
+        std::size_t blockIndex) const;
+
+    std::uint8_t isCenterBlockVisible(
+        const std::vector<VSBlockID>& blocks,
+        const glm::ivec3& blockCoordinates) const;
 
     std::uint8_t
     isBorderBlockVisible(std::size_t chunkIndex, const glm::ivec3& blockCoordinates) const;
 
     bool isAtWorldBorder(const glm::ivec3& blockWorldCoordinates) const;
 
-    std::array<std::uint32_t, 6> getLightInformation(const glm::vec3& blockCoordinates) const;
+    // Without sunLight every air sample gets full sunlight.
+    // Reference for getCachedLightInformation, which has to return the same words.
+    std::array<std::uint32_t, 6> getLightInformation(
+        const glm::vec3& blockCoordinates,
+        const VSBlockLightRegion& blockLight,
+        const VSSunLightRegion* sunLight) const;
+
+    // Same result as getLightInformation for the block at zeroBaseLocation (inside the chunk of
+    // cache), the 27 samples around the block are read once and shared by all faces
+    std::array<std::uint32_t, 6> getCachedLightInformation(
+        VSLightSampleCache& cache,
+        const glm::ivec3& zeroBaseLocation,
+        const VSBlockLightRegion& blockLight,
+        const VSSunLightRegion* sunLight) const;
+
+    // Light sample (see lightSampleScale) of the block at zeroBaseLocation, 0 for opaque blocks
+    // and locations outside the world
+    std::uint16_t computeLightSample(
+        const glm::ivec3& zeroBaseLocation,
+        const VSBlockLightRegion& blockLight,
+        const VSSunLightRegion* sunLight) const;
+
+    // 8 bit corner value of the sum of the four samples around a corner
+    static std::uint32_t cornerSampleSumToLight(std::uint32_t sampleSum);
+
+    static VSChunk::VSVisibleBlockInfo packVisibleBlockInfo(
+        const glm::ivec3& zeroBaseLocation,
+        VSBlockID blockID,
+        const std::array<std::uint32_t, 6>& lightInformation,
+        const glm::vec3& lightColor);
+
+    static std::uint8_t getBlockLightEmission(VSBlockID blockID);
+
+    static bool isBlockOpaque(VSBlockID blockID);
+
+    // True if changing the block from previousBlockID to blockID can change any block light
+    bool shouldUpdateBlockLight(
+        const glm::ivec3& zeroBaseLocation,
+        VSBlockID previousBlockID,
+        VSBlockID blockID) const;
+
+    bool isZeroBaseLocationInBounds(const glm::ivec3& zeroBaseLocation) const;
+
+    // Sets block light and color and marks the chunk (and the neighbour at a border) dirty
+    void setBlockLight(
+        std::size_t chunkIndex,
+        std::size_t blockIndex,
+        const glm::ivec3& zeroBaseLocation,
+        std::uint8_t level,
+        const glm::vec3& color);
+
+    // Applies all pending light edits at once with a removal and an add flood fill.
+    // Light spreads through air only and loses one level per step, so the work is proportional
+    // to the volume whose light actually changes.
+    void propagateBlockLight();
+
+    // Quantizes the four 8 bit corner values of a face to 3 bit light levels
+    static std::uint32_t packFaceLight(std::uint32_t faceLight);
 
     std::uint32_t getLightInformationForFace(
         const glm::vec3& blockWorldCoordinates,
-        const std::array<glm::vec3, 4>& corners) const;
+        const std::array<glm::vec3, 4>& corners,
+        const VSBlockLightRegion& blockLight,
+        const VSSunLightRegion* sunLight) const;
+
+    // Limit for activeVisibilityBuildTasks and activeShadowBuildTasks each
+    std::size_t getMaxActiveUpdateCount() const;
+
+    std::size_t getChunkSectionCount() const;
+
+    std::size_t getSectionBlockCount() const;
+
+    // Cancels every visibility, shadow and shadow region update in flight and forgets them, main
+    // thread only
+    void cancelChunkUpdates();
+
+    glm::ivec3 getChunkBrickCount() const;
+
+    // Bricks are stored x, y, z like blocks, partial at the chunk's far sides if chunkSize is not
+    // a multiple of brickSize
+    std::size_t blockCoordinatesToBrickIndex(const glm::ivec3& blockCoords) const;
+
+    std::tuple<std::size_t, std::size_t>
+    blockIndexToSectionAndSectionBlockIndex(std::size_t blockIndex) const;
+
+    // Index inside the section holding blockCoords, the section is blockCoords.y / sectionHeight
+    std::size_t blockCoordinatesToSectionBlockIndex(const glm::ivec3& blockCoords) const;
+
+    VSBlockID getChunkBlock(const VSChunk* chunk, std::size_t blockIndex) const;
+
+    // Returns the replaced id
+    VSBlockID setChunkBlock(VSChunk* chunk, std::size_t blockIndex, VSBlockID blockID);
+
+    // Unpacks all sections of a chunk to outBlockIDs in block index order
+    void copyChunkBlocks(const VSChunk* chunk, VSBlockID* outBlockIDs) const;
+
+    void assignChunkBlocks(VSChunk* chunk, const VSBlockID* blockIDs);
 
     std::size_t chunkCoordinatesToChunkIndex(const glm::ivec2& chunkCoordinates) const;
 
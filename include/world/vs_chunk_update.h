@@ -1,25 +1,45 @@
 #pragma once
 
+#include <atomic>
+#include <exception>
 #include <memory>
 #include <functional>
 #include <future>
 
+#include "core/vs_thread_pool.h"
+
 template <typename Result>
 class VSChunkUpdate
 {
 public:
     static std::shared_ptr<VSChunkUpdate<Result>> create(
+        VSThreadPool* threadPool,
         std::function<Result(const std::atomic<bool>&, std::atomic<bool>&, std::size_t chunkIndex)>
             updateFunction,
         std::size_t chunkIndex)
     {
         const auto chunkUpdate = std::shared_ptr<VSChunkUpdate>(new VSChunkUpdate);
-        chunkUpdate->result = std::async(
-            std::launch::async,
-            updateFunction,
-            std::ref(chunkUpdate->bShouldCancel),
-            std::ref(chunkUpdate->bIsReady),
-            chunkIndex);
+        chunkUpdate->result = chunkUpdate->promise.get_future();
+
+        // the job keeps the update alive, it may still be queued when the owner drops it
+        threadPool->submit([chunkUpdate, updateFunction = std::move(updateFunction), chunkIndex]() {
+            // updates cancelled before they started are dropped without touching the chunk
+            bool bExpectedHasStarted = false;
+            if (!chunkUpdate->bHasStarted.compare_exchange_strong(bExpectedHasStarted, true))
+            {
+                return;
+            }
+
+            try
+            {
+                chunkUpdate->promise.set_value(updateFunction(
+                    chunkUpdate->bShouldCancel, chunkUpdate->bIsReady, chunkIndex));
+            }
+            catch (...)
+            {
+                chunkUpdate->promise.set_exception(std::current_exception());
+            }
+        });
 
         return chunkUpdate;
     };
@@ -27,7 +47,9 @@ public:
     void cancel()
     {
         bShouldCancel = true;
-        if (result.valid())
+        // claim the update if no worker picked it up yet, otherwise wait until it noticed
+        bool bExpectedHasStarted = false;
+        if (!bHasStarted.compare_exchange_strong(bExpectedHasStarted, true) && result.valid())
         {
             result.wait();
         }
@@ -51,5 +73,7 @@ private:
 
     std::atomic<bool> bHasStarted = false;
 
+    std::promise<Result> promise;
+
     std::future<Result> result;
-};
\ No newline at end of file
+};
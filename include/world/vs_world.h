@@ -35,9 +35,8 @@ public:
 
     /*
      * Intersect ray with world to find the block coordinates where the ray first hits a block.
-     * Transforms input to block data to calculate intersections ans transforms back to world
-     * coordinates before returning the intersection. If returnPrev is set, the previous block
-     * coords are returned.
+     * Uses the same voxel traversal as VSChunkManager::lineTrace. If returnPrev is set, the
+     * coords of the block in front of the hit face are returned.
      */
     [[nodiscard]] glm::ivec3
     intersectRayWithBlock(glm::vec3 rayOrigin, glm::vec3 rayDirection, bool returnPrev = false);
@@ -55,6 +54,9 @@ public:
     [[nodiscard]] VSDebugDraw* getDebugDraw() const;
 
 private:
+    // Reach of intersectRayWithBlock in blocks
+    static constexpr float maxIntersectRayDistance = 100.F;
+
     VSCamera* camera;
     VSCameraController* cameraController;
 
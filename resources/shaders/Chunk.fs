@@ -21,6 +21,11 @@ uniform vec3 colorOverride;
 
 uniform sampler2DArray spriteTexture;
 uniform sampler3D shadowTexture;
+// Distances in shadowTexture are clamped to this, keep in sync with VSChunkManager
+uniform float maxShadowDistance;
+// shadowTexture stores 8 bit distances, distance = value * scale + offset
+uniform float shadowDistanceScale;
+uniform float shadowDistanceOffset;
 
 uniform bool enableShadows;
 uniform bool enableAO;
@@ -35,7 +40,7 @@ vec3 worldSizeHalf = worldSize / 2u;
 
 float map(in vec3 pos) {
     vec3 shadowTexCoord = (pos + worldSizeHalf) / vec3(worldSize);
-    float distance = texture(shadowTexture, shadowTexCoord).r;
+    float distance = textureLod(shadowTexture, shadowTexCoord, 0.0).r * shadowDistanceScale + shadowDistanceOffset;
     //float distance = texelFetch(shadowTexture, clamp(ivec3(pos + worldSizeHalf), ivec3(0.0), ivec3(worldSize) - ivec3(1.0)), 0).r;
     return distance;
 
@@ -45,6 +50,15 @@ float map(in vec3 pos) {
     //return float(distance -1.0 - min(sdBox(pos - ivec3(pos) + 0.5), -0.999);
 }
 
+// Lower bound of the distance anywhere in the 2x2x2 blocks around pos (mip level 1)
+float mapCoarse(in vec3 pos) {
+    ivec3 block = ivec3(floor(pos + worldSizeHalf));
+    if (any(lessThan(block, ivec3(0))) || any(greaterThanEqual(block, ivec3(worldSize)))) {
+        return maxShadowDistance;
+    }
+    return texelFetch(shadowTexture, block / 2, 1).r * shadowDistanceScale + shadowDistanceOffset;
+}
+
 // https://www.shadertoy.com/view/lsKcDD
 float raymarch(in vec3 ro, in vec3 rd) {
     float res = 1.0;
@@ -58,10 +72,19 @@ float raymarch(in vec3 ro, in vec3 rd) {
     // lower values => softer
     const float softness = 8.0;
 
+    // the coarse level alone is used this far from every block
+    const float coarseStepDistance = 2.0;
+
     for(int i=0; i < maxSteps; i++)
     {
-        float h = map(ro + rd * t);
-        float s = clamp(softness*h/t,0.0,1.0);
+        // big steps on the coarse level, only refine close to surfaces
+        vec3 pos = ro + rd * t;
+        float h = mapCoarse(pos);
+        if (h < coarseStepDistance) {
+            h = map(pos);
+        }
+        // a clamped distance only says that no block is closer (minus decoding error)
+        float s = h >= maxShadowDistance - 0.01 ? 1.0 : clamp(softness*h/t,0.0,1.0);
         res = min(res, s*s*(3.0-2.0*s));
 
         t += h;
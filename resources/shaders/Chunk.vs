@@ -3,20 +3,17 @@
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inNormal;
 
-layout (location = 2) in vec3 blockLocation;
-
-layout (location = 3) in uint blockID;
-
-layout (location = 4) in uint lightRight;
-layout (location = 5) in uint lightLeft;
-layout (location = 6) in uint lightTop;
-layout (location = 7) in uint lightBottom;
-layout (location = 8) in uint lightFront;
-layout (location = 9) in uint lightBack;
-layout (location = 10) in vec3 lightColor;
+// Packed VSVisibleBlockInfo
+// x: location x (11 bits), y (8 bits), z (11 bits) relative to the world's min corner
+// y: right & left face light, block id
+// z: top & bottom face light, light color red & green
+// w: front & back face light, light color blue
+layout (location = 2) in uvec4 blockInfo;
 
 uniform vec3 origin;
 
+uniform uvec3 worldSize;
+
 out VertexData {
     vec3 worldPosition;
     vec3 normal;
@@ -28,75 +25,81 @@ out VertexData {
 
 uniform mat4 VP;
 
-uint getByte(in uint num, in uint n)
+// Keep in sync with VSChunkManager::lightLevels
+const float lightLevels[8] = float[8](0.0, 2.0, 4.0, 6.0, 8.0, 14.0, 22.0, 32.0);
+
+// face: 0 right, 1 left, 2 top, 3 bottom, 4 front, 5 back
+float getCorner(in uint face, in uint corner)
 {
-    return (num & (0x000000FFu << (n * 8u))) >> (n * 8u);
+    uint faceWord = blockInfo[1u + face / 2u];
+    uint level = (faceWord >> ((face % 2u) * 12u + corner * 3u)) & 7u;
+    return lightLevels[level] / 32.0;
 }
 
 float getLight(in vec3 faceNormal, inout vec3 vertexPos, inout vec2 texCoord)
 {
-    float lightLevelDeNorm = 0.0;
+    float lightLevel = 0.0;
     if (faceNormal.x == 1) {
-        if (getByte(lightRight, 0u) + getByte(lightRight, 3u) > getByte(lightRight, 1u) + getByte(lightRight, 2u)) {
+        if (getCorner(0u, 0u) + getCorner(0u, 3u) > getCorner(0u, 1u) + getCorner(0u, 2u)) {
             float y = vertexPos.y;
             vertexPos.y = vertexPos.z;
             vertexPos.z = -y;
         }
         texCoord.x = vertexPos.z + 0.5;
         texCoord.y = vertexPos.y + 0.5;
-        lightLevelDeNorm = getByte(lightRight, uint((vertexPos.y + 0.5) * 1 + (vertexPos.z + 0.5) * 2));
+        lightLevel = getCorner(0u, uint((vertexPos.y + 0.5) * 1 + (vertexPos.z + 0.5) * 2));
     }
     if (faceNormal.x == -1) {
-        if (getByte(lightLeft, 0u) + getByte(lightLeft, 3u) > getByte(lightLeft, 1u) + getByte(lightLeft, 2u)) {
+        if (getCorner(1u, 0u) + getCorner(1u, 3u) > getCorner(1u, 1u) + getCorner(1u, 2u)) {
             float y = vertexPos.y;
             vertexPos.y = vertexPos.z;
             vertexPos.z = -y;
         }
         texCoord.x = vertexPos.z + 0.5;
         texCoord.y = vertexPos.y + 0.5;
-        lightLevelDeNorm = getByte(lightLeft, uint((vertexPos.y + 0.5) * 1 + (vertexPos.z + 0.5) * 2));
+        lightLevel = getCorner(1u, uint((vertexPos.y + 0.5) * 1 + (vertexPos.z + 0.5) * 2));
     }
     if (faceNormal.y == 1) {
-        if (getByte(lightTop, 0u) + getByte(lightTop, 3u) > getByte(lightTop, 1u) + getByte(lightTop, 2u)) {
+        if (getCorner(2u, 0u) + getCorner(2u, 3u) > getCorner(2u, 1u) + getCorner(2u, 2u)) {
             float x = vertexPos.x;
             vertexPos.x = vertexPos.z;
             vertexPos.z = -x;
         }
         texCoord.x = vertexPos.x + 0.5;
         texCoord.y = vertexPos.z + 0.5;
-        lightLevelDeNorm = getByte(lightTop, uint((vertexPos.x + 0.5) * 1 + (vertexPos.z + 0.5) * 2));
+        lightLevel = getCorner(2u, uint((vertexPos.x + 0.5) * 1 + (vertexPos.z + 0.5) * 2));
     }
     if (faceNormal.y == -1) {
-        if (getByte(lightBottom, 0u) + getByte(lightBottom, 3u) > getByte(lightBottom, 1u) + getByte(lightBottom, 2u)) {
+        if (getCorner(3u, 0u) + getCorner(3u, 3u) > getCorner(3u, 1u) + getCorner(3u, 2u)) {
             float x = vertexPos.x;
             vertexPos.x = vertexPos.z;
             vertexPos.z = -x;
         }
         texCoord.x = vertexPos.x + 0.5;
         texCoord.y = vertexPos.z + 0.5;
-        lightLevelDeNorm = getByte(lightBottom, uint((vertexPos.x + 0.5) * 1 + (vertexPos.z + 0.5) * 2));
+        lightLevel = getCorner(3u, uint((vertexPos.x + 0.5) * 1 + (vertexPos.z + 0.5) * 2));
     }
     if (faceNormal.z == 1) {
-        if (getByte(lightFront, 0u) + getByte(lightFront, 3u) > getByte(lightFront, 1u) + getByte(lightFront, 2u)) {
+        if (getCorner(4u, 0u) + getCorner(4u, 3u) > getCorner(4u, 1u) + getCorner(4u, 2u)) {
             float x = vertexPos.x;
             vertexPos.x = vertexPos.y;
             vertexPos.y = -x;
         }
         texCoord.x = vertexPos.x + 0.5;
         texCoord.y = vertexPos.y + 0.5;
-        lightLevelDeNorm = getByte(lightFront, uint((vertexPos.x + 0.5) * 1 + (vertexPos.y + 0.5) * 2));
+        lightLevel = getCorner(4u, uint((vertexPos.x + 0.5) * 1 + (vertexPos.y + 0.5) * 2));
     }
     if (faceNormal.z == -1) {
-        if (getByte(lightBack, 0u) + getByte(lightBack, 3u) > getByte(lightBack, 1u) + getByte(lightBack, 2u)) {
+        if (getCorner(5u, 0u) + getCorner(5u, 3u) > getCorner(5u, 1u) + getCorner(5u, 2u)) {
             float x = vertexPos.x;
             vertexPos.x = vertexPos.y;
             vertexPos.y = -x;
         }
         texCoord.x = vertexPos.x + 0.5;
         texCoord.y = vertexPos.y + 0.5;
-        lightLevelDeNorm = getByte(lightBack, uint((vertexPos.x + 0.5) * 1 + (vertexPos.y + 0.5) * 2));
+        lightLevel = getCorner(5u, uint((vertexPos.x + 0.5) * 1 + (vertexPos.y + 0.5) * 2));
     }
-    return lightLevelDeNorm / 255.0;
+    return lightLevel;
 }
 
 void main()
@@ -106,12 +109,20 @@ void main()
     vec2 texCoord = vec2(0);
     float lightLevel = getLight(inNormal, vertexPosition, texCoord);
 
+    vec3 blockLocation = vec3(
+        blockInfo.x & 0x7FFu,
+        (blockInfo.x >> 11u) & 0xFFu,
+        (blockInfo.x >> 19u) & 0x7FFu) - vec3(worldSize / 2u) + vec3(0.5);
+
     o.worldPosition = origin + vec3(blockLocation + vertexPosition);
     o.normal = inNormal;
     o.texCoord = texCoord;
-    o.blockID = blockID;
+    o.blockID = blockInfo.y >> 24u;
     o.lightLevel = lightLevel;
-    o.lightColor = lightColor;
+    o.lightColor = vec3(
+        (blockInfo.z >> 24u) & 0xFu,
+        blockInfo.z >> 28u,
+        (blockInfo.w >> 24u) & 0xFu) * (255.0 / 15.0);
 
     gl_Position = VP * vec4(o.worldPosition, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#version 330 core
+
+// VSGreedyVertex, one quad covers a whole run of equal faces
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec2 inTexCoord;
+layout (location = 3) in float inLightLevel;
+// block id (8 bits), light color red, green, blue (4 bits each)
+layout (location = 4) in uint inBlockIDAndLightColor;
+
+uniform vec3 origin;
+
+out VertexData {
+    vec3 worldPosition;
+    vec3 normal;
+    vec2 texCoord;
+    flat uint blockID;
+    float lightLevel;
+    vec3 lightColor;
+} o;
+
+uniform mat4 VP;
+
+void main()
+{
+    o.worldPosition = origin + inPosition;
+    o.normal = inNormal;
+    o.texCoord = inTexCoord;
+    o.blockID = inBlockIDAndLightColor & 0xFFu;
+    o.lightLevel = inLightLevel;
+    o.lightColor = vec3(
+        (inBlockIDAndLightColor >> 8u) & 0xFu,
+        (inBlockIDAndLightColor >> 12u) & 0xFu,
+        (inBlockIDAndLightColor >> 16u) & 0xFu) * (255.0 / 15.0);
+
+    gl_Position = VP * vec4(o.worldPosition, 1.0);
+}
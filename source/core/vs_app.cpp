@@ -19,6 +19,7 @@
 #include "core/vs_game.h"
 #include "core/vs_debug_draw.h"
 #include "core/vs_input_handler.h"
+#include "core/vs_thread_pool.h"
 
 #include "world/vs_chunk_manager.h"
 
@@ -28,6 +29,7 @@
 #include "world/vs_block.h"
 #include "world/vs_chunk_manager.h"
 #include "world/vs_world.h"
+#include "world/generator/vs_heightmap.h"
 #include "world/vs_skybox.h"
 
 VSApp* VSApp::instance = nullptr;
@@ -40,12 +42,19 @@ VSApp::VSApp()
     {
         VSApp::instance = this;
     }
+
+    // Before initialize, so tools and checks without a window can use the pool as well
+    debug_setMainThread();
+    threadPool = std::make_unique<VSThreadPool>();
 }
 
-int VSApp::initialize()
+VSApp::~VSApp()
 {
-    debug_setMainThread();
+    threadPool.reset();
+}
 
+int VSApp::initialize()
+{
     appStart = std::chrono::high_resolution_clock::now();
 
     const auto glfwError = initializeGLFW();
@@ -224,6 +233,11 @@ GLFWwindow* VSApp::getWindow() const
     return window;
 }
 
+VSThreadPool* VSApp::getThreadPool() const
+{
+    return threadPool.get();
+}
+
 std::chrono::high_resolution_clock::time_point VSApp::getStartTime() const
 {
     return appStart;
@@ -268,6 +282,62 @@ int VSApp::mainLoop()
         UI->getMutableState()->visibleBlockCount = world->getChunkManager()->getVisibleBlockCount();
         UI->getMutableState()->drawnBlockCount = world->getChunkManager()->getDrawnBlockCount();
         UI->getMutableState()->drawCallCount = world->getChunkManager()->getDrawCallCount();
+        UI->getMutableState()->drawnTriangleCount =
+            world->getChunkManager()->getDrawnTriangleCount();
+        UI->getMutableState()->drawnVertexCount = world->getChunkManager()->getDrawnVertexCount();
+        UI->getMutableState()->visibilityKernelMicroseconds =
+            world->getChunkManager()->getAverageVisibilityKernelMicroseconds();
+        UI->getMutableState()->shadowKernelMilliseconds =
+            world->getChunkManager()->getAverageShadowKernelMilliseconds();
+        UI->getMutableState()->totalChunkCount = world->getChunkManager()->getTotalChunkCount();
+        UI->getMutableState()->blockStorageByteCount =
+            world->getChunkManager()->getBlockStorageByteCount();
+        UI->getMutableState()->instanceUploadByteCount =
+            world->getChunkManager()->getInstanceUploadByteCount();
+        UI->getMutableState()->instanceBufferByteCount =
+            world->getChunkManager()->getInstanceBufferByteCount();
+        UI->getMutableState()->shadowUploadByteCount =
+            world->getChunkManager()->getShadowUploadByteCount();
+        UI->getMutableState()->threadPoolThreadCount = threadPool->getThreadCount();
+        UI->getMutableState()->queuedJobCount = threadPool->getQueuedJobCount();
+        UI->getMutableState()->runningJobCount = threadPool->getRunningJobCount();
+        UI->getMutableState()->jobLatencyMilliseconds =
+            threadPool->getAverageJobLatencyMilliseconds();
+        UI->getMutableState()->jobRunMilliseconds = threadPool->getAverageJobRunMilliseconds();
+        UI->getMutableState()->firstVisibleFrameMilliseconds =
+            world->getChunkManager()->getFirstVisibleFrameMilliseconds();
+        UI->getMutableState()->lightUpdateBlockCount =
+            world->getChunkManager()->getLightUpdateBlockCount();
+        UI->getMutableState()->shadowRegionBlockCount =
+            world->getChunkManager()->getLastShadowRegionBlockCount();
+
+        if (UI->getState()->bShouldRunTraceBenchmark)
+        {
+            UI->getMutableState()->bShouldRunTraceBenchmark = false;
+            const auto benchmarkResult = world->getChunkManager()->runTraceBenchmark(
+                traceBenchmarkRayCount, world->getDirectLightDir());
+            UI->getMutableState()->traceRaysPerSecond = benchmarkResult.raysPerSecond;
+            UI->getMutableState()->batchedTraceRaysPerSecond =
+                benchmarkResult.batchedRaysPerSecond;
+            UI->getMutableState()->sunQueriesPerSecond = benchmarkResult.sunQueriesPerSecond;
+        }
+
+        if (UI->getState()->bShouldRunNoiseBenchmark)
+        {
+            UI->getMutableState()->bShouldRunNoiseBenchmark = false;
+            // Same settings as the mountains biome
+            const auto worldHeight = world->getChunkManager()->getWorldSize().y;
+            const VSHeightmap heightmap(worldHeight, 4, 0.01F, worldHeight, 1.F, 0.5F);
+            const auto chunkSize = world->getChunkManager()->getChunkSize();
+            const auto benchmarkResult =
+                heightmap.runBenchmark({chunkSize.x, chunkSize.z}, noiseBenchmarkTileCount);
+            UI->getMutableState()->noiseSamplesPerSecond = benchmarkResult.samplesPerSecond;
+            UI->getMutableState()->batchedNoiseSamplesPerSecond =
+                benchmarkResult.batchedSamplesPerSecond;
+            UI->getMutableState()->noiseMaxError = benchmarkResult.maxError;
+            UI->getMutableState()->noiseVoxelHeightMismatchRatio =
+                benchmarkResult.voxelHeightMismatchRatio;
+        }
 
         world->setDirectLightDir(UI->getState()->directLightDir);
 
@@ -309,6 +379,9 @@ int VSApp::mainLoop()
 
     gameThread.join();
 
+    // runs the queued jobs and waits for them
+    threadPool.reset();
+
     // Cleanup
     UI->cleanup();
 
@@ -315,16 +315,13 @@ void VSRTSCameraController::setCameraRelativeXZ(float relativeX, float relativeZ
     float absoluteZ = (relativeZ - 0.5) * worldSize.z;
     int blockX = std::round(absoluteX);
     int blockZ = std::round(absoluteZ);
-    for (int y = -worldSize.y / 2; y < worldSize.y / 2; y++)
+    // y of the highest block in the column
+    const int y = world->getChunkManager()->getSurfaceHeight(blockX, blockZ) - 1;
+    if (y >= -worldSize.y / 2)
     {
-        glm::ivec3 blockCoordinates = {blockX, y, blockZ};
-        if (world->getChunkManager()->getBlock(blockCoordinates) > 0)
-        {
-            const auto newPosition =
-                glm::vec3({absoluteX, y, absoluteZ}) - cam->getFront() * radius;
-            targetPosition = newPosition;
-            adaptToFixpoint();
-            cam->setPosition(targetPosition);
-        }
+        const auto newPosition = glm::vec3({absoluteX, y, absoluteZ}) - cam->getFront() * radius;
+        targetPosition = newPosition;
+        adaptToFixpoint();
+        cam->setPosition(targetPosition);
     }
 }
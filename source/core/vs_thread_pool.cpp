@@ -0,0 +1,205 @@
+#include "core/vs_thread_pool.h"
+
+#include <algorithm>
+
+VSThreadPool::VSThreadPool(std::size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency() == 0
+                          ? 4
+                          : static_cast<std::size_t>(std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < threadCount; i++)
+    {
+        queues.push_back(std::make_unique<VSWorkerQueue>());
+    }
+
+    // start the workers after all queues exist, they steal from each other right away
+    for (std::size_t i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&VSThreadPool::workerLoop, this, i);
+    }
+}
+
+VSThreadPool::~VSThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        bShouldStop = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void VSThreadPool::submit(VSJob job)
+{
+    // count before pushing, otherwise a worker can take the job and decrement the count first,
+    // which wraps it around. A worker that sees the count early retries until the job is there.
+    queuedJobCount++;
+
+    auto& queue = *queues[nextQueue.fetch_add(1) % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back({std::move(job), VSClock::now()});
+    }
+
+    {
+        // lock so a worker can not miss the notification between checking and waiting
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+void VSThreadPool::parallelFor(
+    std::size_t taskCount,
+    const std::function<void(std::size_t)>& task)
+{
+    if (taskCount == 0)
+    {
+        return;
+    }
+
+    // Shared with the jobs. A job that only starts after the loop is done finds no task left and
+    // returns without touching task.
+    struct VSParallelFor
+    {
+        std::atomic<std::size_t> nextTask = 0;
+        std::atomic<std::size_t> finishedTaskCount = 0;
+        std::mutex mutex;
+        std::condition_variable finishedCondition;
+    };
+
+    const auto loop = std::make_shared<VSParallelFor>();
+    const auto runTasks = [loop, taskCount, &task]() {
+        for (auto taskIndex = loop->nextTask++; taskIndex < taskCount; taskIndex = loop->nextTask++)
+        {
+            task(taskIndex);
+
+            if (++loop->finishedTaskCount == taskCount)
+            {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->finishedCondition.notify_all();
+            }
+        }
+    };
+
+    const auto helperCount = std::min(workers.size(), taskCount - 1);
+    for (std::size_t helperIndex = 0; helperIndex < helperCount; helperIndex++)
+    {
+        submit(runTasks);
+    }
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finishedCondition.wait(
+        lock, [&loop, taskCount]() { return loop->finishedTaskCount == taskCount; });
+}
+
+std::size_t VSThreadPool::getThreadCount() const
+{
+    return workers.size();
+}
+
+std::size_t VSThreadPool::getQueuedJobCount() const
+{
+    return queuedJobCount;
+}
+
+std::size_t VSThreadPool::getRunningJobCount() const
+{
+    return runningJobCount;
+}
+
+std::uint64_t VSThreadPool::getCompletedJobCount() const
+{
+    return completedJobCount;
+}
+
+float VSThreadPool::getAverageJobLatencyMilliseconds() const
+{
+    const auto startedJobCount = completedJobCount.load();
+    if (startedJobCount == 0)
+    {
+        return 0.F;
+    }
+    return static_cast<float>(jobLatencyNanoseconds) / static_cast<float>(startedJobCount) / 1e6F;
+}
+
+float VSThreadPool::getAverageJobRunMilliseconds() const
+{
+    const auto finishedJobCount = completedJobCount.load();
+    if (finishedJobCount == 0)
+    {
+        return 0.F;
+    }
+    return static_cast<float>(jobRunNanoseconds) / static_cast<float>(finishedJobCount) / 1e6F;
+}
+
+void VSThreadPool::workerLoop(std::size_t workerIndex)
+{
+    while (true)
+    {
+        VSQueuedJob queuedJob;
+        if (popJob(workerIndex, queuedJob))
+        {
+            queuedJobCount--;
+            runningJobCount++;
+
+            const auto startTime = VSClock::now();
+            queuedJob.job();
+            const auto endTime = VSClock::now();
+
+            jobLatencyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         startTime - queuedJob.submitTime)
+                                         .count();
+            jobRunNanoseconds +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+            completedJobCount++;
+            runningJobCount--;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]() { return bShouldStop || queuedJobCount > 0; });
+        if (bShouldStop)
+        {
+            return;
+        }
+    }
+}
+
+bool VSThreadPool::popJob(std::size_t workerIndex, VSQueuedJob& outJob)
+{
+    // oldest job of our own queue first
+    {
+        auto& queue = *queues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            outJob = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            return true;
+        }
+    }
+
+    // then steal the newest job of the others, starting with our neighbour
+    for (std::size_t offset = 1; offset < queues.size(); offset++)
+    {
+        auto& queue = *queues[(workerIndex + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            outJob = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -1,4 +1,5 @@
 #include "game/systems/editor_system.h"
+#include <glm/common.hpp>
 #include <glm/fwd.hpp>
 #include "game/components/bounds.h"
 #include "ui/vs_parser.h"
@@ -37,17 +38,10 @@ void updateEditorSystem(entt::registry& mainRegistry)
                 const auto low = discreteMouse + bounds.min;
                 const auto high = discreteMouse + bounds.max;
 
-                for (int x = low.x; x < high.x; x++)
-                {
-                    for (int y = low.y; y < high.y; y++)
-                    {
-                        for (int z = low.z; z < high.z; z++)
-                        {
-                            worldContext.world->getChunkManager()->setBlock(
-                                {x, y, z}, uiContext.editorSelectedBlockID + 1);
-                        }
-                    }
-                }
+                worldContext.world->getChunkManager()->fillBlocks(
+                    glm::ivec3(low),
+                    glm::ivec3(glm::ceil(high)),
+                    uiContext.editorSelectedBlockID + 1);
             }
             else if (inputs.middleButtonState == InputState::JustUp)
             {
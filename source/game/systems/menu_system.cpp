@@ -188,21 +188,22 @@ void updateMenuSystem(entt::registry& mainRegistry, entt::registry& buildingRegi
         {
             if (uiContext.selectedBiomeType == 0)
             {
-                VSTerrainGeneration::buildStandard(world);
+                VSTerrainGeneration::buildStandard(world->getChunkManager(), uiContext.worldSeed);
             }
             else if (uiContext.selectedBiomeType == 1)
             {
-                VSTerrainGeneration::buildMountains(world);
+                VSTerrainGeneration::buildMountains(world->getChunkManager(), uiContext.worldSeed);
             }
             else if (uiContext.selectedBiomeType == 2)
             {
-                VSTerrainGeneration::buildDesert(world);
+                VSTerrainGeneration::buildDesert(world->getChunkManager(), uiContext.worldSeed);
             }
         }
         if (uiContext.bShouldLoadFromFile)
         {
             VSChunkManager::VSWorldData worldData = VSParser::readFromFile(uiContext.loadFilePath);
             world->getChunkManager()->initFromData(worldData);
+            uiContext.worldSeed = worldData.seed;
             uiContext.bShouldLoadFromFile = false;
         }
         uiContext.bShowLoading = false;
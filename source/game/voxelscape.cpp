@@ -353,6 +353,13 @@ void Voxelscape::renderGameConfigGUI(UIContext& uiState)
     ImGui::Combo(
         "Select biome", (int*)&uiState.selectedBiomeType, biomeTypes, IM_ARRAYSIZE(biomeTypes));
 
+    ImGui::InputScalar("World seed", ImGuiDataType_U32, &uiState.worldSeed);
+    ImGui::SameLine();
+    if (ImGui::Button("Random"))
+    {
+        uiState.worldSeed = std::random_device()();
+    }
+
     if (ImGui::Button("Start Game", ImVec2(ImGui::GetWindowContentRegionWidth(), 0.F)))
     {
         uiState.bShouldStartGame = true;
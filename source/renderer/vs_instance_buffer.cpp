@@ -0,0 +1,137 @@
+#include "renderer/vs_instance_buffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+VSInstanceBuffer::VSInstanceBuffer(std::size_t inElementSize) : elementSize(inElementSize)
+{
+}
+
+VSInstanceBuffer::~VSInstanceBuffer()
+{
+    glDeleteBuffers(1, &buffer);
+}
+
+VSInstanceBuffer::VSRange VSInstanceBuffer::allocate(std::size_t count)
+{
+    if (count == 0)
+    {
+        return {};
+    }
+
+    auto freeRange = std::find_if(freeRanges.begin(), freeRanges.end(), [count](const auto& range) {
+        return range.second >= count;
+    });
+
+    if (freeRange == freeRanges.end())
+    {
+        grow(capacity + count);
+        freeRange = std::find_if(freeRanges.begin(), freeRanges.end(), [count](const auto& range) {
+            return range.second >= count;
+        });
+        assert(freeRange != freeRanges.end());
+    }
+
+    const auto [offset, freeCount] = *freeRange;
+    freeRanges.erase(freeRange);
+    if (freeCount > count)
+    {
+        freeRanges.emplace(offset + count, freeCount - count);
+    }
+
+    usedCount += count;
+    return {offset, count};
+}
+
+void VSInstanceBuffer::free(VSRange& range)
+{
+    if (range.count == 0)
+    {
+        return;
+    }
+
+    assert(range.offset + range.count <= capacity);
+    usedCount -= range.count;
+    addFreeRange(range.offset, range.count);
+    range = {};
+}
+
+void VSInstanceBuffer::write(const VSRange& range, const void* data) const
+{
+    if (range.count == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferSubData(
+        GL_ARRAY_BUFFER, range.offset * elementSize, range.count * elementSize, data);
+}
+
+GLuint VSInstanceBuffer::getBuffer() const
+{
+    return buffer;
+}
+
+std::size_t VSInstanceBuffer::getElementSize() const
+{
+    return elementSize;
+}
+
+std::size_t VSInstanceBuffer::getCapacity() const
+{
+    return capacity;
+}
+
+std::size_t VSInstanceBuffer::getUsedCount() const
+{
+    return usedCount;
+}
+
+void VSInstanceBuffer::grow(std::size_t minCapacity)
+{
+    const auto newCapacity = std::max({minCapacity, capacity * 2, minGrowCount});
+
+    GLuint newBuffer = 0;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * elementSize, nullptr, GL_DYNAMIC_DRAW);
+
+    if (buffer != 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(
+            GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, capacity * elementSize);
+        glDeleteBuffers(1, &buffer);
+    }
+
+    addFreeRange(capacity, newCapacity - capacity);
+    buffer = newBuffer;
+    capacity = newCapacity;
+}
+
+void VSInstanceBuffer::addFreeRange(std::size_t offset, std::size_t count)
+{
+    auto [range, bInserted] = freeRanges.emplace(offset, count);
+    assert(bInserted);
+
+    // merge with the following range
+    const auto next = std::next(range);
+    if (next != freeRanges.end() && range->first + range->second == next->first)
+    {
+        range->second += next->second;
+        freeRanges.erase(next);
+    }
+
+    // merge with the preceding range
+    if (range != freeRanges.begin())
+    {
+        const auto previous = std::prev(range);
+        if (previous->first + previous->second == range->first)
+        {
+            previous->second += range->second;
+            freeRanges.erase(range);
+        }
+    }
+}
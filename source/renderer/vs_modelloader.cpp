@@ -7,7 +7,57 @@
 #include "renderer/vs_modelloader.h"
 #include "renderer/vs_textureloader.h"
 
+namespace
+{
+    void appendMeshVertices(
+        const aiMesh* mesh,
+        std::vector<VSVertexData>& vertexDataList,
+        std::vector<GLuint>& triangleIndices)
+    {
+        // the following only works if assimp and glm vector have the same size
+        assert(sizeof(glm::vec3) == sizeof(aiVector3D));
+
+        for (std::size_t i = 0; i < mesh->mNumVertices; i++)
+        {
+            VSVertexData currentVertex{};
+            currentVertex.position = {
+                mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z};
+
+            currentVertex.normal = {mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z};
+
+            vertexDataList.emplace_back(currentVertex);
+        }
+
+        // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve
+        // the corresponding vertex indices.
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        {
+            aiFace face = mesh->mFaces[i];
+            // retrieve all indices of the face and store them in the indices vector
+            for (unsigned int j = 0; j < face.mNumIndices; j++)
+            {
+                triangleIndices.push_back(face.mIndices[j]);
+            }
+        }
+    }
+}  // namespace
+
 VSVertexContext* loadVertexContext(std::string const& path)
+{
+    std::vector<VSVertexData> vertexDataList;
+    std::vector<GLuint> triangleIndices;
+    if (!appendMeshData(path, vertexDataList, triangleIndices))
+    {
+        return {};
+    }
+
+    return new VSVertexContext(vertexDataList, triangleIndices);
+}
+
+bool appendMeshData(
+    std::string const& path,
+    std::vector<VSVertexData>& vertexData,
+    std::vector<GLuint>& triangleIndices)
 {
     Assimp::Importer importer;
     const aiScene* scene = importer.ReadFile(
@@ -19,42 +69,18 @@ VSVertexContext* loadVertexContext(std::string const& path)
             VSLog::Level::err,
             "{0}",
             std::string("ERROR::ASSIMP:: ") + importer.GetErrorString());
-        return {};
+        return false;
     }
 
-    return processMeshVertices(scene->mMeshes[0]);
+    appendMeshVertices(scene->mMeshes[0], vertexData, triangleIndices);
+    return true;
 }
 
 VSVertexContext* processMeshVertices(aiMesh*& mesh)
 {
-    // the following only works if assimp and glm vector have the same size
-    assert(sizeof(glm::vec3) == sizeof(aiVector3D));
-
     std::vector<VSVertexData> vertexDataList;
-
-    for (std::size_t i = 0; i < mesh->mNumVertices; i++)
-    {
-        VSVertexData currentVertex{};
-        currentVertex.position = {mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z};
-
-        currentVertex.normal = {mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z};
-
-        vertexDataList.emplace_back(currentVertex);
-    }
-
     std::vector<GLuint> triangleIndices;
-
-    // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the
-    // corresponding vertex indices.
-    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-    {
-        aiFace face = mesh->mFaces[i];
-        // retrieve all indices of the face and store them in the indices vector
-        for (unsigned int j = 0; j < face.mNumIndices; j++)
-        {
-            triangleIndices.push_back(face.mIndices[j]);
-        }
-    }
+    appendMeshVertices(mesh, vertexDataList, triangleIndices);
 
     return new VSVertexContext(vertexDataList, triangleIndices);
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+#include "renderer/vs_pixel_upload_ring.h"
+
+#include <cassert>
+
+VSPixelUploadRing::VSPixelUploadRing(std::size_t inSlotCount, std::size_t inSlotSize)
+    : slotSize(inSlotSize)
+{
+    if (GLAD_GL_VERSION_4_4 == 0 || inSlotCount == 0 || inSlotSize == 0)
+    {
+        return;
+    }
+
+    // Coherent, writes of the workers are visible to uploads issued after they finished
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, inSlotCount * slotSize, nullptr, flags);
+    mappedData = static_cast<std::uint8_t*>(
+        glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, inSlotCount * slotSize, flags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (mappedData == nullptr)
+    {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        return;
+    }
+
+    slotStates.resize(inSlotCount, VSSlotState::Free);
+    slotFences.resize(inSlotCount, nullptr);
+}
+
+VSPixelUploadRing::~VSPixelUploadRing()
+{
+    for (auto* fence : slotFences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+        }
+    }
+
+    if (buffer != 0)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+bool VSPixelUploadRing::isAvailable() const
+{
+    return mappedData != nullptr;
+}
+
+int VSPixelUploadRing::acquire()
+{
+    for (std::size_t slot = 0; slot < slotStates.size(); slot++)
+    {
+        if (slotStates[slot] == VSSlotState::Uploading)
+        {
+            // Only polls, a slot the GPU still reads is skipped
+            const auto waitResult = glClientWaitSync(slotFences[slot], 0, 0);
+            if (waitResult != GL_ALREADY_SIGNALED && waitResult != GL_CONDITION_SATISFIED)
+            {
+                continue;
+            }
+            glDeleteSync(slotFences[slot]);
+            slotFences[slot] = nullptr;
+            slotStates[slot] = VSSlotState::Free;
+        }
+
+        if (slotStates[slot] == VSSlotState::Free)
+        {
+            slotStates[slot] = VSSlotState::Acquired;
+            return static_cast<int>(slot);
+        }
+    }
+
+    return invalidSlot;
+}
+
+void VSPixelUploadRing::release(int slot)
+{
+    assert(slotStates[slot] == VSSlotState::Acquired);
+    slotFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slotStates[slot] = VSSlotState::Uploading;
+}
+
+void VSPixelUploadRing::discard(int slot)
+{
+    assert(slotStates[slot] == VSSlotState::Acquired);
+    slotStates[slot] = VSSlotState::Free;
+}
+
+std::uint8_t* VSPixelUploadRing::getSlotData(int slot) const
+{
+    return mappedData + getSlotOffset(slot);
+}
+
+std::size_t VSPixelUploadRing::getSlotOffset(int slot) const
+{
+    return static_cast<std::size_t>(slot) * slotSize;
+}
+
+std::size_t VSPixelUploadRing::getSlotSize() const
+{
+    return slotSize;
+}
+
+GLuint VSPixelUploadRing::getBuffer() const
+{
+    return buffer;
+}
@@ -17,36 +17,50 @@ VSShader::VSShader(const char* name, bool bIsComputeShader)
         glDetachShader(ID, computeShaderID);
         glDeleteShader(computeShaderID);
     } else {
-        GLuint vertexShaderID = compileShader(vertexShaderPath, GL_VERTEX_SHADER);
-        glAttachShader(ID, vertexShaderID);
-
-        const auto fragmentShaderPath = (shaderDirectory / name).replace_extension(".fs");
-
-        GLuint fragmentShaderID = -1;
-        if (!std::filesystem::exists(fragmentShaderPath))
-        {
-            VSLog::Log(
-                VSLog::Category::Shader,
-                VSLog::Level::warn,
-                "Vertex shader: {} is present, but corresponding fragment shader: % is missing",
-                vertexShaderPath.string(),
-                fragmentShaderPath.string());
-        }
-        else
-        {
-            fragmentShaderID = compileShader(fragmentShaderPath, GL_FRAGMENT_SHADER);
-            glAttachShader(ID, fragmentShaderID);
-        }
-        glLinkProgram(ID);
+        linkProgram(vertexShaderPath, (shaderDirectory / name).replace_extension(".fs"));
+    }
+}
 
-        checkProgramLinkErrors(ID);
+VSShader::VSShader(const char* vertexShaderName, const char* fragmentShaderName)
+{
+    ID = glCreateProgram();
+
+    linkProgram(
+        (shaderDirectory / vertexShaderName).replace_extension(".vs"),
+        (shaderDirectory / fragmentShaderName).replace_extension(".fs"));
+}
 
-        glDetachShader(ID, vertexShaderID);
-        glDetachShader(ID, fragmentShaderID);
+void VSShader::linkProgram(
+    const std::filesystem::path& vertexShaderPath,
+    const std::filesystem::path& fragmentShaderPath)
+{
+    GLuint vertexShaderID = compileShader(vertexShaderPath, GL_VERTEX_SHADER);
+    glAttachShader(ID, vertexShaderID);
 
-        glDeleteShader(vertexShaderID);
-        glDeleteShader(fragmentShaderID);
+    GLuint fragmentShaderID = -1;
+    if (!std::filesystem::exists(fragmentShaderPath))
+    {
+        VSLog::Log(
+            VSLog::Category::Shader,
+            VSLog::Level::warn,
+            "Vertex shader: {} is present, but corresponding fragment shader: % is missing",
+            vertexShaderPath.string(),
+            fragmentShaderPath.string());
+    }
+    else
+    {
+        fragmentShaderID = compileShader(fragmentShaderPath, GL_FRAGMENT_SHADER);
+        glAttachShader(ID, fragmentShaderID);
     }
+    glLinkProgram(ID);
+
+    checkProgramLinkErrors(ID);
+
+    glDetachShader(ID, vertexShaderID);
+    glDetachShader(ID, fragmentShaderID);
+
+    glDeleteShader(vertexShaderID);
+    glDeleteShader(fragmentShaderID);
 }
 
 GLuint VSShader::getID() const
@@ -19,6 +19,7 @@ namespace VSParser
         json["chunkCount"] = {worldData.chunkCount.x, worldData.chunkCount.y};
         json["chunkSize"] = {worldData.chunkSize.x, worldData.chunkSize.y, worldData.chunkSize.z};
         json["blocks"] = worldData.blocks;
+        json["seed"] = worldData.seed;
         outFile << json << std::endl;
         outFile.close();
         return true;
@@ -108,6 +109,12 @@ namespace VSParser
         worldData.chunkSize.y = chunkSizeVec.at(1);
         worldData.chunkSize.z = chunkSizeVec.at(2);
 
+        // Optional, older files have no seed
+        if (json.find("seed") != json.end())
+        {
+            json.at("seed").get_to(worldData.seed);
+        }
+
         return worldData;
     }
 }  // namespace VSParser
@@ -88,12 +88,72 @@ void VSUI::renderDebugGUI()
     ImGui::Checkbox("Show UVs", (bool*)&uiState->bShouldShowUV);
     ImGui::Checkbox("Show Normals", (bool*)&uiState->bShouldShowNormals);
     ImGui::Checkbox("Show Light", (bool*)&uiState->bShouldShowLight);
+    ImGui::Checkbox("Multi draw indirect", (bool*)&uiState->bIsMultiDrawIndirectEnabled);
+    ImGui::Checkbox("Greedy meshing", (bool*)&uiState->bIsGreedyMeshingEnabled);
+    ImGui::Checkbox("Bitmask visibility", (bool*)&uiState->bIsBitmaskVisibilityEnabled);
+    ImGui::Checkbox("Sky light", (bool*)&uiState->bIsSkyLightEnabled);
+    ImGui::Checkbox("Distance transform", (bool*)&uiState->bIsDistanceTransformEnabled);
     ImGui::Text(
         "Blocks Total; Visible; Drawn: %d; %d; %d",
         uiState->totalBlockCount,
         uiState->visibleBlockCount,
         uiState->drawnBlockCount);
-    ImGui::Text("Drawcalls %d/64", uiState->drawCallCount);
+    ImGui::Text("Drawcalls %d", uiState->drawCallCount);
+    ImGui::Text(
+        "Triangles; Vertices: %zu; %zu", uiState->drawnTriangleCount, uiState->drawnVertexCount);
+    ImGui::Text(
+        "Visibility kernel (%s) %.1f us/chunk",
+        uiState->bIsBitmaskVisibilityEnabled ? "bitmask" : "scalar",
+        uiState->visibilityKernelMicroseconds);
+    ImGui::Text(
+        "Shadow kernel (%s) %.2f ms/chunk",
+        uiState->bIsDistanceTransformEnabled ? "transform" : "brute force",
+        uiState->shadowKernelMilliseconds);
+    ImGui::Text(
+        "Block storage %.2f MiB (%zu bytes/chunk)",
+        static_cast<float>(uiState->blockStorageByteCount) / (1024.F * 1024.F),
+        uiState->totalChunkCount > 0 ? uiState->blockStorageByteCount / uiState->totalChunkCount
+                                     : 0);
+    ImGui::Text(
+        "Instance upload %.1f KiB/frame (buffers %.2f MiB)",
+        static_cast<float>(uiState->instanceUploadByteCount) / 1024.F,
+        static_cast<float>(uiState->instanceBufferByteCount) / (1024.F * 1024.F));
+    ImGui::Text(
+        "Shadow upload %.1f KiB/frame",
+        static_cast<float>(uiState->shadowUploadByteCount) / 1024.F);
+    ImGui::Text(
+        "Jobs queued; running: %zu; %zu (%zu threads)",
+        uiState->queuedJobCount,
+        uiState->runningJobCount,
+        uiState->threadPoolThreadCount);
+    ImGui::Text(
+        "Job latency %.2f ms, run %.2f ms",
+        uiState->jobLatencyMilliseconds,
+        uiState->jobRunMilliseconds);
+    ImGui::Text("First visible frame %.1f ms after load", uiState->firstVisibleFrameMilliseconds);
+    ImGui::Text("Last light update %zu blocks", uiState->lightUpdateBlockCount);
+    ImGui::Text("Last shadow region %zu blocks", uiState->shadowRegionBlockCount);
+    if (ImGui::Button("Trace benchmark"))
+    {
+        uiState->bShouldRunTraceBenchmark = true;
+    }
+    ImGui::SameLine();
+    ImGui::Text(
+        "%.2f Mrays/s (batched %.2f), sun queries %.2f M/s",
+        uiState->traceRaysPerSecond / 1e6F,
+        uiState->batchedTraceRaysPerSecond / 1e6F,
+        uiState->sunQueriesPerSecond / 1e6F);
+    if (ImGui::Button("Noise benchmark"))
+    {
+        uiState->bShouldRunNoiseBenchmark = true;
+    }
+    ImGui::SameLine();
+    ImGui::Text(
+        "%.2f Msamples/s (tiles %.2f), max error %.2e, voxel mismatches %.3f%%",
+        uiState->noiseSamplesPerSecond / 1e6F,
+        uiState->batchedNoiseSamplesPerSecond / 1e6F,
+        uiState->noiseMaxError,
+        uiState->noiseVoxelHeightMismatchRatio * 100.F);
     ImGui::Text(
         "Application average %.3f ms/frame (%.1f FPS)",
         1000.0f / ImGui::GetIO().Framerate,
@@ -1,5 +1,265 @@
 #include "world/generator/vs_heightmap.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <glm/gtc/noise.hpp>
+#include <random>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VS_HEIGHTMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Four noise samples at once. SSE2 is part of every x86-64 target, other targets get plain
+    // arrays the compiler can vectorize on its own. A float converts to all four lanes, so the
+    // noise below is written once for float (single columns) and VSFloat4.
+#ifdef VS_HEIGHTMAP_SSE2
+    struct VSFloat4
+    {
+        VSFloat4() = default;
+
+        VSFloat4(__m128 inValue)
+            : value(inValue)
+        {
+        }
+
+        VSFloat4(float inValue)
+            : value(_mm_set1_ps(inValue))
+        {
+        }
+
+        __m128 value;
+    };
+
+    VSFloat4 load(const float* values)
+    {
+        return {_mm_loadu_ps(values)};
+    }
+
+    void store(const VSFloat4& a, float* outValues)
+    {
+        _mm_storeu_ps(outValues, a.value);
+    }
+
+    VSFloat4 operator+(const VSFloat4& a, const VSFloat4& b)
+    {
+        return {_mm_add_ps(a.value, b.value)};
+    }
+
+    VSFloat4 operator-(const VSFloat4& a, const VSFloat4& b)
+    {
+        return {_mm_sub_ps(a.value, b.value)};
+    }
+
+    VSFloat4 operator*(const VSFloat4& a, const VSFloat4& b)
+    {
+        return {_mm_mul_ps(a.value, b.value)};
+    }
+
+    VSFloat4 operator/(const VSFloat4& a, const VSFloat4& b)
+    {
+        return {_mm_div_ps(a.value, b.value)};
+    }
+
+    // SSE2 has no floor, truncate and step down where that rounded a negative value up.
+    // Noise coordinates stay far below the int range.
+    VSFloat4 floor(const VSFloat4& a)
+    {
+        const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.value));
+        const __m128 correction = _mm_and_ps(_mm_cmpgt_ps(truncated, a.value), _mm_set1_ps(1.F));
+        return {_mm_sub_ps(truncated, correction)};
+    }
+
+    VSFloat4 abs(const VSFloat4& a)
+    {
+        return {_mm_andnot_ps(_mm_set1_ps(-0.F), a.value)};
+    }
+#else
+    struct VSFloat4
+    {
+        VSFloat4() = default;
+
+        VSFloat4(float inValue)
+            : value{inValue, inValue, inValue, inValue}
+        {
+        }
+
+        std::array<float, 4> value;
+    };
+
+    template <typename F>
+    VSFloat4 map(F function)
+    {
+        VSFloat4 result;
+        for (std::size_t lane = 0; lane < 4; lane++)
+        {
+            result.value[lane] = function(lane);
+        }
+        return result;
+    }
+
+    VSFloat4 load(const float* values)
+    {
+        return map([values](std::size_t lane) { return values[lane]; });
+    }
+
+    void store(const VSFloat4& a, float* outValues)
+    {
+        std::copy(a.value.begin(), a.value.end(), outValues);
+    }
+
+    VSFloat4 operator+(const VSFloat4& a, const VSFloat4& b)
+    {
+        return map([&a, &b](std::size_t lane) { return a.value[lane] + b.value[lane]; });
+    }
+
+    VSFloat4 operator-(const VSFloat4& a, const VSFloat4& b)
+    {
+        return map([&a, &b](std::size_t lane) { return a.value[lane] - b.value[lane]; });
+    }
+
+    VSFloat4 operator*(const VSFloat4& a, const VSFloat4& b)
+    {
+        return map([&a, &b](std::size_t lane) { return a.value[lane] * b.value[lane]; });
+    }
+
+    VSFloat4 operator/(const VSFloat4& a, const VSFloat4& b)
+    {
+        return map([&a, &b](std::size_t lane) { return a.value[lane] / b.value[lane]; });
+    }
+
+    VSFloat4 floor(const VSFloat4& a)
+    {
+        return map([&a](std::size_t lane) { return std::floor(a.value[lane]); });
+    }
+
+    VSFloat4 abs(const VSFloat4& a)
+    {
+        return map([&a](std::size_t lane) { return std::abs(a.value[lane]); });
+    }
+#endif
+
+    // Single column versions, float overloads so the double ones are never picked
+    float floor(float a)
+    {
+        return std::floor(a);
+    }
+
+    float abs(float a)
+    {
+        return std::abs(a);
+    }
+
+    template <typename T>
+    T fract(const T& a)
+    {
+        return a - floor(a);
+    }
+
+    template <typename T>
+    T mod289(const T& a)
+    {
+        return a - floor(a * T(1.F / 289.F)) * T(289.F);
+    }
+
+    template <typename T>
+    T permute(const T& a)
+    {
+        return mod289((a * T(34.F) + T(1.F)) * a);
+    }
+
+    // Gradient of the lattice point i (already permuted) dotted with the offset f to the sample
+    template <typename T>
+    T gradientDot(const T& i, const T& fx, const T& fy)
+    {
+        T gx = T(2.F) * fract(i / T(41.F)) - T(1.F);
+        const T gy = abs(gx) - T(0.5F);
+        gx = gx - floor(gx + T(0.5F));
+
+        // Taylor approximation of the inverse length
+        const T norm = T(1.79284291400159F) - T(0.85373472095314F) * (gx * gx + gy * gy);
+        return gx * norm * fx + gy * norm * fy;
+    }
+
+    template <typename T>
+    T fade(const T& t)
+    {
+        return t * t * t * (t * (t * T(6.F) - T(15.F)) + T(10.F));
+    }
+
+    template <typename T>
+    T mix(const T& a, const T& b, const T& t)
+    {
+        return a * (T(1.F) - t) + b * t;
+    }
+
+    // Same steps as glm::perlin(vec2) (Stefan Gustavson's classic noise), per lane
+    template <typename T>
+    T perlin(const T& x, const T& y)
+    {
+        const T x0 = floor(x);
+        const T y0 = floor(y);
+        const T fx0 = x - x0;
+        const T fy0 = y - y0;
+        const T fx1 = fx0 - T(1.F);
+        const T fy1 = fy0 - T(1.F);
+
+        // Wrap the lattice into the permutation range
+        const auto wrap = [](const T& a) { return a - T(289.F) * floor(a / T(289.F)); };
+        const T ix0 = wrap(x0);
+        const T iy0 = wrap(y0);
+        const T ix1 = wrap(x0 + T(1.F));
+        const T iy1 = wrap(y0 + T(1.F));
+
+        const T px0 = permute(ix0);
+        const T px1 = permute(ix1);
+        const T n00 = gradientDot(permute(px0 + iy0), fx0, fy0);
+        const T n10 = gradientDot(permute(px1 + iy0), fx1, fy0);
+        const T n01 = gradientDot(permute(px0 + iy1), fx0, fy1);
+        const T n11 = gradientDot(permute(px1 + iy1), fx1, fy1);
+
+        const T fadeX = fade(fx0);
+        const T fadeY = fade(fy0);
+        return T(2.3F) * mix(mix(n00, n10, fadeX), mix(n01, n11, fadeX), fadeY);
+    }
+
+    struct VSNoiseSettings
+    {
+        unsigned int octaves;
+        float frequency;
+        float amplitude;
+        float lacunarity;
+        float persistence;
+        glm::vec2 offset;
+    };
+
+    // Octaves of perlin at the given columns. Every lane runs the same float operations as a
+    // single column, so both give the same bits as long as nothing gets fused (no FMA).
+    template <typename T>
+    T sampleNoise(const T& x, const T& y, const VSNoiseSettings& settings)
+    {
+        T output(0.F);
+        float denom = 0.F;
+        float frequency = settings.frequency;
+        float amplitude = settings.amplitude;
+
+        for (std::size_t i = 0; i < settings.octaves; ++i)
+        {
+            output = output + T(amplitude) * perlin(
+                                                 x * T(frequency) + T(settings.offset.x),
+                                                 y * T(frequency) + T(settings.offset.y));
+            denom += amplitude;
+
+            frequency *= settings.lacunarity;
+            amplitude *= settings.persistence;
+        }
+
+        return output / T(denom);
+    }
+}  // namespace
 
 VSHeightmap::VSHeightmap(
     unsigned int maxHeight,
@@ -7,7 +267,8 @@ VSHeightmap::VSHeightmap(
     float frequency,
     float amplitude,
     float lacunarity,
-    float persistence)
+    float persistence,
+    std::uint32_t seed)
 {
     mMaxHeight = maxHeight;
     mOctaves = octaves;
@@ -15,9 +276,23 @@ VSHeightmap::VSHeightmap(
     mAmplitude = amplitude;
     mLacunarity = lacunarity;
     mPersistence = persistence;
+
+    // Raw engine output is the same with every standard library, distributions are not.
+    // Offsets stay within +-1024 so the noise coordinates keep their float precision.
+    std::mt19937 engine(seed);
+    mOffset.x = static_cast<float>(engine() % 2048U) - 1024.F;
+    mOffset.y = static_cast<float>(engine() % 2048U) - 1024.F;
+}
+
+float VSHeightmap::getHeight(int x, int y) const
+{
+    return sampleNoise(
+        static_cast<float>(x),
+        static_cast<float>(y),
+        {mOctaves, mFrequency, mAmplitude, mLacunarity, mPersistence, mOffset});
 }
 
-float VSHeightmap::getHeight(int x, int y)
+float VSHeightmap::getReferenceHeight(int x, int y) const
 {
     float output = 0.F;
     float denom = 0.F;
@@ -26,7 +301,7 @@ float VSHeightmap::getHeight(int x, int y)
 
     for (size_t i = 0; i < mOctaves; ++i)
     {
-        output += amplitude * glm::perlin(glm::vec2{x * frequency, y * frequency});
+        output += amplitude * glm::perlin(glm::vec2{x * frequency, y * frequency} + mOffset);
         denom += amplitude;
 
         frequency *= mLacunarity;
@@ -36,6 +311,121 @@ float VSHeightmap::getHeight(int x, int y)
     return (output / denom);
 }
 
+void VSHeightmap::getHeights(
+    const glm::ivec2& tileMin,
+    const glm::ivec2& tileSize,
+    float* outHeights) const
+{
+    const VSNoiseSettings settings = {
+        mOctaves, mFrequency, mAmplitude, mLacunarity, mPersistence, mOffset};
+
+    // Four columns per step, the last step of a row may compute lanes past the tile
+    std::array<float, 4> laneX;
+    std::array<float, 4> laneHeights;
+
+    for (int y = 0; y < tileSize.y; y++)
+    {
+        const VSFloat4 sampleY(static_cast<float>(tileMin.y + y));
+        for (int x = 0; x < tileSize.x; x += 4)
+        {
+            for (int lane = 0; lane < 4; lane++)
+            {
+                laneX[lane] = static_cast<float>(tileMin.x + x + lane);
+            }
+
+            store(sampleNoise(load(laneX.data()), sampleY, settings), laneHeights.data());
+            std::copy_n(
+                laneHeights.begin(),
+                std::min(4, tileSize.x - x),
+                outHeights + y * tileSize.x + x);
+        }
+    }
+}
+
+void VSHeightmap::getVoxelHeights(
+    const glm::ivec2& tileMin,
+    const glm::ivec2& tileSize,
+    int* outHeights) const
+{
+    const auto sampleCount = static_cast<std::size_t>(tileSize.x) * tileSize.y;
+    std::vector<float> heights(sampleCount);
+    getHeights(tileMin, tileSize, heights.data());
+    std::transform(heights.begin(), heights.end(), outHeights, [this](float height) {
+        return toVoxelHeight(height);
+    });
+}
+
+VSHeightmap::VSBenchmarkResult
+VSHeightmap::runBenchmark(const glm::ivec2& tileSize, std::size_t tileCount) const
+{
+    VSBenchmarkResult result;
+    const auto tileSampleCount = static_cast<std::size_t>(tileSize.x) * tileSize.y;
+    if (tileCount == 0 || tileSampleCount == 0)
+    {
+        return result;
+    }
+
+    // Tiles laid out in a square, like the chunks of a world
+    const auto tilesPerRow = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(tileCount))));
+    const auto getTileMin = [&tileSize, tilesPerRow](std::size_t tileIndex) {
+        const int tile = static_cast<int>(tileIndex);
+        return glm::ivec2(tile % tilesPerRow, tile / tilesPerRow) * tileSize;
+    };
+
+    std::vector<float> heights(tileSampleCount * tileCount);
+    std::vector<float> batchedHeights(tileSampleCount * tileCount);
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    for (std::size_t tileIndex = 0; tileIndex < tileCount; tileIndex++)
+    {
+        const auto tileMin = getTileMin(tileIndex);
+        auto* tileHeights = heights.data() + tileIndex * tileSampleCount;
+        for (int y = 0; y < tileSize.y; y++)
+        {
+            for (int x = 0; x < tileSize.x; x++)
+            {
+                tileHeights[x + y * tileSize.x] =
+                    getReferenceHeight(tileMin.x + x, tileMin.y + y);
+            }
+        }
+    }
+    const auto batchedStartTime = std::chrono::high_resolution_clock::now();
+    for (std::size_t tileIndex = 0; tileIndex < tileCount; tileIndex++)
+    {
+        getHeights(
+            getTileMin(tileIndex),
+            tileSize,
+            batchedHeights.data() + tileIndex * tileSampleCount);
+    }
+    const auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::size_t voxelHeightMismatchCount = 0;
+    for (std::size_t sampleIndex = 0; sampleIndex < heights.size(); sampleIndex++)
+    {
+        result.maxError = std::max(
+            result.maxError, std::abs(heights[sampleIndex] - batchedHeights[sampleIndex]));
+
+        const auto voxelHeightDifference = std::abs(
+            toVoxelHeight(heights[sampleIndex]) - toVoxelHeight(batchedHeights[sampleIndex]));
+        if (voxelHeightDifference != 0)
+        {
+            voxelHeightMismatchCount++;
+            result.maxVoxelHeightDifference =
+                std::max(result.maxVoxelHeightDifference, voxelHeightDifference);
+        }
+    }
+    result.voxelHeightMismatchRatio =
+        static_cast<float>(voxelHeightMismatchCount) / static_cast<float>(heights.size());
+
+    const auto sampleCount = static_cast<float>(heights.size());
+    const auto toSeconds = [](const auto duration) {
+        return std::max(std::chrono::duration<float>(duration).count(), 1e-6F);
+    };
+    result.samplesPerSecond = sampleCount / toSeconds(batchedStartTime - startTime);
+    result.batchedSamplesPerSecond = sampleCount / toSeconds(endTime - batchedStartTime);
+    return result;
+}
+
 void VSHeightmap::setMaxHeight(int maxHeight)
 {
     mMaxHeight = maxHeight;
@@ -43,6 +433,11 @@ void VSHeightmap::setMaxHeight(int maxHeight)
 
 int VSHeightmap::getVoxelHeight(int x, int y)
 {
-    float height = getHeight(x, y) * (float)mMaxHeight / 2 + (mMaxHeight / 2);
+    return toVoxelHeight(getHeight(x, y));
+}
+
+int VSHeightmap::toVoxelHeight(float height) const
+{
+    height = height * (float)mMaxHeight / 2 + (mMaxHeight / 2);
     return static_cast<int>(std::round(height));
-}
\ No newline at end of file
+}
@@ -1,7 +1,13 @@
 #include "world/generator/vs_terrain.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <glm/common.hpp>
 #include <glm/fwd.hpp>
 #include <glm/gtx/easing.hpp>
+#include <mutex>
 #include <random>
+#include <tuple>
 #include <vector>
 #include "ui/vs_parser.h"
 #include "world/generator/vs_heightmap.h"
@@ -11,24 +17,152 @@
 
 namespace VSTerrainGeneration
 {
-    void buildStandard(VSWorld* world)
+    namespace
     {
-        auto chunkManager = world->getChunkManager();
+        // Fills the column x, z (chunk coordinates) from the bottom of the chunk up to height
+        void fillColumn(
+            std::vector<VSBlockID>& blocks,
+            const glm::ivec3& chunkSize,
+            int x,
+            int z,
+            int height,
+            VSBlockID blockID)
+        {
+            const int columnTop = glm::min(height, chunkSize.y);
+            for (int y = 0; y < columnTop; y++)
+            {
+                blocks[x + y * chunkSize.x + z * chunkSize.x * chunkSize.y] = blockID;
+            }
+        }
+
+        // Chunks are generated in parallel, every chunk draws from its own engine. Seeded through
+        // std::seed_seq, which is specified exactly, so a seed gives the same world everywhere.
+        std::mt19937 createChunkRandomEngine(std::uint32_t worldSeed, const glm::ivec3& chunkMin)
+        {
+            std::seed_seq seed{
+                worldSeed,
+                static_cast<std::uint32_t>(chunkMin.x),
+                static_cast<std::uint32_t>(chunkMin.z)};
+            return std::mt19937(seed);
+        }
+
+        // Seed of the noise map with the given index
+        std::uint32_t deriveSeed(std::uint32_t worldSeed, std::uint32_t index)
+        {
+            std::seed_seq seed{worldSeed, index};
+            std::uint32_t derivedSeed = 0;
+            seed.generate(&derivedSeed, &derivedSeed + 1);
+            return derivedSeed;
+        }
+
+        // Uniform in [min, max]. The std distributions differ between standard libraries.
+        int randomInt(std::mt19937& engine, int min, int max)
+        {
+            return min + static_cast<int>(engine() % static_cast<std::uint32_t>(max - min + 1));
+        }
+
+        // Structures are collected from all chunks in any order, sorting them makes overlapping
+        // ones come out the same every time
+        void sortLocations(std::vector<glm::ivec3>& locations)
+        {
+            std::sort(locations.begin(), locations.end(), [](const auto& a, const auto& b) {
+                return std::tie(a.x, a.z, a.y) < std::tie(b.x, b.z, b.y);
+            });
+        }
+
+        // Trees and cacti are builds as well, so they are placed like imported models. Their air
+        // blocks keep the terrain.
+        void setBuildBlock(
+            VSChunkManager::VSBuildingData& build,
+            const glm::ivec3& location,
+            VSBlockID blockID)
+        {
+            build.blocks
+                [location.x + location.y * build.buildSize.x +
+                 location.z * build.buildSize.x * build.buildSize.y] = blockID;
+        }
+
+        // Trunk in the middle column, a ring of leaves around its top and one leaf above
+        VSChunkManager::VSBuildingData createTreeBuild(VSBlockID trunkID)
+        {
+            VSChunkManager::VSBuildingData build;
+            build.buildSize = {3, 5, 3};
+            build.blocks.resize(3 * 5 * 3, VS_DEFAULT_BLOCK_ID);
+            for (int y = 0; y < 4; y++)
+            {
+                setBuildBlock(build, {1, y, 1}, trunkID);
+            }
+            for (int x = 0; x < 3; x++)
+            {
+                for (int z = 0; z < 3; z++)
+                {
+                    if (x != 1 || z != 1)
+                    {
+                        setBuildBlock(build, {x, 3, z}, 6);
+                    }
+                }
+            }
+            setBuildBlock(build, {1, 4, 1}, 6);
+            return build;
+        }
+
+        // Trunk at z = 2 with one arm towards each side
+        VSChunkManager::VSBuildingData createCactusBuild()
+        {
+            VSChunkManager::VSBuildingData build;
+            build.buildSize = {1, 6, 5};
+            build.blocks.resize(1 * 6 * 5, VS_DEFAULT_BLOCK_ID);
+            for (int y = 0; y < 6; y++)
+            {
+                setBuildBlock(build, {0, y, 2}, 8);
+            }
+            for (const auto& location : std::array<glm::ivec3, 6>{
+                     {{0, 1, 3}, {0, 1, 4}, {0, 2, 4}, {0, 2, 1}, {0, 2, 0}, {0, 3, 0}}})
+            {
+                setBuildBlock(build, location, 8);
+            }
+            return build;
+        }
+
+        // Min corner of a tree build whose trunk stands at location
+        glm::ivec3 getTreeMin(const glm::ivec3& location)
+        {
+            return location - glm::ivec3(1, 0, 1);
+        }
+
+        glm::ivec3 getCactusMin(const glm::ivec3& location)
+        {
+            return location - glm::ivec3(0, 0, 2);
+        }
+
+        // Models are centered on x, z and sunk one block into the ground
+        glm::ivec3
+        getModelMin(const VSChunkManager::VSBuildingData& build, const glm::ivec3& location)
+        {
+            const glm::vec2 boundsXZ = {(glm::vec3(build.buildSize) / 2.F).x,
+                                        (glm::vec3(build.buildSize) / 2.F).z};
+            return glm::ivec3(
+                glm::floor(glm::vec3(location) - glm::vec3(-boundsXZ.x, 1, -boundsXZ.y)));
+        }
+    }  // namespace
+
+    void buildStandard(VSChunkManager* chunkManager, std::uint32_t seed)
+    {
+        chunkManager->setWorldSeed(seed);
         glm::ivec3 worldSize = chunkManager->getWorldSize();
         glm::ivec3 worldSizeHalf = worldSize / 2;
-        VSHeightmap flatHM = VSHeightmap(worldSize.y / 4, 3, 0.005F, worldSize.y / 4, 2.F, 0.5F);
-        VSHeightmap mountainHM =
-            VSHeightmap(worldSize.y / 2, 2, 0.02F, worldSize.y / 2, 2.F, 0.125F);
+        glm::ivec3 chunkSize = chunkManager->getChunkSize();
+        VSHeightmap flatHM = VSHeightmap(
+            worldSize.y / 4, 3, 0.005F, worldSize.y / 4, 2.F, 0.5F, deriveSeed(seed, 0));
+        VSHeightmap mountainHM = VSHeightmap(
+            worldSize.y / 2, 2, 0.02F, worldSize.y / 2, 2.F, 0.125F, deriveSeed(seed, 1));
 
         int numBiomes = 1000;
-        VSHeightmap biomeMap = VSHeightmap(numBiomes, 1, 0.005F, 1.F, 2.F, 0.125F);
-
-        std::random_device rd;   // Will be used to obtain a seed for the random number engine
-        std::mt19937 gen(rd());  // Standard mersenne_twister_engine seeded with rd()
-        std::uniform_int_distribution<> dis(0, 1000);  // For tree map
-        std::uniform_int_distribution<> disEdge(0, 1);
+        VSHeightmap biomeMap =
+            VSHeightmap(numBiomes, 1, 0.005F, 1.F, 2.F, 0.125F, deriveSeed(seed, 2));
 
         // load tree models
+        const auto tree = createTreeBuild(4);
         const auto smallBirch =
             VSParser::readBuildFromFile("resources/trees/small_birchtree/blocks.json");
         const auto largeBirch =
@@ -39,175 +173,278 @@ namespace VSTerrainGeneration
         int waterLine = worldSize.y / 16;
         int sandLine = waterLine + 1;
 
-        for (int x = -worldSizeHalf.x; x < worldSizeHalf.x; x++)
-        {
-            for (int z = -worldSizeHalf.z; z < worldSizeHalf.z; z++)
-            {
-                int biome = biomeMap.getVoxelHeight(x, z);
-                int height = flatHM.getVoxelHeight(x, z);
-                int mountainHeight = mountainHM.getVoxelHeight(x, z) + worldSizeHalf.y;
+        // Trees reach into neighbouring chunks, they are placed once every chunk is filled
+        std::mutex treeMutex;
+        std::vector<glm::ivec3> treeLocations;
+        std::vector<glm::ivec3> smallBirchLocations;
+        std::vector<glm::ivec3> largeBirchLocations;
 
-                // interpolate
-                float weight = glm::quarticEaseIn((float)biome / numBiomes);
-                height = ((1 - weight) * height + (weight)*mountainHeight);
+        const auto generateChunk = [&](const glm::ivec3& chunkMin, std::vector<VSBlockID>& blocks) {
+            std::mt19937 gen = createChunkRandomEngine(seed, chunkMin);
 
-                int blockID = 3;
+            std::vector<glm::ivec3> chunkTreeLocations;
+            std::vector<glm::ivec3> chunkSmallBirchLocations;
+            std::vector<glm::ivec3> chunkLargeBirchLocations;
 
-                if (height > stoneLine + disEdge(gen))
-                {
-                    // Snow
-                    blockID = 9;
-                }
-                else if (height > grassLine)
-                {
-                    // Stone
-                    blockID = 1;
-                }
-                else if (height > sandLine)
-                {
-                    // Grass
-                    blockID = 3;
-                }
-                else if (height > waterLine)
-                {
-                    // Sand
-                    blockID = 5;
-                }
-                else
-                {
-                    // Water for now
-                    blockID = 2;
-                    height = waterLine;
-                }
+            const glm::ivec2 tileMin = {chunkMin.x, chunkMin.z};
+            const glm::ivec2 tileSize = {chunkSize.x, chunkSize.z};
+            std::vector<int> biomes(chunkSize.x * chunkSize.z);
+            std::vector<int> heights(biomes.size());
+            std::vector<int> mountainHeights(biomes.size());
+            biomeMap.getVoxelHeights(tileMin, tileSize, biomes.data());
+            flatHM.getVoxelHeights(tileMin, tileSize, heights.data());
+            mountainHM.getVoxelHeights(tileMin, tileSize, mountainHeights.data());
 
-                for (int y = -worldSizeHalf.y; y < height - worldSizeHalf.y; y++)
+            for (int x = chunkMin.x; x < chunkMin.x + chunkSize.x; x++)
+            {
+                for (int z = chunkMin.z; z < chunkMin.z + chunkSize.z; z++)
                 {
-                    chunkManager->setBlock({x, y, z}, blockID);
-                }
+                    const int tileIndex = (x - chunkMin.x) + (z - chunkMin.z) * chunkSize.x;
+                    int biome = biomes[tileIndex];
+                    int height = heights[tileIndex];
+                    int mountainHeight = mountainHeights[tileIndex] + worldSizeHalf.y;
 
-                int tree = dis(gen);
-                if (tree == 0)
-                {
-                    if (height < stoneLine && height > sandLine)
+                    // interpolate
+                    float weight = glm::quarticEaseIn((float)biome / numBiomes);
+                    height = ((1 - weight) * height + (weight)*mountainHeight);
+
+                    int blockID = 3;
+
+                    if (height > stoneLine + randomInt(gen, 0, 1))
                     {
-                        if (x > -worldSizeHalf.x + 1 && z > -worldSizeHalf.z + 1 &&
-                            x < worldSizeHalf.x - 3 && z < worldSizeHalf.z - 3)
+                        // Snow
+                        blockID = 9;
+                    }
+                    else if (height > grassLine)
+                    {
+                        // Stone
+                        blockID = 1;
+                    }
+                    else if (height > sandLine)
+                    {
+                        // Grass
+                        blockID = 3;
+                    }
+                    else if (height > waterLine)
+                    {
+                        // Sand
+                        blockID = 5;
+                    }
+                    else
+                    {
+                        // Water for now
+                        blockID = 2;
+                        height = waterLine;
+                    }
+
+                    fillColumn(blocks, chunkSize, x - chunkMin.x, z - chunkMin.z, height, blockID);
+
+                    int tree = randomInt(gen, 0, 1000);  // tree map
+                    if (tree == 0)
+                    {
+                        if (height < stoneLine && height > sandLine)
                         {
-                            treeAt(world, x, height - worldSizeHalf.y, z);
+                            if (x > -worldSizeHalf.x + 1 && z > -worldSizeHalf.z + 1 &&
+                                x < worldSizeHalf.x - 3 && z < worldSizeHalf.z - 3)
+                            {
+                                chunkTreeLocations.emplace_back(x, height - worldSizeHalf.y, z);
+                            }
                         }
                     }
-                }
-                else if (tree == 1)
-                {
-                    if (height < grassLine && height > sandLine)
+                    else if (tree == 1)
                     {
-                        placeModelAt(world, smallBirch, x, height - worldSizeHalf.y, z);
+                        if (height < grassLine && height > sandLine)
+                        {
+                            chunkSmallBirchLocations.emplace_back(
+                                x, height - worldSizeHalf.y, z);
+                        }
                     }
-                }
-                else if (tree == 2)
-                {
-                    if (height < grassLine && height > sandLine)
+                    else if (tree == 2)
                     {
-                        placeModelAt(world, largeBirch, x, height - worldSizeHalf.y, z);
+                        if (height < grassLine && height > sandLine)
+                        {
+                            chunkLargeBirchLocations.emplace_back(
+                                x, height - worldSizeHalf.y, z);
+                        }
                     }
                 }
             }
+
+            std::lock_guard<std::mutex> lock(treeMutex);
+            treeLocations.insert(
+                treeLocations.end(), chunkTreeLocations.begin(), chunkTreeLocations.end());
+            smallBirchLocations.insert(
+                smallBirchLocations.end(),
+                chunkSmallBirchLocations.begin(),
+                chunkSmallBirchLocations.end());
+            largeBirchLocations.insert(
+                largeBirchLocations.end(),
+                chunkLargeBirchLocations.begin(),
+                chunkLargeBirchLocations.end());
+        };
+
+        chunkManager->generateChunks(generateChunk);
+        sortLocations(treeLocations);
+        sortLocations(smallBirchLocations);
+        sortLocations(largeBirchLocations);
+
+        std::vector<VSChunkManager::VSStructure> structures;
+        for (const auto& location : treeLocations)
+        {
+            structures.push_back({getTreeMin(location), &tree});
+        }
+        for (const auto& location : smallBirchLocations)
+        {
+            structures.push_back({getModelMin(smallBirch, location), &smallBirch, true});
+        }
+        for (const auto& location : largeBirchLocations)
+        {
+            structures.push_back({getModelMin(largeBirch, location), &largeBirch, true});
         }
+        chunkManager->placeStructures(structures);
     }
 
-    void buildMountains(VSWorld* world)
+    void buildMountains(VSChunkManager* chunkManager, std::uint32_t seed)
     {
-        auto chunkManager = world->getChunkManager();
+        chunkManager->setWorldSeed(seed);
         glm::ivec3 worldSize = chunkManager->getWorldSize();
         glm::ivec3 worldSizeHalf = worldSize / 2;
-        VSHeightmap hm = VSHeightmap(worldSize.y, 4, 0.01F, worldSize.y, 1.F, 0.5F);
+        glm::ivec3 chunkSize = chunkManager->getChunkSize();
+        VSHeightmap hm =
+            VSHeightmap(worldSize.y, 4, 0.01F, worldSize.y, 1.F, 0.5F, deriveSeed(seed, 0));
 
-        std::random_device rd;   // Will be used to obtain a seed for the random number engine
-        std::mt19937 gen(rd());  // Standard mersenne_twister_engine seeded with rd()
-        std::uniform_int_distribution<> dis(0, 300);  // For tree map
+        // Trees reach into neighbouring chunks, they are placed once every chunk is filled
+        std::mutex treeMutex;
+        std::vector<glm::ivec3> treeLocations;
 
-        for (int x = -worldSizeHalf.x; x < worldSizeHalf.x; x++)
-        {
-            for (int z = -worldSizeHalf.z; z < worldSizeHalf.z; z++)
+        const auto generateChunk = [&](const glm::ivec3& chunkMin, std::vector<VSBlockID>& blocks) {
+            std::mt19937 gen = createChunkRandomEngine(seed, chunkMin);
+
+            std::vector<glm::ivec3> chunkTreeLocations;
+
+            std::vector<int> heights(chunkSize.x * chunkSize.z);
+            hm.getVoxelHeights(
+                {chunkMin.x, chunkMin.z}, {chunkSize.x, chunkSize.z}, heights.data());
+
+            for (int x = chunkMin.x; x < chunkMin.x + chunkSize.x; x++)
             {
-                int height = hm.getVoxelHeight(x, z);
-                int tree = dis(gen);
-                int blockID = 0;
-                if (height > 2 * worldSize.y / 3)
-                {
-                    // Stone
-                    blockID = 1;
-                }
-                else if (height > worldSize.y / 4)
-                {
-                    // Grass
-                    blockID = 3;
-                }
-                else if (height > worldSize.y / 5)
+                for (int z = chunkMin.z; z < chunkMin.z + chunkSize.z; z++)
                 {
-                    // Sand
-                    blockID = 5;
-                }
-                else
-                {
-                    // Water for now
-                    blockID = 2;
-                    height = worldSize.y / 5;
-                }
+                    int height = heights[(x - chunkMin.x) + (z - chunkMin.z) * chunkSize.x];
+                    int tree = randomInt(gen, 0, 300);  // tree map
+                    int blockID = 0;
+                    if (height > 2 * worldSize.y / 3)
+                    {
+                        // Stone
+                        blockID = 1;
+                    }
+                    else if (height > worldSize.y / 4)
+                    {
+                        // Grass
+                        blockID = 3;
+                    }
+                    else if (height > worldSize.y / 5)
+                    {
+                        // Sand
+                        blockID = 5;
+                    }
+                    else
+                    {
+                        // Water for now
+                        blockID = 2;
+                        height = worldSize.y / 5;
+                    }
 
-                for (int y = -worldSizeHalf.y; y < height - worldSizeHalf.y; y++)
-                {
-                    chunkManager->setBlock({x, y, z}, blockID);
-                }
-                if (tree == 0)
-                {
-                    if (height < 2 * worldSize.y / 3 && height > worldSize.y / 4)
+                    fillColumn(blocks, chunkSize, x - chunkMin.x, z - chunkMin.z, height, blockID);
+                    if (tree == 0)
                     {
-                        if (x > -worldSizeHalf.x + 1 && z > -worldSizeHalf.z + 1 &&
-                            x < worldSizeHalf.x - 3 && z < worldSizeHalf.z - 3)
+                        if (height < 2 * worldSize.y / 3 && height > worldSize.y / 4)
                         {
-                            treeAt(world, x, height - worldSizeHalf.y, z);
+                            if (x > -worldSizeHalf.x + 1 && z > -worldSizeHalf.z + 1 &&
+                                x < worldSizeHalf.x - 3 && z < worldSizeHalf.z - 3)
+                            {
+                                chunkTreeLocations.emplace_back(x, height - worldSizeHalf.y, z);
+                            }
                         }
                     }
                 }
             }
+
+            std::lock_guard<std::mutex> lock(treeMutex);
+            treeLocations.insert(
+                treeLocations.end(), chunkTreeLocations.begin(), chunkTreeLocations.end());
+        };
+
+        chunkManager->generateChunks(generateChunk);
+        sortLocations(treeLocations);
+
+        const auto tree = createTreeBuild(4);
+        std::vector<VSChunkManager::VSStructure> structures;
+        for (const auto& location : treeLocations)
+        {
+            structures.push_back({getTreeMin(location), &tree});
         }
+        chunkManager->placeStructures(structures);
     }
 
-    void buildDesert(VSWorld* world)
+    void buildDesert(VSChunkManager* chunkManager, std::uint32_t seed)
     {
-        auto chunkManager = world->getChunkManager();
+        chunkManager->setWorldSeed(seed);
         glm::ivec3 worldSize = chunkManager->getWorldSize();
         glm::ivec3 worldSizeHalf = worldSize / 2;
-        VSHeightmap desert = VSHeightmap(worldSize.y / 10, 2, 0.02F, 10.F, 0.5F, 2.F);
+        glm::ivec3 chunkSize = chunkManager->getChunkSize();
+        VSHeightmap desert =
+            VSHeightmap(worldSize.y / 10, 2, 0.02F, 10.F, 0.5F, 2.F, deriveSeed(seed, 0));
 
-        std::random_device rd;   // Will be used to obtain a seed for the random number engine
-        std::mt19937 gen(rd());  // Standard mersenne_twister_engine seeded with rd()
-        std::uniform_int_distribution<> dis(0, 3000);  // For cactus map
+        // Cacti reach into neighbouring chunks, they are placed once every chunk is filled
+        std::mutex cactusMutex;
+        std::vector<glm::ivec3> cactusLocations;
 
-        for (int x = -worldSizeHalf.x; x < worldSizeHalf.x; x++)
-        {
-            for (int z = -worldSizeHalf.z; z < worldSizeHalf.z; z++)
-            {
-                int height = desert.getVoxelHeight(x, z);
+        const auto generateChunk = [&](const glm::ivec3& chunkMin, std::vector<VSBlockID>& blocks) {
+            std::mt19937 gen = createChunkRandomEngine(seed, chunkMin);
 
-                int tree = dis(gen);  // treeMap.getVoxelHeight(x, z);
-                int blockID = 5;      // sand
+            std::vector<glm::ivec3> chunkCactusLocations;
 
-                for (int y = -worldSizeHalf.y; y < height - worldSizeHalf.y; y++)
-                {
-                    chunkManager->setBlock({x, y, z}, blockID);
-                }
-                if (tree == 0)
+            std::vector<int> heights(chunkSize.x * chunkSize.z);
+            desert.getVoxelHeights(
+                {chunkMin.x, chunkMin.z}, {chunkSize.x, chunkSize.z}, heights.data());
+
+            for (int x = chunkMin.x; x < chunkMin.x + chunkSize.x; x++)
+            {
+                for (int z = chunkMin.z; z < chunkMin.z + chunkSize.z; z++)
                 {
-                    if (x > -worldSizeHalf.x + 1 && z > -worldSizeHalf.z + 1 &&
-                        x < worldSizeHalf.x - 3 && z < worldSizeHalf.z - 3)
+                    int height = heights[(x - chunkMin.x) + (z - chunkMin.z) * chunkSize.x];
+
+                    int tree = randomInt(gen, 0, 3000);  // cactus map
+                    int blockID = 5;                     // sand
+
+                    fillColumn(blocks, chunkSize, x - chunkMin.x, z - chunkMin.z, height, blockID);
+                    if (tree == 0)
                     {
-                        cactusAt(world, x, height - worldSizeHalf.y, z);
+                        if (x > -worldSizeHalf.x + 1 && z > -worldSizeHalf.z + 1 &&
+                            x < worldSizeHalf.x - 3 && z < worldSizeHalf.z - 3)
+                        {
+                            chunkCactusLocations.emplace_back(x, height - worldSizeHalf.y, z);
+                        }
                     }
                 }
             }
+
+            std::lock_guard<std::mutex> lock(cactusMutex);
+            cactusLocations.insert(
+                cactusLocations.end(), chunkCactusLocations.begin(), chunkCactusLocations.end());
+        };
+
+        chunkManager->generateChunks(generateChunk);
+        sortLocations(cactusLocations);
+
+        const auto cactus = createCactusBuild();
+        std::vector<VSChunkManager::VSStructure> structures;
+        for (const auto& location : cactusLocations)
+        {
+            structures.push_back({getCactusMin(location), &cactus});
         }
+        chunkManager->placeStructures(structures);
     }
 
     void buildEditorPlane(VSWorld* world)
@@ -216,92 +453,32 @@ namespace VSTerrainGeneration
         glm::ivec3 worldSize = chunkManager->getWorldSize();
         glm::ivec3 worldSizeHalf = worldSize / 2;
 
-        for (int x = -worldSizeHalf.x; x < worldSizeHalf.x; x++)
-        {
-            for (int z = -worldSizeHalf.z; z < worldSizeHalf.z; z++)
-            {
-                chunkManager->setBlock({x, 0, z}, 1);
-            }
-        }
+        chunkManager->fillBlocks(
+            {-worldSizeHalf.x, 0, -worldSizeHalf.z}, {worldSizeHalf.x, 1, worldSizeHalf.z}, 1);
     }
 
     void placeModelAt(VSWorld* world, VSChunkManager::VSBuildingData build, int i, int j, int k)
     {
-        auto chunkManager = world->getChunkManager();
-
-        const glm::vec2 boundsXZ = {(glm::vec3(build.buildSize) / 2.F).x,
-                                    (glm::vec3(build.buildSize) / 2.F).z};
-
-        for (int x = 0; x < build.buildSize.x; x++)
-        {
-            for (int y = 0; y < build.buildSize.y; y++)
-            {
-                for (int z = 0; z < build.buildSize.z; z++)
-                {
-                    const auto currentBlockWorldLocation = glm::vec3{x, y, z} + glm::vec3{i, j, k} -
-                                          glm::vec3(-boundsXZ.x, 1, -boundsXZ.y);
-                    if (chunkManager->isLocationInBounds(currentBlockWorldLocation))
-                    {
-                        chunkManager->setBlock(currentBlockWorldLocation,
-                            build.blocks
-                                [x + y * build.buildSize.x +
-                                 z * build.buildSize.x * build.buildSize.y]);
-                    }
-                }
-            }
-        }
+        // Parts outside of the world are clipped
+        world->getChunkManager()->setBlocks(
+            getModelMin(build, {i, j, k}), build.buildSize, build.blocks.data());
     }
 
     void treeAt(VSWorld* world, int x, int y, int z)
     {
-        auto chunkManager = world->getChunkManager();
-        chunkManager->setBlock({x, y, z}, 4);
-        chunkManager->setBlock({x, y + 1, z}, 4);
-        chunkManager->setBlock({x, y + 2, z}, 4);
-        chunkManager->setBlock({x, y + 3, z}, 4);
-        chunkManager->setBlock({x + 1, y + 3, z}, 6);
-        chunkManager->setBlock({x - 1, y + 3, z}, 6);
-        chunkManager->setBlock({x, y + 3, z + 1}, 6);
-        chunkManager->setBlock({x, y + 3, z - 1}, 6);
-        chunkManager->setBlock({x + 1, y + 3, z + 1}, 6);
-        chunkManager->setBlock({x - 1, y + 3, z - 1}, 6);
-        chunkManager->setBlock({x + 1, y + 3, z - 1}, 6);
-        chunkManager->setBlock({x - 1, y + 3, z + 1}, 6);
-        chunkManager->setBlock({x, y + 4, z}, 6);
+        static const auto tree = createTreeBuild(4);
+        world->getChunkManager()->placeStructures({{getTreeMin({x, y, z}), &tree}});
     }
 
     void birchtreeAt(VSWorld* world, int x, int y, int z)
     {
-        auto chunkManager = world->getChunkManager();
-        chunkManager->setBlock({x, y, z}, 22);
-        chunkManager->setBlock({x, y + 1, z}, 22);
-        chunkManager->setBlock({x, y + 2, z}, 22);
-        chunkManager->setBlock({x, y + 3, z}, 22);
-        chunkManager->setBlock({x + 1, y + 3, z}, 6);
-        chunkManager->setBlock({x - 1, y + 3, z}, 6);
-        chunkManager->setBlock({x, y + 3, z + 1}, 6);
-        chunkManager->setBlock({x, y + 3, z - 1}, 6);
-        chunkManager->setBlock({x + 1, y + 3, z + 1}, 6);
-        chunkManager->setBlock({x - 1, y + 3, z - 1}, 6);
-        chunkManager->setBlock({x + 1, y + 3, z - 1}, 6);
-        chunkManager->setBlock({x - 1, y + 3, z + 1}, 6);
-        chunkManager->setBlock({x, y + 4, z}, 6);
+        static const auto birchTree = createTreeBuild(22);
+        world->getChunkManager()->placeStructures({{getTreeMin({x, y, z}), &birchTree}});
     }
 
     void cactusAt(VSWorld* world, int x, int y, int z)
     {
-        auto chunkManager = world->getChunkManager();
-        chunkManager->setBlock({x, y, z}, 8);
-        chunkManager->setBlock({x, y + 1, z}, 8);
-        chunkManager->setBlock({x, y + 2, z}, 8);
-        chunkManager->setBlock({x, y + 3, z}, 8);
-        chunkManager->setBlock({x, y + 4, z}, 8);
-        chunkManager->setBlock({x, y + 5, z}, 8);
-        chunkManager->setBlock({x, y + 1, z + 1}, 8);
-        chunkManager->setBlock({x, y + 1, z + 2}, 8);
-        chunkManager->setBlock({x, y + 2, z + 2}, 8);
-        chunkManager->setBlock({x, y + 2, z - 1}, 8);
-        chunkManager->setBlock({x, y + 2, z - 2}, 8);
-        chunkManager->setBlock({x, y + 3, z - 2}, 8);
+        static const auto cactus = createCactusBuild();
+        world->getChunkManager()->placeStructures({{getCactusMin({x, y, z}), &cactus}});
     }
 }  // namespace VSTerrainGeneration
\ No newline at end of file
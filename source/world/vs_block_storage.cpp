@@ -0,0 +1,299 @@
+#include "world/vs_block_storage.h"
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+void VSBlockStorage::resize(std::size_t newSize, VSBlockID blockID)
+{
+    std::unique_lock lock(mutex);
+
+    blockCount = newSize;
+    bitsPerEntry = 0;
+    words.assign(wordCountFor(blockCount, bitsPerEntry), 0);
+
+    palette = {blockID};
+    paletteRefCounts = {static_cast<std::uint32_t>(blockCount)};
+    paletteLookup.fill(invalidPaletteIndex);
+    paletteLookup[blockID] = 0;
+    usedPaletteEntries = 1;
+}
+
+VSBlockStorage::VSReadLock::VSReadLock(const VSBlockStorage& inStorage)
+    : storage(inStorage)
+    , lock(inStorage.mutex)
+{
+}
+
+VSBlockID VSBlockStorage::VSReadLock::get(std::size_t index) const
+{
+    return storage.getUnlocked(index);
+}
+
+VSBlockID VSBlockStorage::get(std::size_t index) const
+{
+    std::shared_lock lock(mutex);
+    return getUnlocked(index);
+}
+
+VSBlockID VSBlockStorage::getUnlocked(std::size_t index) const
+{
+    assert(index < blockCount);
+    return palette[readEntry(words, bitsPerEntry, index)];
+}
+
+VSBlockID VSBlockStorage::set(std::size_t index, VSBlockID blockID)
+{
+    std::unique_lock lock(mutex);
+    return setUnlocked(index, blockID);
+}
+
+void VSBlockStorage::setRange(
+    std::size_t index,
+    std::size_t count,
+    const VSBlockID* blockIDs,
+    VSBlockID* outPreviousBlockIDs)
+{
+    std::unique_lock lock(mutex);
+    assert(index + count <= blockCount);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        outPreviousBlockIDs[i] = setUnlocked(index + i, blockIDs[i]);
+    }
+}
+
+VSBlockID VSBlockStorage::setUnlocked(std::size_t index, VSBlockID blockID)
+{
+    assert(index < blockCount);
+
+    const auto previousPaletteIndex = readEntry(words, bitsPerEntry, index);
+    const auto previousBlockID = palette[previousPaletteIndex];
+    if (previousBlockID == blockID)
+    {
+        return previousBlockID;
+    }
+
+    paletteRefCounts[previousPaletteIndex]--;
+    if (paletteRefCounts[previousPaletteIndex] == 0)
+    {
+        usedPaletteEntries--;
+    }
+
+    const auto paletteIndex = getOrAddPaletteIndex(blockID);
+    if (paletteRefCounts[paletteIndex] == 0)
+    {
+        usedPaletteEntries++;
+    }
+    paletteRefCounts[paletteIndex]++;
+
+    writeEntry(words, bitsPerEntry, index, paletteIndex);
+    return previousBlockID;
+}
+
+void VSBlockStorage::assign(const VSBlockID* blockIDs, std::size_t count)
+{
+    std::unique_lock lock(mutex);
+
+    blockCount = count;
+    palette.clear();
+    paletteRefCounts.clear();
+    paletteLookup.fill(invalidPaletteIndex);
+
+    for (std::size_t i = 0; i < blockCount; i++)
+    {
+        const auto blockID = blockIDs[i];
+        if (paletteLookup[blockID] == invalidPaletteIndex)
+        {
+            paletteLookup[blockID] = static_cast<std::int16_t>(palette.size());
+            palette.push_back(blockID);
+            paletteRefCounts.push_back(0);
+        }
+        paletteRefCounts[paletteLookup[blockID]]++;
+    }
+
+    if (palette.empty())
+    {
+        palette = {VS_DEFAULT_BLOCK_ID};
+        paletteRefCounts = {0};
+        paletteLookup[VS_DEFAULT_BLOCK_ID] = 0;
+    }
+    usedPaletteEntries = palette.size();
+
+    bitsPerEntry = bitsForPaletteSize(palette.size());
+    words.assign(wordCountFor(blockCount, bitsPerEntry), 0);
+
+    for (std::size_t i = 0; i < blockCount; i++)
+    {
+        writeEntry(words, bitsPerEntry, i, paletteLookup[blockIDs[i]]);
+    }
+}
+
+void VSBlockStorage::copyTo(VSBlockID* outBlockIDs) const
+{
+    std::shared_lock lock(mutex);
+
+    for (std::size_t i = 0; i < blockCount; i++)
+    {
+        outBlockIDs[i] = palette[readEntry(words, bitsPerEntry, i)];
+    }
+}
+
+std::size_t VSBlockStorage::size() const
+{
+    std::shared_lock lock(mutex);
+    return blockCount;
+}
+
+std::uint8_t VSBlockStorage::getBitsPerEntry() const
+{
+    std::shared_lock lock(mutex);
+    return bitsPerEntry;
+}
+
+std::size_t VSBlockStorage::getPaletteSize() const
+{
+    std::shared_lock lock(mutex);
+    return usedPaletteEntries;
+}
+
+bool VSBlockStorage::isUniform() const
+{
+    std::shared_lock lock(mutex);
+    return usedPaletteEntries == 1;
+}
+
+VSBlockID VSBlockStorage::getUniformBlockID() const
+{
+    std::shared_lock lock(mutex);
+    for (std::size_t i = 0; i < palette.size(); i++)
+    {
+        if (paletteRefCounts[i] == blockCount)
+        {
+            return palette[i];
+        }
+    }
+    return VS_DEFAULT_BLOCK_ID;
+}
+
+bool VSBlockStorage::isFilledWith(VSBlockID blockID) const
+{
+    std::shared_lock lock(mutex);
+    const auto paletteIndex = paletteLookup[blockID];
+    return paletteIndex != invalidPaletteIndex && paletteRefCounts[paletteIndex] == blockCount;
+}
+
+std::size_t VSBlockStorage::getByteSize() const
+{
+    std::shared_lock lock(mutex);
+    return words.size() * sizeof(VSWord) + palette.size() * sizeof(VSBlockID) +
+           paletteRefCounts.size() * sizeof(std::uint32_t) + sizeof(paletteLookup);
+}
+
+std::uint8_t VSBlockStorage::bitsForPaletteSize(std::size_t paletteSize)
+{
+    if (paletteSize <= 1)
+    {
+        return 0;
+    }
+    if (paletteSize <= 2)
+    {
+        return 1;
+    }
+    if (paletteSize <= 4)
+    {
+        return 2;
+    }
+    if (paletteSize <= 16)
+    {
+        return 4;
+    }
+    return 8;
+}
+
+std::size_t VSBlockStorage::wordCountFor(std::size_t count, std::uint8_t bits)
+{
+    if (bits == 0)
+    {
+        return 0;
+    }
+    const std::size_t entriesPerWord = (sizeof(VSWord) * 8) / bits;
+    return (count + entriesPerWord - 1) / entriesPerWord;
+}
+
+std::uint32_t
+VSBlockStorage::readEntry(const std::vector<VSWord>& data, std::uint8_t bits, std::size_t index)
+{
+    if (bits == 0)
+    {
+        return 0;
+    }
+    // bits is always a power of two <= 8, so entries never straddle a word boundary
+    const std::size_t entriesPerWord = (sizeof(VSWord) * 8) / bits;
+    const auto word = data[index / entriesPerWord];
+    const auto shift = (index % entriesPerWord) * bits;
+    const auto mask = (VSWord(1) << bits) - 1;
+    return static_cast<std::uint32_t>((word >> shift) & mask);
+}
+
+void VSBlockStorage::writeEntry(
+    std::vector<VSWord>& data,
+    std::uint8_t bits,
+    std::size_t index,
+    std::uint32_t value)
+{
+    if (bits == 0)
+    {
+        return;
+    }
+    const std::size_t entriesPerWord = (sizeof(VSWord) * 8) / bits;
+    auto& word = data[index / entriesPerWord];
+    const auto shift = (index % entriesPerWord) * bits;
+    const auto mask = (VSWord(1) << bits) - 1;
+    word = (word & ~(mask << shift)) | ((VSWord(value) & mask) << shift);
+}
+
+std::uint32_t VSBlockStorage::getOrAddPaletteIndex(VSBlockID blockID)
+{
+    if (paletteLookup[blockID] != invalidPaletteIndex)
+    {
+        return paletteLookup[blockID];
+    }
+
+    // Reuse the slot of an id that is no longer referenced
+    const auto unusedSlot = std::find(paletteRefCounts.begin(), paletteRefCounts.end(), 0U);
+    if (unusedSlot != paletteRefCounts.end())
+    {
+        const auto paletteIndex = std::distance(paletteRefCounts.begin(), unusedSlot);
+        paletteLookup[palette[paletteIndex]] = invalidPaletteIndex;
+        palette[paletteIndex] = blockID;
+        paletteLookup[blockID] = static_cast<std::int16_t>(paletteIndex);
+        return paletteIndex;
+    }
+
+    const auto paletteIndex = palette.size();
+    palette.push_back(blockID);
+    paletteRefCounts.push_back(0);
+    paletteLookup[blockID] = static_cast<std::int16_t>(paletteIndex);
+
+    const auto requiredBits = bitsForPaletteSize(palette.size());
+    if (requiredBits > bitsPerEntry)
+    {
+        repack(requiredBits);
+    }
+
+    return paletteIndex;
+}
+
+void VSBlockStorage::repack(std::uint8_t newBitsPerEntry)
+{
+    std::vector<VSWord> newWords(wordCountFor(blockCount, newBitsPerEntry), 0);
+
+    for (std::size_t i = 0; i < blockCount; i++)
+    {
+        writeEntry(newWords, newBitsPerEntry, i, readEntry(words, bitsPerEntry, i));
+    }
+
+    words = std::move(newWords);
+    bitsPerEntry = newBitsPerEntry;
+}
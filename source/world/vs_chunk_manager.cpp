@@ -9,8 +9,11 @@
 #include <glm/geometric.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <iostream>
+#include <limits>
 #include <numeric>
+#include <random>
 #include <array>
+#include <cassert>
 #include <glm/gtx/norm.hpp>
 #include <vector>
 #include <functional>
@@ -24,6 +27,7 @@
 #include "core/vs_camera.h"
 #include "core/vs_app.h"
 #include "core/vs_debug_draw.h"
+#include "core/vs_thread_pool.h"
 
 #include "ui/vs_ui.h"
 #include "ui/vs_ui_state.h"
@@ -38,223 +42,439 @@ enum VSCubeFace : std::uint8_t
     Back = 4
 };
 
-VSChunkManager::VSChunkManager()
+// Index of the lowest set bit, value must not be 0
+static int countTrailingZeros(std::uint64_t value)
+{
+    // De Bruijn multiplication, portable replacement for __builtin_ctzll / _BitScanForward64
+    constexpr std::array<int, 64> deBruijnIndex = {
+        0,  1,  48, 2,  57, 49, 28, 3,  61, 58, 50, 42, 38, 29, 17, 4,  62, 55, 59, 36, 53, 51,
+        43, 22, 45, 39, 33, 30, 24, 18, 12, 5,  63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21,
+        44, 32, 23, 11, 46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9,  13, 8,  7,  6};
+    constexpr std::uint64_t deBruijnSequence = 0x03F79D71B4CB0A89ULL;
+    return deBruijnIndex[((value & (~value + 1)) * deBruijnSequence) >> 58];
+}
+
+// Block light spreads to these neighbours
+const std::array<glm::ivec3, 6> blockLightNeighbourOffsets = {
+    glm::ivec3(1, 0, 0),
+    glm::ivec3(-1, 0, 0),
+    glm::ivec3(0, 1, 0),
+    glm::ivec3(0, -1, 0),
+    glm::ivec3(0, 0, 1),
+    glm::ivec3(0, 0, -1)};
+
+// Corners of the faces in the order getLightInformation returns them. A corner is lit by the four
+// blocks in front of the face around it, at corner + each of the corners of the same face.
+const std::array<std::array<glm::vec3, 4>, 6> lightInformationCorners = {
+    // Right
+    std::array<glm::vec3, 4>{
+        glm::vec3{0.5F, -0.5F, -0.5F},
+        glm::vec3{0.5F, 0.5F, -0.5F},
+        glm::vec3{0.5F, -0.5F, 0.5F},
+        glm::vec3{0.5F, 0.5F, 0.5F}},
+    // Left
+    std::array<glm::vec3, 4>{
+        glm::vec3{-0.5F, -0.5F, -0.5F},
+        glm::vec3{-0.5F, 0.5F, -0.5F},
+        glm::vec3{-0.5F, -0.5F, 0.5F},
+        glm::vec3{-0.5F, 0.5F, 0.5F}},
+    // Top
+    std::array<glm::vec3, 4>{
+        glm::vec3{-0.5F, 0.5F, -0.5F},
+        glm::vec3{0.5F, 0.5F, -0.5F},
+        glm::vec3{-0.5F, 0.5F, 0.5F},
+        glm::vec3{0.5F, 0.5F, 0.5F}},
+    // Bottom
+    std::array<glm::vec3, 4>{
+        glm::vec3{-0.5F, -0.5F, -0.5F},
+        glm::vec3{0.5F, -0.5F, -0.5F},
+        glm::vec3{-0.5F, -0.5F, 0.5F},
+        glm::vec3{0.5F, -0.5F, 0.5F}},
+    // Front
+    std::array<glm::vec3, 4>{
+        glm::vec3{-0.5F, -0.5F, 0.5F},
+        glm::vec3{0.5F, -0.5F, 0.5F},
+        glm::vec3{-0.5F, 0.5F, 0.5F},
+        glm::vec3{0.5F, 0.5F, 0.5F}},
+    // Back
+    std::array<glm::vec3, 4>{
+        glm::vec3{-0.5F, -0.5F, -0.5F},
+        glm::vec3{0.5F, -0.5F, -0.5F},
+        glm::vec3{-0.5F, 0.5F, -0.5F},
+        glm::vec3{0.5F, 0.5F, -0.5F}}};
+
+// Faces in the order getLightInformation returns them
+constexpr std::array<VSCubeFace, 6> lightInformationFaces = {
+    VSCubeFace::Right,
+    VSCubeFace::Left,
+    VSCubeFace::Top,
+    VSCubeFace::Bottom,
+    VSCubeFace::Front,
+    VSCubeFace::Back};
+
+VSChunkManager::VSChunkManager(bool bShouldCreateRenderResources)
 {
     spriteTextureID = 0;
     shadowTextureID = 1;
 
-    for (std::size_t i = 1; i < 64; i++)
+    bHasRenderResources = bShouldCreateRenderResources;
+    if (!bHasRenderResources)
     {
-        auto* vertexContext =
-            loadVertexContext("resources/models/cubes/" + std::to_string(i) + ".obj");
-        vertexContexts[i] = vertexContext;
+        return;
+    }
 
-        glBindVertexArray(vertexContext->vertexArrayObject);
+    chunkShader = std::make_unique<VSShader>("Chunk");
+    greedyChunkShader = std::make_unique<VSShader>("ChunkGreedy", "Chunk");
 
-        auto nextAttribPointer = vertexContext->lastAttribPointer + 1;
-        glGenBuffers(1, &visibleBlockInfoBuffers[i]);
-        glBindBuffer(GL_ARRAY_BUFFER, visibleBlockInfoBuffers[i]);
+    // All face combinations share one vertex and index buffer, every combination's cube starts
+    // at its own first index and base vertex
+    std::vector<VSVertexData> cubeVertexData;
+    std::vector<GLuint> cubeTriangleIndices;
+    for (std::size_t i = 1; i < faceCombinationCount; i++)
+    {
+        auto& cubeMesh = cubeMeshes[i];
+        cubeMesh.firstIndex = static_cast<GLuint>(cubeTriangleIndices.size());
+        cubeMesh.baseVertex = static_cast<GLint>(cubeVertexData.size());
+        appendMeshData(
+            "resources/models/cubes/" + std::to_string(i) + ".obj",
+            cubeVertexData,
+            cubeTriangleIndices);
+        cubeMesh.indexCount =
+            static_cast<GLsizei>(cubeTriangleIndices.size() - cubeMesh.firstIndex);
+        cubeMesh.vertexCount = static_cast<GLsizei>(cubeVertexData.size() - cubeMesh.baseVertex);
+    }
+    cubeVertexContext = std::make_unique<VSVertexContext>(cubeVertexData, cubeTriangleIndices);
+    visibleBlockInfoBuffer =
+        std::make_unique<VSInstanceBuffer>(sizeof(VSChunk::VSVisibleBlockInfo));
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribPointer(
-            nextAttribPointer,
-            3,
-            GL_FLOAT,
-            GL_FALSE,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, locationWorldSpace));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+    glBindVertexArray(cubeVertexContext->vertexArrayObject);
 
-        nextAttribPointer++;
+    // All four packed words as one uvec4, see VSVisibleBlockInfo.
+    // The pointer itself is set in draw since the buffer changes when it grows.
+    const auto instanceAttribPointer = cubeVertexContext->lastAttribPointer + 1;
+    glEnableVertexAttribArray(instanceAttribPointer);
+    glVertexAttribDivisor(instanceAttribPointer, 1);
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribIPointer(
-            nextAttribPointer,
-            1,
-            GL_UNSIGNED_BYTE,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, id));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+    int maxAttribs = 256;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+    assert(instanceAttribPointer < maxAttribs);
 
-        nextAttribPointer++;
+    glBindVertexArray(0);
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribIPointer(
-            nextAttribPointer,
-            1,
-            GL_UNSIGNED_INT,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, lightRight));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+    glGenBuffers(1, &drawCommandBuffer);
 
-        nextAttribPointer++;
+    spriteTexture = TextureAtlasFromFile("resources/textures/tiles");
+}
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribIPointer(
-            nextAttribPointer,
-            1,
-            GL_UNSIGNED_INT,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, lightLeft));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+VSChunkManager::~VSChunkManager()
+{
+    cancelChunkUpdates();
+    for (auto* chunk : chunks)
+    {
+        deleteChunk(chunk);
+    }
+}
 
-        nextAttribPointer++;
+VSBlockID VSChunkManager::getBlock(const glm::vec3& location) const
+{
+    const auto zeroBaseLocation = glm::ivec3(glm::floor(location)) + worldSizeHalf;
+    const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(zeroBaseLocation);
+    return getChunkBlock(chunks[chunkIndex], blockIndex);
+}
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribIPointer(
-            nextAttribPointer,
-            1,
-            GL_UNSIGNED_INT,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, lightTop));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+void VSChunkManager::setBlock(const glm::vec3& location, VSBlockID blockID)
+{
+    assert(!bShouldReinitializeChunks);
+    const auto locationFloored = glm::ivec3(glm::floor(location));
+    const auto zeroBaseLocation = locationFloored + worldSizeHalf;
+    const auto [chunkCoordinates, blockIndex] =
+        worldCoordinatesToChunkCoordinatesAndBlockIndex(zeroBaseLocation);
 
-        nextAttribPointer++;
+    const auto chunkIndex = chunkCoordinatesToChunkIndex(chunkCoordinates);
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribIPointer(
-            nextAttribPointer,
-            1,
-            GL_UNSIGNED_INT,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, lightBottom));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+    // The replaced id comes from the write itself, so concurrent edits never count a block twice
+    const auto currentBlockID = setChunkBlock(chunks[chunkIndex], blockIndex, blockID);
+    onBlockChanged(chunkIndex, blockIndex, zeroBaseLocation, currentBlockID, blockID);
 
-        nextAttribPointer++;
+    markChangedBlocksDirty(zeroBaseLocation, zeroBaseLocation);
+}
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribIPointer(
-            nextAttribPointer,
-            1,
-            GL_UNSIGNED_INT,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, lightFront));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+void VSChunkManager::fillBlocks(
+    const glm::ivec3& boxMin,
+    const glm::ivec3& boxMax,
+    VSBlockID blockID)
+{
+    const auto boxSize = boxMax - boxMin;
+    if (glm::any(glm::lessThanEqual(boxSize, glm::ivec3(0))))
+    {
+        return;
+    }
 
-        nextAttribPointer++;
+    const std::vector<VSBlockID> row(boxSize.x, blockID);
+    writeBlocks({boxMin + worldSizeHalf, boxSize, row.data(), 0, 0, true});
+}
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribIPointer(
-            nextAttribPointer,
-            1,
-            GL_UNSIGNED_INT,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, lightBack));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+void VSChunkManager::setBlocks(
+    const glm::ivec3& boxMin,
+    const glm::ivec3& boxSize,
+    const VSBlockID* blockIDs)
+{
+    if (glm::any(glm::lessThanEqual(boxSize, glm::ivec3(0))))
+    {
+        return;
+    }
 
-        nextAttribPointer++;
+    writeBlocks(
+        {boxMin + worldSizeHalf,
+         boxSize,
+         blockIDs,
+         static_cast<std::size_t>(boxSize.x),
+         static_cast<std::size_t>(boxSize.x) * boxSize.y,
+         true});
+}
 
-        glEnableVertexAttribArray(nextAttribPointer);
-        glVertexAttribPointer(
-            nextAttribPointer,
-            3,
-            GL_FLOAT,
-            GL_FALSE,
-            sizeof(VSChunk::VSVisibleBlockInfo),
-            (void*)offsetof(VSChunk::VSVisibleBlockInfo, lightColor));
-        glVertexAttribDivisor(nextAttribPointer, 1);
+void VSChunkManager::placeStructures(const std::vector<VSStructure>& structures)
+{
+    assert(!bShouldReinitializeChunks);
 
-        int maxAttribs = 256;
-        glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
-        assert(nextAttribPointer < maxAttribs);
+    // Every chunk gets the structures overlapping it, in list order
+    std::vector<std::vector<std::size_t>> chunkStructures(chunks.size());
+    for (std::size_t structureIndex = 0; structureIndex < structures.size(); structureIndex++)
+    {
+        const auto& structure = structures[structureIndex];
+        const auto zeroBaseMin = structure.location + worldSizeHalf;
+        const auto regionMin = glm::max(zeroBaseMin, glm::ivec3(0));
+        const auto regionMax = glm::min(zeroBaseMin + structure.build->buildSize, worldSize);
+        if (glm::any(glm::lessThanEqual(regionMax, regionMin)))
+        {
+            continue;
+        }
 
-        glBindVertexArray(0);
+        for (int chunkZ = regionMin.z / chunkSize.z; chunkZ <= (regionMax.z - 1) / chunkSize.z;
+             chunkZ++)
+        {
+            for (int chunkX = regionMin.x / chunkSize.x;
+                 chunkX <= (regionMax.x - 1) / chunkSize.x;
+                 chunkX++)
+            {
+                chunkStructures[chunkCoordinatesToChunkIndex({chunkX, chunkZ})].push_back(
+                    structureIndex);
+            }
+        }
     }
 
-    spriteTexture = TextureAtlasFromFile("resources/textures/tiles");
+    std::vector<std::size_t> chunkIndices;
+    for (std::size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+    {
+        if (!chunkStructures[chunkIndex].empty())
+        {
+            chunkIndices.push_back(chunkIndex);
+        }
+    }
+
+    // A task only writes its own chunk, parts reaching into neighbours are clipped and written
+    // by the neighbour's task
+    VSApp::getInstance()->getThreadPool()->parallelFor(
+        chunkIndices.size(),
+        [this, &structures, &chunkStructures, &chunkIndices](std::size_t task) {
+            const auto chunkIndex = chunkIndices[task];
+            for (const auto structureIndex : chunkStructures[chunkIndex])
+            {
+                const auto& structure = structures[structureIndex];
+                const auto& buildSize = structure.build->buildSize;
+                writeChunkBlocks(
+                    chunkIndex,
+                    {structure.location + worldSizeHalf,
+                     buildSize,
+                     structure.build->blocks.data(),
+                     static_cast<std::size_t>(buildSize.x),
+                     static_cast<std::size_t>(buildSize.x) * buildSize.y,
+                     structure.bShouldPlaceAir});
+            }
+        });
 }
 
-VSBlockID VSChunkManager::getBlock(const glm::vec3& location) const
+void VSChunkManager::writeBlocks(const VSBlockBox& box)
 {
-    const auto zeroBaseLocation = glm::ivec3(glm::floor(location)) + worldSizeHalf;
-    const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(zeroBaseLocation);
-    return chunks[chunkIndex]->blocks[blockIndex];
+    const auto regionMin = glm::max(box.zeroBaseMin, glm::ivec3(0));
+    const auto regionMax = glm::min(box.zeroBaseMin + box.size, worldSize);
+    if (glm::any(glm::lessThanEqual(regionMax, regionMin)))
+    {
+        return;
+    }
+
+    for (int chunkZ = regionMin.z / chunkSize.z; chunkZ <= (regionMax.z - 1) / chunkSize.z;
+         chunkZ++)
+    {
+        for (int chunkX = regionMin.x / chunkSize.x; chunkX <= (regionMax.x - 1) / chunkSize.x;
+             chunkX++)
+        {
+            writeChunkBlocks(chunkCoordinatesToChunkIndex({chunkX, chunkZ}), box);
+        }
+    }
 }
 
-void VSChunkManager::setBlock(const glm::vec3& location, VSBlockID blockID)
+void VSChunkManager::writeChunkBlocks(std::size_t chunkIndex, const VSBlockBox& box)
 {
     assert(!bShouldReinitializeChunks);
-    const auto locationFloored = glm::ivec3(glm::floor(location));
-    const auto zeroBaseLocation = locationFloored + worldSizeHalf;
-    const auto [chunkCoordinates, blockIndex] =
-        worldCoordinatesToChunkCoordinatesAndBlockIndex(zeroBaseLocation);
 
-    const auto chunkIndex = chunkCoordinatesToChunkIndex(chunkCoordinates);
+    auto* chunk = chunks[chunkIndex];
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    const glm::ivec3 chunkOrigin(
+        chunkCoordinates.x * chunkSize.x, 0, chunkCoordinates.y * chunkSize.z);
+    const auto chunkRegionMin = glm::max(box.zeroBaseMin - chunkOrigin, glm::ivec3(0));
+    const auto chunkRegionMax = glm::min(box.zeroBaseMin + box.size - chunkOrigin, chunkSize);
+    if (glm::any(glm::lessThanEqual(chunkRegionMax, chunkRegionMin)))
+    {
+        return;
+    }
 
-    VSBlockID currentBlockID = getBlock(location);
+    std::vector<VSBlockID> previousRun(chunkRegionMax.x - chunkRegionMin.x);
+    bool bHasChanged = false;
+    // Bounds of the changed blocks in chunk coordinates, inclusive
+    glm::ivec3 changedMin = chunkRegionMax;
+    glm::ivec3 changedMax = chunkRegionMin;
 
-    // If new block has emssion or removed block had emission
-    if (blockEmission[blockID] != 0.F ||
-        blockEmission[chunks[chunkIndex]->blocks[blockIndex]] != 0.F)
+    for (int z = chunkRegionMin.z; z < chunkRegionMax.z; z++)
     {
-        const auto emission = blockEmission[blockID] != 0
-                                  ? blockEmission[blockID]
-                                  : blockEmission[chunks[chunkIndex]->blocks[blockIndex]];
-        // add emission or remove emission
-        const float addOrRemove = blockEmission[blockID] != 0.F ? 1 : -1;
-        const int ceiledEmission = glm::ceil(emission);
-
-        for (int x = locationFloored.x - ceiledEmission; x <= locationFloored.x + ceiledEmission;
-             x++)
+        // y ascending, so updateColumnHeight only ever searches through written blocks
+        for (int y = chunkRegionMin.y; y < chunkRegionMax.y; y++)
         {
-            for (int y = locationFloored.y - ceiledEmission;
-                 y <= locationFloored.y + ceiledEmission;
-                 y++)
+            const auto boxLocation =
+                chunkOrigin + glm::ivec3(chunkRegionMin.x, y, z) - box.zeroBaseMin;
+            const auto* row =
+                box.blockIDs + boxLocation.x + boxLocation.y * box.rowStride +
+                boxLocation.z * box.sliceStride;
+            const auto rowLength = chunkRegionMax.x - chunkRegionMin.x;
+
+            // Sections are stored x, y, z as well, so every run of the row is contiguous.
+            // Without air the row is split into its runs of non-air blocks.
+            int runBegin = 0;
+            while (runBegin < rowLength)
             {
-                for (int z = locationFloored.z - ceiledEmission;
-                     z <= locationFloored.z + ceiledEmission;
-                     z++)
+                int runEnd = rowLength;
+                if (!box.bShouldPlaceAir)
                 {
-                    const auto neighbourLocation = glm::vec3(x, y, z);
+                    while (runBegin < rowLength && row[runBegin] == VS_DEFAULT_BLOCK_ID)
+                    {
+                        runBegin++;
+                    }
+                    runEnd = runBegin;
+                    while (runEnd < rowLength && row[runEnd] != VS_DEFAULT_BLOCK_ID)
+                    {
+                        runEnd++;
+                    }
+                    if (runBegin == runEnd)
+                    {
+                        break;
+                    }
+                }
 
-                    if (isLocationInBounds(neighbourLocation))
+                const auto runBlockIndex =
+                    blockCoordinatesToBlockIndex({chunkRegionMin.x + runBegin, y, z});
+                const auto [sectionIndex, sectionBlockIndex] =
+                    blockIndexToSectionAndSectionBlockIndex(runBlockIndex);
+                chunk->sections[sectionIndex].setRange(
+                    sectionBlockIndex, runEnd - runBegin, row + runBegin, previousRun.data());
+
+                for (int x = runBegin; x < runEnd; x++)
+                {
+                    const auto previousBlockID = previousRun[x - runBegin];
+                    if (previousBlockID == row[x])
                     {
-                        const auto distance =
-                            glm::length(glm::vec3(locationFloored) - neighbourLocation) + 0.0001F;
-                        if (distance < ceiledEmission)
-                        {
-                            addEmission(
-                                neighbourLocation,
-                                addOrRemove * 32.f * (1 - (distance / ceiledEmission)),
-                                blockEmissionColors[blockID],
-                                currentBlockID
-                            );
-                        }
+                        continue;
                     }
+
+                    const auto blockX = chunkRegionMin.x + x;
+                    onBlockChanged(
+                        chunkIndex,
+                        runBlockIndex + (x - runBegin),
+                        chunkOrigin + glm::ivec3(blockX, y, z),
+                        previousBlockID,
+                        row[x]);
+
+                    bHasChanged = true;
+                    changedMin = glm::min(changedMin, glm::ivec3(blockX, y, z));
+                    changedMax = glm::max(changedMax, glm::ivec3(blockX, y, z));
                 }
+
+                runBegin = runEnd;
             }
         }
     }
 
-    chunks[chunkIndex]->blocks[blockIndex] = blockID;
-    chunks[chunkIndex]->bIsDirty = true;
-
-    // TODO we only need to update adjacent chunks if set block is at chunkborder
-    const auto right = glm::clamp(chunkCoordinates + glm::ivec2(1, 0), {0, 0}, chunkCount - 1);
-    const auto left = glm::clamp(chunkCoordinates - glm::ivec2(1, 0), {0, 0}, chunkCount - 1);
-
-    const auto top = glm::clamp(chunkCoordinates + glm::ivec2(0, 1), {0, 0}, chunkCount - 1);
-    const auto down = glm::clamp(chunkCoordinates - glm::ivec2(1, 0), {0, 0}, chunkCount - 1);
+    if (bHasChanged)
+    {
+        markChangedBlocksDirty(chunkOrigin + changedMin, chunkOrigin + changedMax);
+    }
+}
 
-    chunks[chunkCoordinatesToChunkIndex(right)]->bIsDirty = true;
-    chunks[chunkCoordinatesToChunkIndex(left)]->bIsDirty = true;
-    chunks[chunkCoordinatesToChunkIndex(top)]->bIsDirty = true;
-    chunks[chunkCoordinatesToChunkIndex(down)]->bIsDirty = true;
+void VSChunkManager::markChangedBlocksDirty(
+    const glm::ivec3& changedMin,
+    const glm::ivec3& changedMax)
+{
+    // computeSunLight floods up to maxSunLight blocks sideways and faces sample the air one
+    // block in front of them, diagonal neighbours included
+    constexpr int reach = maxSunLight + 1;
+    const auto chunkMin = glm::max(changedMin - reach, glm::ivec3(0)) / chunkSize;
+    const auto chunkMax = glm::min(changedMax + reach, worldSize - 1) / chunkSize;
+    for (int chunkZ = chunkMin.z; chunkZ <= chunkMax.z; chunkZ++)
+    {
+        for (int chunkX = chunkMin.x; chunkX <= chunkMax.x; chunkX++)
+        {
+            chunks[chunkCoordinatesToChunkIndex({chunkX, chunkZ})]->bIsDirty = true;
+        }
+    }
 }
 
-void VSChunkManager::addEmission(const glm::vec3& location, float emission, glm::vec3 color, VSBlockID previousBlock)
+void VSChunkManager::onBlockChanged(
+    std::size_t chunkIndex,
+    std::size_t blockIndex,
+    const glm::ivec3& zeroBaseLocation,
+    VSBlockID previousBlockID,
+    VSBlockID blockID)
 {
-    const auto locationFloored = glm::ivec3(glm::floor(location));
-    const auto zeroBaseLocation = locationFloored + worldSizeHalf;
-    const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(zeroBaseLocation);
+    if (previousBlockID == blockID)
+    {
+        return;
+    }
+
+    auto* chunk = chunks[chunkIndex];
+    updateColumnHeight(chunk, blockIndex, blockID);
+
+    // Only queued here, propagateBlockLight applies the light with the final blocks
+    if (shouldUpdateBlockLight(zeroBaseLocation, previousBlockID, blockID))
+    {
+        pendingLightEdits.enqueue(zeroBaseLocation);
+    }
+
+    if ((previousBlockID == VS_DEFAULT_BLOCK_ID) == (blockID == VS_DEFAULT_BLOCK_ID))
+    {
+        return;
+    }
 
-    chunks[chunkIndex]->bIsDirty = true;
-    chunks[chunkIndex]->lightLevel[blockIndex] += emission;
-    chunks[chunkIndex]->lightColor[blockIndex] += color;
+    const auto brickIndex = blockCoordinatesToBrickIndex(blockIndexToBlockCoordinates(blockIndex));
+    auto& brickBlockCount = chunk->brickBlockCounts[brickIndex];
+    if (blockID == VS_DEFAULT_BLOCK_ID)
+    {
+        brickBlockCount.fetch_sub(1);
+    }
+    else
+    {
+        brickBlockCount.fetch_add(1);
+    }
 
-    if (emission <= 0)
+    // Shadows only change where air turns solid or back. A few of those only update the
+    // distance field around them, more rebuild the chunk and its neighbours after the
+    // visibility update.
+    if (pendingShadowEditCount.fetch_add(1) < maxPendingShadowEdits)
+    {
+        pendingShadowEdits.enqueue(zeroBaseLocation);
+    }
+    else
     {
-        chunks[chunkIndex]->lightColor[blockIndex] -= blockEmissionColors[previousBlock];
+        pendingShadowEditCount--;
+        chunk->bShouldRebuildNeighbourShadows = true;
     }
 }
 
@@ -263,6 +483,11 @@ glm::ivec3 VSChunkManager::getWorldSize() const
     return worldSize;
 }
 
+glm::ivec3 VSChunkManager::getChunkSize() const
+{
+    return chunkSize;
+}
+
 glm::ivec2 VSChunkManager::getChunkCount() const
 {
     return chunkCount;
@@ -271,7 +496,6 @@ glm::ivec2 VSChunkManager::getChunkCount() const
 void VSChunkManager::draw(VSWorld* world)
 {
     std::array<std::size_t, faceCombinationCount> visibleBlockInfoCount{};
-    std::array<std::size_t, faceCombinationCount> visibleBlockInfoCopiedCount{};
     std::vector<VSChunk*> visibleChunks;
     drawnBlockCount = 0;
 
@@ -298,28 +522,14 @@ void VSChunkManager::draw(VSWorld* world)
         frozenVPMatrix = VP;
         frozenCameraPos = cameraPos;
 
-        const auto radius = glm::length(glm::vec3(chunkSize));
-
-        auto zFar = world->getCamera()->getZFar();
-
-        // First to cheap distance check based on zFar
-        if (glm::length2(cameraPos - chunk->chunkLocation) - (radius * radius * 4.F) <
-            (zFar * zFar))
+        if (isChunkInView(chunk, VP, cameraPos, world->getCamera()->getZFar()))
         {
-            // Cull using bounding sphere in projections space
-            const auto chunkCenterInP = VP * glm::vec4(chunk->chunkLocation, 1.f);
-
-            if (!bIsFrustumCullingEnabled ||
-                ((glm::abs(chunkCenterInP.x) - radius) < (chunkCenterInP.w * 1.F) &&
-                 (glm::abs(chunkCenterInP.y) - radius) < (chunkCenterInP.w * 1.F)))
+            for (std::size_t i = 0; i < chunk->visibleBlockInfos.size(); i++)
             {
-                for (std::size_t i = 0; i < chunk->visibleBlockInfos.size(); i++)
-                {
-                    visibleBlockInfoCount[i] += chunk->visibleBlockInfos[i].size();
-                    drawnBlockCount += chunk->visibleBlockInfos[i].size();
-                }
-                visibleChunks.push_back(chunk);
+                visibleBlockInfoCount[i] += chunk->visibleBlockInfos[i].size();
+                drawnBlockCount += chunk->visibleBlockInfos[i].size();
             }
+            visibleChunks.push_back(chunk);
         }
     }
     glActiveTexture(GL_TEXTURE0 + shadowTextureID);
@@ -328,7 +538,8 @@ void VSChunkManager::draw(VSWorld* world)
     glActiveTexture(GL_TEXTURE0 + spriteTextureID);
     glBindTexture(GL_TEXTURE_2D_ARRAY, spriteTexture);
 
-    chunkShader.uniforms()
+    const auto& activeChunkShader = bIsGreedyMeshingEnabled ? *greedyChunkShader : *chunkShader;
+    activeChunkShader.uniforms()
         .setVec3("lightDir", world->getDirectLightDir())
         .setVec3("lightColor", world->getDirectLightColor())
         .setVec3("viewPos", world->getCamera()->getPosition())
@@ -337,6 +548,12 @@ void VSChunkManager::draw(VSWorld* world)
         .setMat4("VP", world->getCamera()->getVPMatrix())
         .setUVec3("worldSize", getWorldSize())
         .setInt("shadowTexture", shadowTextureID)
+        .setFloat("maxShadowDistance", static_cast<float>(maxShadowDistance))
+        .setFloat("shadowDistanceScale", 255.F / static_cast<float>(shadowDistanceStepsPerBlock))
+        .setFloat(
+            "shadowDistanceOffset",
+            -static_cast<float>(shadowDistanceZero) /
+                static_cast<float>(shadowDistanceStepsPerBlock))
         .setInt("spriteTexture", spriteTextureID)
         .setFloat(
             "time",
@@ -352,139 +569,473 @@ void VSChunkManager::draw(VSWorld* world)
         .setBool("showLight", VSApp::getInstance()->getUI()->getState()->bShouldShowLight);
 
     drawCallCount = 0;
+    drawnTriangleCount = 0;
+    drawnVertexCount = 0;
+
+    if (bIsGreedyMeshingEnabled)
+    {
+        drawGreedy(visibleChunks);
+        glBindVertexArray(0);
+        return;
+    }
 
     for (std::size_t i = 1; i < faceCombinationCount; i++)
     {
+        drawRanges[i].clear();
+
         // dont draw if no blocks active
-        if (visibleBlockInfoCount[i] != 0)
+        if (visibleBlockInfoCount[i] == 0)
         {
-            glBindVertexArray(vertexContexts[i]->vertexArrayObject);
-
-            glBindBuffer(GL_ARRAY_BUFFER, visibleBlockInfoBuffers[i]);
-            glBufferData(
-                GL_ARRAY_BUFFER,
-                visibleBlockInfoCount[i] * sizeof(VSChunk::VSVisibleBlockInfo),
-                nullptr,
-                GL_DYNAMIC_DRAW);
-
-            for (const auto* chunk : visibleChunks)
-            {
-                glBufferSubData(
-                    GL_ARRAY_BUFFER,
-                    visibleBlockInfoCopiedCount[i] * sizeof(VSChunk::VSVisibleBlockInfo),
-                    chunk->visibleBlockInfos[i].size() * sizeof(VSChunk::VSVisibleBlockInfo),
-                    chunk->visibleBlockInfos[i].data());
+            continue;
+        }
 
-                visibleBlockInfoCopiedCount[i] += chunk->visibleBlockInfos[i].size();
-            }
+        drawnTriangleCount += visibleBlockInfoCount[i] * (cubeMeshes[i].indexCount / 3);
+        drawnVertexCount += visibleBlockInfoCount[i] * cubeMeshes[i].vertexCount;
 
-            glDrawElementsInstanced(
-                GL_TRIANGLES,
-                vertexContexts[i]->indexCount,
-                GL_UNSIGNED_INT,
-                nullptr,
-                visibleBlockInfoCount[i]);
+        collectDrawRanges(i, visibleChunks);
+    }
 
-            drawCallCount++;
-        }
+    buildDrawCommands();
+    if (VSApp::getInstance()->getUI()->getState()->bIsMultiDrawIndirectEnabled &&
+        GLAD_GL_VERSION_4_3 != 0)
+    {
+        drawMultiIndirect();
+    }
+    else
+    {
+        drawInstanced();
     }
 
     glBindVertexArray(0);
 }
 
-void VSChunkManager::updateChunks()
+void VSChunkManager::collectDrawRanges(
+    std::size_t faceCombination,
+    const std::vector<VSChunk*>& visibleChunks)
 {
-    assert(debug_isMainThread());
-
-    initializeChunks();
-
-    // Init from file asynchronous
-    bool expected = true;
-    if (!bShouldReinitializeChunks &&
-        bShouldInitializeFromData.compare_exchange_weak(expected, false))
+    auto& ranges = drawRanges[faceCombination];
+    for (const auto* chunk : visibleChunks)
     {
-        // Set block data to chunks, TODO: add checks, this is potentially dangerous
-        uint32_t chunkBlockCount = getChunkBlockCount();
-        VSLog::Log(VSLog::Category::Core, VSLog::Level::info, "cbc {}", chunkBlockCount);
-
-        auto iter = worldDataFromFile.blocks.begin();
-        for (auto* chunk : chunks)
+        if (chunk->visibleBlockInfoRanges[faceCombination].count != 0)
         {
-            std::copy(iter, iter + chunkBlockCount, chunk->blocks.begin());
-
-            chunk->bIsDirty = true;
-            iter += chunkBlockCount;
+            ranges.push_back(chunk->visibleBlockInfoRanges[faceCombination]);
         }
     }
 
-    for (std::size_t chunkIndex = 0; chunkIndex < getTotalChunkCount(); ++chunkIndex)
+    // Merge ranges of visible chunks that happen to be adjacent in the buffer
+    std::sort(ranges.begin(), ranges.end(), [](const auto& a, const auto& b) {
+        return a.offset < b.offset;
+    });
+    std::size_t mergedRangeCount = 0;
+    for (const auto& range : ranges)
     {
-        updateVisibleBlocks(chunkIndex);
+        if (mergedRangeCount != 0)
+        {
+            auto& lastRange = ranges[mergedRangeCount - 1];
+            if (lastRange.offset + lastRange.count == range.offset)
+            {
+                lastRange.count += range.count;
+                continue;
+            }
+        }
+        ranges[mergedRangeCount++] = range;
     }
+    ranges.resize(mergedRangeCount);
+}
 
-    if (VSApp::getInstance()->getUI()->getState()->bAreShadowsEnabled)
+void VSChunkManager::buildDrawCommands()
+{
+    drawCommands.clear();
+    for (std::size_t i = 1; i < faceCombinationCount; i++)
     {
-        for (std::size_t chunkIndex = 0; chunkIndex < getTotalChunkCount(); ++chunkIndex)
+        const auto& cubeMesh = cubeMeshes[i];
+        for (const auto& range : drawRanges[i])
         {
-            updateShadows(chunkIndex);
+            drawCommands.push_back(
+                {static_cast<GLuint>(cubeMesh.indexCount),
+                 static_cast<GLuint>(range.count),
+                 cubeMesh.firstIndex,
+                 cubeMesh.baseVertex,
+                 static_cast<GLuint>(range.offset)});
         }
     }
 }
 
-glm::vec3 VSChunkManager::getOrigin() const
+void VSChunkManager::drawInstanced()
 {
-    return origin;
-}
+    if (drawCommands.empty())
+    {
+        return;
+    }
 
-void VSChunkManager::setOrigin(const glm::vec3& newOrigin)
-{
-    origin = newOrigin;
-}
+    // Without base instance every command needs its own attribute pointer
+    const bool bHasBaseInstance = GLAD_GL_VERSION_4_2 != 0;
 
-bool VSChunkManager::isFrustumCullingEnabled() const
-{
-    return bIsFrustumCullingEnabled;
-}
+    glBindVertexArray(cubeVertexContext->vertexArrayObject);
+    glBindBuffer(GL_ARRAY_BUFFER, visibleBlockInfoBuffer->getBuffer());
+    if (bHasBaseInstance)
+    {
+        setInstanceAttribPointer(0);
+    }
 
-void VSChunkManager::setIsFrustumCullingEnabled(bool state)
-{
-    bIsFrustumCullingEnabled = state;
-}
+    for (const auto& command : drawCommands)
+    {
+        const auto* firstIndex = (void*)(command.firstIndex * sizeof(GLuint));
+        if (bHasBaseInstance)
+        {
+            glDrawElementsInstancedBaseVertexBaseInstance(
+                GL_TRIANGLES,
+                command.count,
+                GL_UNSIGNED_INT,
+                firstIndex,
+                command.instanceCount,
+                command.baseVertex,
+                command.baseInstance);
+        }
+        else
+        {
+            setInstanceAttribPointer(command.baseInstance);
+            glDrawElementsInstancedBaseVertex(
+                GL_TRIANGLES,
+                command.count,
+                GL_UNSIGNED_INT,
+                firstIndex,
+                command.instanceCount,
+                command.baseVertex);
+        }
 
-glm::vec3 VSChunkManager::getColorOverride() const
-{
-    return colorOverride;
+        drawCallCount++;
+    }
 }
 
-void VSChunkManager::setColorOverride(const glm::vec3& newColorOverride)
+void VSChunkManager::drawMultiIndirect()
 {
-    colorOverride = newColorOverride;
-}
+    if (drawCommands.empty())
+    {
+        return;
+    }
 
-void VSChunkManager::setChunkDimensions(
-    const glm::ivec3& inChunkSize,
-    const glm::ivec2& inChunkCount)
-{
-    // Force even number of chunks and blocks
-    newChunkSize = (inChunkSize / 2) * 2;
-    newChunkCount = (inChunkCount / 2) * 2;
-    newWorldSize = {
-        newChunkSize.x * newChunkCount.x, newChunkSize.y, newChunkSize.z * newChunkCount.y};
-    newWorldSizeHalf = newWorldSize / 2;
-    bShouldReinitializeChunks = true;
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBuffer);
+    glBufferData(
+        GL_DRAW_INDIRECT_BUFFER,
+        drawCommands.size() * sizeof(VSDrawElementsIndirectCommand),
+        drawCommands.data(),
+        GL_STREAM_DRAW);
+
+    glBindVertexArray(cubeVertexContext->vertexArrayObject);
+    glBindBuffer(GL_ARRAY_BUFFER, visibleBlockInfoBuffer->getBuffer());
+    setInstanceAttribPointer(0);
+
+    glMultiDrawElementsIndirect(
+        GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(drawCommands.size()), 0);
+    drawCallCount++;
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
 
-std::size_t VSChunkManager::getChunkBlockCount() const
+void VSChunkManager::drawGreedy(const std::vector<VSChunk*>& visibleChunks)
 {
-    return glm::compMul(chunkSize);
+    for (const auto* chunk : visibleChunks)
+    {
+        if (chunk->greedyIndexCount == 0)
+        {
+            continue;
+        }
+
+        glBindVertexArray(chunk->greedyVertexArray);
+        glDrawElements(GL_TRIANGLES, chunk->greedyIndexCount, GL_UNSIGNED_INT, nullptr);
+
+        drawCallCount++;
+        drawnTriangleCount += chunk->greedyIndexCount / 3;
+        drawnVertexCount += chunk->greedyVertexCount;
+    }
 }
 
-std::size_t VSChunkManager::getTotalBlockCount() const
+void VSChunkManager::setInstanceAttribPointer(std::size_t firstInstance) const
 {
-    return glm::compMul(chunkSize) * getTotalChunkCount();
+    glVertexAttribIPointer(
+        cubeVertexContext->lastAttribPointer + 1,
+        4,
+        GL_UNSIGNED_INT,
+        sizeof(VSChunk::VSVisibleBlockInfo),
+        (void*)(firstInstance * sizeof(VSChunk::VSVisibleBlockInfo) +
+                offsetof(VSChunk::VSVisibleBlockInfo, location)));
 }
 
-std::size_t VSChunkManager::getVisibleBlockCount() const
+void VSChunkManager::updateChunks(const VSCamera* camera)
+{
+    assert(debug_isMainThread());
+
+    instanceUploadByteCount = 0;
+    shadowUploadByteCount = 0;
+
+    initializeChunks();
+
+    // Requested by generateChunks, the cancelled updates may have cleared the flags set there
+    if (bShouldCancelChunkUpdates.exchange(false))
+    {
+        cancelChunkUpdates();
+        for (auto* chunk : chunks)
+        {
+            chunk->bShouldRebuildNeighbourShadows = true;
+            chunk->bIsDirty = true;
+        }
+    }
+
+    propagateBlockLight();
+
+    // Switching the mesh type needs a visibility update of every chunk
+    const bool bShouldUseGreedyMeshing =
+        VSApp::getInstance()->getUI()->getState()->bIsGreedyMeshingEnabled;
+    if (bShouldUseGreedyMeshing != bIsGreedyMeshingEnabled)
+    {
+        bIsGreedyMeshingEnabled = bShouldUseGreedyMeshing;
+        for (auto* chunk : chunks)
+        {
+            chunk->bIsDirty = true;
+        }
+    }
+
+    // Switching the visibility kernel rebuilds every chunk so both can be timed on the same world
+    const bool bShouldUseBitmaskVisibility =
+        VSApp::getInstance()->getUI()->getState()->bIsBitmaskVisibilityEnabled;
+    if (bShouldUseBitmaskVisibility != bIsBitmaskVisibilityEnabled)
+    {
+        bIsBitmaskVisibilityEnabled = bShouldUseBitmaskVisibility;
+        visibilityKernelNanoseconds = 0;
+        visibilityKernelRunCount = 0;
+        for (auto* chunk : chunks)
+        {
+            chunk->bIsDirty = true;
+        }
+    }
+
+    // Switching the shadow kernel rebuilds every distance field so both can be timed
+    const bool bShouldUseDistanceTransform =
+        VSApp::getInstance()->getUI()->getState()->bIsDistanceTransformEnabled;
+    if (bShouldUseDistanceTransform != bIsDistanceTransformEnabled)
+    {
+        bIsDistanceTransformEnabled = bShouldUseDistanceTransform;
+        shadowKernelNanoseconds = 0;
+        shadowKernelRunCount = 0;
+        for (auto* chunk : chunks)
+        {
+            chunk->bShouldRebuildShadows = true;
+        }
+    }
+
+    const bool bShouldUseSkyLight = VSApp::getInstance()->getUI()->getState()->bIsSkyLightEnabled;
+    if (bShouldUseSkyLight != bIsSkyLightEnabled)
+    {
+        bIsSkyLightEnabled = bShouldUseSkyLight;
+        for (auto* chunk : chunks)
+        {
+            chunk->bIsDirty = true;
+        }
+    }
+
+    // Init from file asynchronous
+    bool expected = true;
+    if (!bShouldReinitializeChunks &&
+        bShouldInitializeFromData.compare_exchange_weak(expected, false))
+    {
+        // Set block data to chunks, TODO: add checks, this is potentially dangerous
+        uint32_t chunkBlockCount = getChunkBlockCount();
+        VSLog::Log(VSLog::Category::Core, VSLog::Level::info, "cbc {}", chunkBlockCount);
+
+        const auto* chunkData = worldDataFromFile.blocks.data();
+        for (auto* chunk : chunks)
+        {
+            assignChunkBlocks(chunk, chunkData);
+
+            chunk->bShouldRebuildNeighbourShadows = true;
+            chunk->bIsDirty = true;
+            chunkData += chunkBlockCount;
+        }
+    }
+
+    // Updates only start while there are free slots, so the order decides who gets them
+    updateChunkUpdateOrder(camera);
+
+    for (const auto& priority : chunkUpdateOrder)
+    {
+        updateVisibleBlocks(priority.chunkIndex);
+    }
+
+    const bool bAreShadowsEnabled = VSApp::getInstance()->getUI()->getState()->bAreShadowsEnabled;
+    updateShadowRegions(bAreShadowsEnabled);
+    if (bAreShadowsEnabled)
+    {
+        for (const auto& priority : chunkUpdateOrder)
+        {
+            updateShadows(priority.chunkIndex);
+        }
+    }
+
+    updateFirstVisibleFrame();
+}
+
+bool VSChunkManager::isChunkInView(
+    const VSChunk* chunk,
+    const glm::mat4& VP,
+    const glm::vec3& cameraPos,
+    float zFar) const
+{
+    const auto radius = glm::length(glm::vec3(chunkSize));
+
+    // First to cheap distance check based on zFar
+    if (glm::length2(cameraPos - chunk->chunkLocation) - (radius * radius * 4.F) >= (zFar * zFar))
+    {
+        return false;
+    }
+
+    if (!bIsFrustumCullingEnabled)
+    {
+        return true;
+    }
+
+    // Cull using bounding sphere in projections space
+    const auto chunkCenterInP = VP * glm::vec4(chunk->chunkLocation, 1.f);
+    return (glm::abs(chunkCenterInP.x) - radius) < (chunkCenterInP.w * 1.F) &&
+           (glm::abs(chunkCenterInP.y) - radius) < (chunkCenterInP.w * 1.F);
+}
+
+void VSChunkManager::updateChunkUpdateOrder(const VSCamera* camera)
+{
+    const auto VP = camera->getVPMatrix();
+    const auto cameraPos = camera->getPosition();
+    const auto zFar = camera->getZFar();
+
+    chunkUpdateOrder.resize(chunks.size());
+    for (std::size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+    {
+        const auto* chunk = chunks[chunkIndex];
+        chunkUpdateOrder[chunkIndex] = {
+            isChunkInView(chunk, VP, cameraPos, zFar),
+            glm::length2(cameraPos - chunk->chunkLocation),
+            chunkIndex};
+    }
+
+    std::sort(chunkUpdateOrder.begin(), chunkUpdateOrder.end(), [](const auto& a, const auto& b) {
+        if (a.bIsInView != b.bIsInView)
+        {
+            return a.bIsInView;
+        }
+        return a.distanceSquared < b.distanceSquared;
+    });
+}
+
+void VSChunkManager::updateFirstVisibleFrame()
+{
+    if (!bIsWaitingForFirstVisibleFrame)
+    {
+        return;
+    }
+
+    // Chunks in view come first in chunkUpdateOrder
+    bool bHasVisibleBlocks = false;
+    for (const auto& priority : chunkUpdateOrder)
+    {
+        if (!priority.bIsInView)
+        {
+            break;
+        }
+
+        auto* const chunk = chunks[priority.chunkIndex];
+        if (chunk->bIsDirty || activeVisibilityBuildTasks.count(chunk) != 0)
+        {
+            return;
+        }
+        bHasVisibleBlocks = bHasVisibleBlocks || !chunk->visibleBlockIndices->empty();
+    }
+
+    // Freshly initialized chunks are empty, wait until blocks arrive
+    if (!bHasVisibleBlocks)
+    {
+        return;
+    }
+
+    bIsWaitingForFirstVisibleFrame = false;
+    firstVisibleFrameMilliseconds =
+        std::chrono::duration<float, std::milli>(
+            std::chrono::high_resolution_clock::now() - loadStartTime)
+            .count();
+}
+
+glm::vec3 VSChunkManager::getOrigin() const
+{
+    return origin;
+}
+
+void VSChunkManager::setOrigin(const glm::vec3& newOrigin)
+{
+    origin = newOrigin;
+}
+
+bool VSChunkManager::isFrustumCullingEnabled() const
+{
+    return bIsFrustumCullingEnabled;
+}
+
+void VSChunkManager::setIsFrustumCullingEnabled(bool state)
+{
+    bIsFrustumCullingEnabled = state;
+}
+
+glm::vec3 VSChunkManager::getColorOverride() const
+{
+    return colorOverride;
+}
+
+void VSChunkManager::setColorOverride(const glm::vec3& newColorOverride)
+{
+    colorOverride = newColorOverride;
+}
+
+void VSChunkManager::setChunkDimensions(
+    const glm::ivec3& inChunkSize,
+    const glm::ivec2& inChunkCount)
+{
+    // Force even number of chunks and blocks, and a world packVisibleBlockInfo can address
+    newChunkSize =
+        (glm::min(inChunkSize, glm::ivec3(maxWorldWidth, maxWorldHeight, maxWorldWidth)) / 2) * 2;
+    const glm::ivec2 maxChunkCount(maxWorldWidth / newChunkSize.x, maxWorldWidth / newChunkSize.z);
+    newChunkCount = (glm::min(inChunkCount, maxChunkCount) / 2) * 2;
+    if (newChunkSize != (inChunkSize / 2) * 2 || newChunkCount != (inChunkCount / 2) * 2)
+    {
+        VSLog::Log(
+            VSLog::Category::Core,
+            VSLog::Level::warn,
+            "World of {}x{} chunks of {}x{}x{} blocks is too large, clamped to {}x{} chunks of "
+            "{}x{}x{} blocks",
+            inChunkCount.x,
+            inChunkCount.y,
+            inChunkSize.x,
+            inChunkSize.y,
+            inChunkSize.z,
+            newChunkCount.x,
+            newChunkCount.y,
+            newChunkSize.x,
+            newChunkSize.y,
+            newChunkSize.z);
+    }
+    newWorldSize = {
+        newChunkSize.x * newChunkCount.x, newChunkSize.y, newChunkSize.z * newChunkCount.y};
+    newWorldSizeHalf = newWorldSize / 2;
+    bShouldReinitializeChunks = true;
+}
+
+std::size_t VSChunkManager::getChunkBlockCount() const
+{
+    return glm::compMul(chunkSize);
+}
+
+std::size_t VSChunkManager::getTotalBlockCount() const
+{
+    return glm::compMul(chunkSize) * getTotalChunkCount();
+}
+
+std::size_t VSChunkManager::getVisibleBlockCount() const
 {
     return std::accumulate(chunks.begin(), chunks.end(), 0, [](std::size_t acc, VSChunk* curr) {
         return acc +
@@ -498,665 +1049,3634 @@ std::size_t VSChunkManager::getVisibleBlockCount() const
     });
 }
 
-std::size_t VSChunkManager::getDrawnBlockCount() const
+std::size_t VSChunkManager::getDrawnBlockCount() const
+{
+    return drawnBlockCount;
+}
+
+std::size_t VSChunkManager::getTotalChunkCount() const
+{
+    return glm::compMul(chunkCount);
+}
+
+std::size_t VSChunkManager::getDrawnTriangleCount() const
+{
+    return drawnTriangleCount;
+}
+
+std::size_t VSChunkManager::getDrawnVertexCount() const
+{
+    return drawnVertexCount;
+}
+
+float VSChunkManager::getAverageVisibilityKernelMicroseconds() const
+{
+    const auto runCount = visibilityKernelRunCount.load();
+    return runCount == 0 ? 0.F
+                         : static_cast<float>(visibilityKernelNanoseconds.load()) /
+                               (static_cast<float>(runCount) * 1000.F);
+}
+
+float VSChunkManager::getAverageShadowKernelMilliseconds() const
+{
+    const auto runCount = shadowKernelRunCount.load();
+    return runCount == 0 ? 0.F
+                         : static_cast<float>(shadowKernelNanoseconds.load()) /
+                               (static_cast<float>(runCount) * 1e6F);
+}
+
+std::size_t VSChunkManager::getShadowUploadByteCount() const
+{
+    return shadowUploadByteCount;
+}
+
+std::size_t VSChunkManager::getInstanceUploadByteCount() const
+{
+    return instanceUploadByteCount;
+}
+
+int VSChunkManager::getSurfaceHeight(int x, int z) const
+{
+    return getColumnHeight(x + worldSizeHalf.x, z + worldSizeHalf.z) - worldSizeHalf.y;
+}
+
+std::uint8_t VSChunkManager::getSunLight(const glm::vec3& location) const
+{
+    const auto zeroBaseLocation = glm::ivec3(glm::floor(location)) + worldSizeHalf;
+    const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(zeroBaseLocation);
+    const auto sunLight = std::atomic_load(&chunks[chunkIndex]->sunLight);
+    if (sunLight->empty())
+    {
+        return maxSunLight;
+    }
+    return ((*sunLight)[blockIndex / 2] >> ((blockIndex % 2) * 4)) & 0xFU;
+}
+
+std::size_t VSChunkManager::getLastShadowRegionBlockCount() const
+{
+    return lastShadowRegionBlockCount;
+}
+
+std::size_t VSChunkManager::getLightUpdateBlockCount() const
+{
+    return lightUpdateBlockCount;
+}
+
+float VSChunkManager::getFirstVisibleFrameMilliseconds() const
+{
+    return firstVisibleFrameMilliseconds;
+}
+
+std::size_t VSChunkManager::getInstanceBufferByteCount() const
+{
+    return visibleBlockInfoBuffer->getCapacity() * visibleBlockInfoBuffer->getElementSize();
+}
+
+std::size_t VSChunkManager::getDrawCallCount() const
+{
+    return drawCallCount;
+}
+
+std::size_t VSChunkManager::getBlockStorageByteCount() const
+{
+    return std::accumulate(
+        chunks.begin(), chunks.end(), std::size_t{0}, [](std::size_t acc, VSChunk* curr) {
+            for (const auto& section : curr->sections)
+            {
+                acc += section.getByteSize();
+            }
+            return acc;
+        });
+}
+
+bool VSChunkManager::shouldReinitializeChunks() const
+{
+    return bShouldReinitializeChunks.load();
+}
+
+bool VSChunkManager::isLocationInBounds(const glm::vec3& location) const
+{
+    return (
+        (location.x >= -worldSizeHalf.x && location.x < worldSizeHalf.x) &&
+        (location.y >= -worldSizeHalf.y && location.y < worldSizeHalf.y) &&
+        (location.z >= -worldSizeHalf.z && location.z < worldSizeHalf.z));
+}
+
+VSChunkManager::VSTraceResult
+VSChunkManager::lineTrace(const glm::vec3& start, const glm::vec3& end) const
+{
+    const glm::vec3 startToEnd = end - start;
+
+    const float maxRayLength = glm::length(startToEnd);
+    if (maxRayLength == 0.F)
+    {
+        return {false, {}, {}, VS_DEFAULT_BLOCK_ID};
+    }
+
+    return traceRay(start, startToEnd / maxRayLength, maxRayLength);
+}
+
+VSChunkManager::VSTraceResult VSChunkManager::traceRay(
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    float maxDistance) const
+{
+    const VSTraceResult noHit = {false, {}, {}, VS_DEFAULT_BLOCK_ID};
+    if (bShouldReinitializeChunks || direction == glm::vec3(0.F))
+    {
+        return noHit;
+    }
+
+    const auto rayDir = glm::normalize(direction);
+    const auto rayStart = origin + glm::vec3(worldSizeHalf);
+    const auto worldSize = getWorldSize();
+
+    // Clip the ray against the world bounds, entryAxis stays -1 if the ray starts inside
+    float tEntry = 0.F;
+    float tExit = maxDistance;
+    int entryAxis = -1;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (rayDir[axis] == 0.F)
+        {
+            if (rayStart[axis] < 0.F || rayStart[axis] >= static_cast<float>(worldSize[axis]))
+            {
+                return noHit;
+            }
+            continue;
+        }
+
+        float tNear = -rayStart[axis] / rayDir[axis];
+        float tFar = (static_cast<float>(worldSize[axis]) - rayStart[axis]) / rayDir[axis];
+        if (tNear > tFar)
+        {
+            std::swap(tNear, tFar);
+        }
+        if (tNear > tEntry)
+        {
+            tEntry = tNear;
+            entryAxis = axis;
+        }
+        tExit = glm::min(tExit, tFar);
+    }
+    if (tEntry > tExit)
+    {
+        return noHit;
+    }
+
+    auto block = glm::clamp(
+        glm::ivec3(glm::floor(rayStart + rayDir * tEntry)), glm::ivec3(0), worldSize - 1);
+    if (entryAxis >= 0)
+    {
+        block[entryAxis] = rayDir[entryAxis] > 0.F ? 0 : worldSize[entryAxis] - 1;
+    }
+
+    // Amanatides & Woo: t of the next boundary crossing and t between crossings per axis
+    glm::ivec3 step;
+    glm::vec3 tNextBoundary;
+    glm::vec3 tDelta;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        step[axis] = rayDir[axis] > 0.F ? 1 : (rayDir[axis] < 0.F ? -1 : 0);
+        if (step[axis] == 0)
+        {
+            tNextBoundary[axis] = std::numeric_limits<float>::max();
+            tDelta[axis] = std::numeric_limits<float>::max();
+            continue;
+        }
+        const auto boundary = static_cast<float>(block[axis] + (step[axis] > 0 ? 1 : 0));
+        tNextBoundary[axis] = (boundary - rayStart[axis]) / rayDir[axis];
+        tDelta[axis] = 1.F / glm::abs(rayDir[axis]);
+    }
+
+    // Blocks of the last empty section or brick. The ray jumps to its far side without looking
+    // up the blocks in between.
+    glm::ivec3 emptyRegionMin = glm::ivec3(0);
+    glm::ivec3 emptyRegionMax = glm::ivec3(0);
+    const auto isInEmptyRegion = [&block, &emptyRegionMin, &emptyRegionMax]() {
+        return glm::all(glm::greaterThanEqual(block, emptyRegionMin)) &&
+               glm::all(glm::lessThan(block, emptyRegionMax));
+    };
+
+    int hitAxis = entryAxis;
+    float t = tEntry;
+    while (true)
+    {
+        if (!isInEmptyRegion())
+        {
+            const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(block);
+            const auto [sectionIndex, sectionBlockIndex] =
+                blockIndexToSectionAndSectionBlockIndex(blockIndex);
+            const auto* chunk = chunks[chunkIndex];
+            const auto& section = chunk->sections[sectionIndex];
+            const auto chunkMin =
+                glm::ivec3(block.x - block.x % chunkSize.x, 0, block.z - block.z % chunkSize.z);
+            const auto blockCoords = block - chunkMin;
+
+            if (section.isFilledWith(VS_DEFAULT_BLOCK_ID))
+            {
+                emptyRegionMin =
+                    chunkMin + glm::ivec3(0, static_cast<int>(sectionIndex * sectionHeight), 0);
+                emptyRegionMax = glm::min(
+                    emptyRegionMin + glm::ivec3(chunkSize.x, sectionHeight, chunkSize.z),
+                    chunkMin + chunkSize);
+            }
+            else if (chunk->brickBlockCounts[blockCoordinatesToBrickIndex(blockCoords)] == 0)
+            {
+                emptyRegionMin = chunkMin + blockCoords / brickSize * brickSize;
+                emptyRegionMax =
+                    glm::min(emptyRegionMin + glm::ivec3(brickSize), chunkMin + chunkSize);
+            }
+            else
+            {
+                const auto blockID = section.get(sectionBlockIndex);
+                if (blockID != VS_DEFAULT_BLOCK_ID)
+                {
+                    auto hitLocation = rayStart + rayDir * t;
+                    auto normal = glm::vec3(0.F);
+                    if (hitAxis >= 0)
+                    {
+                        // Put the hit exactly on the entered face, nudged to the block in front
+                        normal[hitAxis] = static_cast<float>(-step[hitAxis]);
+                        if (step[hitAxis] > 0)
+                        {
+                            hitLocation[hitAxis] = static_cast<float>(block[hitAxis]) - 0.00001F;
+                        }
+                        else
+                        {
+                            hitLocation[hitAxis] = static_cast<float>(block[hitAxis] + 1);
+                        }
+                    }
+                    else
+                    {
+                        // Started inside the block, face the dominant ray direction
+                        const auto absDir = glm::abs(rayDir);
+                        const int axis = absDir.x >= absDir.y && absDir.x >= absDir.z
+                                             ? 0
+                                             : (absDir.y >= absDir.z ? 1 : 2);
+                        normal[axis] = -glm::sign(rayDir[axis]);
+                    }
+
+                    return VSTraceResult{
+                        true,
+                        hitLocation - glm::vec3(worldSizeHalf),
+                        normal,
+                        blockID,
+                        block - worldSizeHalf};
+                }
+            }
+        }
+
+        if (isInEmptyRegion())
+        {
+            float tRegionExit = std::numeric_limits<float>::max();
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (step[axis] != 0)
+                {
+                    const auto bound = step[axis] > 0 ? emptyRegionMax[axis] : emptyRegionMin[axis];
+                    tRegionExit = glm::min(
+                        tRegionExit, (static_cast<float>(bound) - rayStart[axis]) / rayDir[axis]);
+                }
+            }
+            if (tRegionExit > tExit)
+            {
+                return noHit;
+            }
+
+            // Move every axis to the last block of the region on the ray, the step after this
+            // leaves the region. Limited to the region in case of rounding.
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (step[axis] == 0 || tNextBoundary[axis] >= tRegionExit)
+                {
+                    continue;
+                }
+                const int regionStepCount = step[axis] > 0
+                                                ? emptyRegionMax[axis] - 1 - block[axis]
+                                                : block[axis] - emptyRegionMin[axis];
+                const int stepCount = glm::min(
+                    static_cast<int>(
+                        glm::ceil((tRegionExit - tNextBoundary[axis]) / tDelta[axis])),
+                    regionStepCount);
+                block[axis] += step[axis] * stepCount;
+                tNextBoundary[axis] += tDelta[axis] * static_cast<float>(stepCount);
+            }
+        }
+
+        if (tNextBoundary.x < tNextBoundary.y)
+        {
+            hitAxis = tNextBoundary.x < tNextBoundary.z ? 0 : 2;
+        }
+        else
+        {
+            hitAxis = tNextBoundary.y < tNextBoundary.z ? 1 : 2;
+        }
+
+        t = tNextBoundary[hitAxis];
+        if (t > tExit)
+        {
+            return noHit;
+        }
+        block[hitAxis] += step[hitAxis];
+        tNextBoundary[hitAxis] += tDelta[hitAxis];
+        if (block[hitAxis] < 0 || block[hitAxis] >= worldSize[hitAxis])
+        {
+            return noHit;
+        }
+    }
+}
+
+bool VSChunkManager::isSunVisible(const glm::vec3& location, const glm::vec3& sunDirection) const
+{
+    const auto maxDistance = glm::length(glm::vec3(getWorldSize()));
+    return !traceRay(location, sunDirection, maxDistance).bHasHit;
+}
+
+void VSChunkManager::traceRays(
+    const VSRay* rays,
+    std::size_t rayCount,
+    VSTraceResult* outResults) const
+{
+    auto* threadPool = VSApp::getInstance()->getThreadPool();
+    if (rayCount < minParallelRayCount || threadPool == nullptr)
+    {
+        for (std::size_t rayIndex = 0; rayIndex < rayCount; rayIndex++)
+        {
+            const auto& ray = rays[rayIndex];
+            outResults[rayIndex] = traceRay(ray.origin, ray.direction, ray.maxDistance);
+        }
+        return;
+    }
+
+    const auto packetCount = (rayCount + rayPacketSize - 1) / rayPacketSize;
+    threadPool->parallelFor(packetCount, [this, rays, rayCount, outResults](std::size_t packet) {
+        const auto packetEnd = glm::min((packet + 1) * rayPacketSize, rayCount);
+        for (auto rayIndex = packet * rayPacketSize; rayIndex < packetEnd; rayIndex++)
+        {
+            const auto& ray = rays[rayIndex];
+            outResults[rayIndex] = traceRay(ray.origin, ray.direction, ray.maxDistance);
+        }
+    });
+}
+
+VSChunkManager::VSTraceBenchmarkResult
+VSChunkManager::runTraceBenchmark(std::size_t rayCount, const glm::vec3& sunDirection) const
+{
+    VSTraceBenchmarkResult result;
+    if (bShouldReinitializeChunks || rayCount == 0)
+    {
+        return result;
+    }
+
+    std::mt19937 randomEngine(42);
+    const auto worldSize = glm::vec3(getWorldSize());
+    std::uniform_real_distribution<float> unitDistribution(0.F, 1.F);
+    std::normal_distribution<float> directionDistribution;
+    std::uniform_int_distribution<int> columnXDistribution(-worldSizeHalf.x, worldSizeHalf.x - 1);
+    std::uniform_int_distribution<int> columnZDistribution(-worldSizeHalf.z, worldSizeHalf.z - 1);
+    const auto maxDistance = glm::length(worldSize);
+
+    // Generate all inputs first so only the traces are timed
+    std::vector<glm::vec3> rayOrigins(rayCount);
+    std::vector<glm::vec3> rayDirections(rayCount);
+    std::vector<glm::vec3> sunQueryLocations(rayCount);
+    for (std::size_t rayIndex = 0; rayIndex < rayCount; rayIndex++)
+    {
+        rayOrigins[rayIndex] =
+            glm::vec3(
+                unitDistribution(randomEngine),
+                unitDistribution(randomEngine),
+                unitDistribution(randomEngine)) *
+                worldSize -
+            glm::vec3(worldSizeHalf);
+        rayDirections[rayIndex] = glm::vec3(
+            directionDistribution(randomEngine),
+            directionDistribution(randomEngine),
+            directionDistribution(randomEngine));
+
+        const int x = columnXDistribution(randomEngine);
+        const int z = columnZDistribution(randomEngine);
+        sunQueryLocations[rayIndex] = glm::vec3(x, getSurfaceHeight(x, z), z) + 0.5F;
+    }
+
+    // Keeps the compiler from dropping the traces
+    std::size_t hitCount = 0;
+
+    const auto rayStartTime = std::chrono::high_resolution_clock::now();
+    for (std::size_t rayIndex = 0; rayIndex < rayCount; rayIndex++)
+    {
+        hitCount += traceRay(rayOrigins[rayIndex], rayDirections[rayIndex], maxDistance).bHasHit;
+    }
+    const auto sunStartTime = std::chrono::high_resolution_clock::now();
+    for (const auto& sunQueryLocation : sunQueryLocations)
+    {
+        hitCount += isSunVisible(sunQueryLocation, sunDirection);
+    }
+    const auto sunEndTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<VSRay> rays(rayCount);
+    for (std::size_t rayIndex = 0; rayIndex < rayCount; rayIndex++)
+    {
+        rays[rayIndex] = {rayOrigins[rayIndex], rayDirections[rayIndex], maxDistance};
+    }
+    std::vector<VSTraceResult> batchResults(rayCount);
+
+    const auto batchStartTime = std::chrono::high_resolution_clock::now();
+    traceRays(rays.data(), rayCount, batchResults.data());
+    const auto batchEndTime = std::chrono::high_resolution_clock::now();
+
+    const auto raySeconds = std::chrono::duration<float>(sunStartTime - rayStartTime).count();
+    const auto sunSeconds = std::chrono::duration<float>(sunEndTime - sunStartTime).count();
+    const auto batchSeconds = std::chrono::duration<float>(batchEndTime - batchStartTime).count();
+    result.raysPerSecond = static_cast<float>(rayCount) / glm::max(raySeconds, 1e-9F);
+    result.sunQueriesPerSecond = static_cast<float>(rayCount) / glm::max(sunSeconds, 1e-9F);
+    result.batchedRaysPerSecond = static_cast<float>(rayCount) / glm::max(batchSeconds, 1e-9F);
+
+    VSLog::Log(
+        VSLog::Category::Core,
+        VSLog::Level::info,
+        "Trace benchmark: {} rays, {} hit or sunlit",
+        rayCount,
+        hitCount);
+
+    return result;
+}
+
+void VSChunkManager::generateChunks(const VSChunkGenerator& generateChunk)
+{
+    assert(!bShouldReinitializeChunks);
+
+    // Running updates read the blocks that are replaced here. They belong to the main thread, so
+    // updateChunks cancels them on its next pass.
+    bShouldCancelChunkUpdates = true;
+
+    VSApp::getInstance()->getThreadPool()->parallelFor(
+        chunks.size(), [this, &generateChunk](std::size_t chunkIndex) {
+            auto* chunk = chunks[chunkIndex];
+            const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+            const auto chunkMin =
+                glm::ivec3(chunkCoordinates.x * chunkSize.x, 0, chunkCoordinates.y * chunkSize.z);
+
+            std::vector<VSBlockID> blocks(getChunkBlockCount(), VS_DEFAULT_BLOCK_ID);
+            generateChunk(chunkMin - worldSizeHalf, blocks);
+            assignChunkBlocks(chunk, blocks.data());
+
+            // Light is only spread from emitters, all other blocks of a new chunk are dark
+            for (std::size_t blockIndex = 0; blockIndex < blocks.size(); blockIndex++)
+            {
+                if (getBlockLightEmission(blocks[blockIndex]) != 0)
+                {
+                    pendingLightEdits.enqueue(
+                        chunkMin + blockIndexToBlockCoordinates(blockIndex));
+                }
+            }
+
+            chunk->bShouldRebuildNeighbourShadows = true;
+            chunk->bIsDirty = true;
+        });
+}
+
+std::uint32_t VSChunkManager::getWorldSeed() const
+{
+    return worldSeed;
+}
+
+void VSChunkManager::setWorldSeed(std::uint32_t newWorldSeed)
+{
+    worldSeed = newWorldSeed;
+}
+
+std::uint64_t VSChunkManager::computeBlockHash() const
+{
+    constexpr std::uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+    constexpr std::uint64_t fnvPrime = 1099511628211ULL;
+
+    std::vector<std::uint64_t> chunkHashes(chunks.size(), fnvOffsetBasis);
+    VSApp::getInstance()->getThreadPool()->parallelFor(
+        chunks.size(), [this, &chunkHashes](std::size_t chunkIndex) {
+            std::vector<VSBlockID> blocks(getChunkBlockCount());
+            copyChunkBlocks(chunks[chunkIndex], blocks.data());
+            for (const auto blockID : blocks)
+            {
+                chunkHashes[chunkIndex] = (chunkHashes[chunkIndex] ^ blockID) * fnvPrime;
+            }
+        });
+
+    auto hash = fnvOffsetBasis;
+    for (const auto chunkHash : chunkHashes)
+    {
+        for (int byte = 0; byte < 8; byte++)
+        {
+            hash = (hash ^ ((chunkHash >> (byte * 8)) & 0xFFU)) * fnvPrime;
+        }
+    }
+    return hash;
+}
+
+bool VSChunkManager::validateBrickCounts() const
+{
+    std::vector<VSBlockID> blocks(getChunkBlockCount());
+    std::vector<std::uint8_t> brickBlockCounts;
+    for (const auto* chunk : chunks)
+    {
+        copyChunkBlocks(chunk, blocks.data());
+
+        brickBlockCounts.assign(chunk->brickBlockCounts.size(), 0);
+        for (std::size_t blockIndex = 0; blockIndex < blocks.size(); blockIndex++)
+        {
+            if (blocks[blockIndex] != VS_DEFAULT_BLOCK_ID)
+            {
+                brickBlockCounts[blockCoordinatesToBrickIndex(
+                    blockIndexToBlockCoordinates(blockIndex))]++;
+            }
+        }
+
+        for (std::size_t brickIndex = 0; brickIndex < brickBlockCounts.size(); brickIndex++)
+        {
+            if (chunk->brickBlockCounts[brickIndex] != brickBlockCounts[brickIndex])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+VSChunkManager::VSVisibilityKernelComparison VSChunkManager::compareVisibilityKernels() const
+{
+    VSVisibilityKernelComparison comparison;
+    if (chunks.empty())
+    {
+        return comparison;
+    }
+
+    const auto chunkBlockCount = getChunkBlockCount();
+    std::vector<VSBlockID> blocks(chunkBlockCount);
+    std::vector<std::uint8_t> referenceBlockTypes(chunkBlockCount);
+    std::vector<std::uint8_t> scalarBlockTypes(chunkBlockCount);
+    std::vector<std::uint8_t> bitmaskBlockTypes(chunkBlockCount);
+    std::chrono::nanoseconds scalarTime(0);
+    std::chrono::nanoseconds bitmaskTime(0);
+
+    for (std::size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+    {
+        copyChunkBlocks(chunks[chunkIndex], blocks.data());
+
+        for (std::size_t blockIndex = 0; blockIndex < chunkBlockCount; blockIndex++)
+        {
+            referenceBlockTypes[blockIndex] = blocks[blockIndex] == VS_DEFAULT_BLOCK_ID
+                                                  ? 0
+                                                  : isBlockVisible(blocks, chunkIndex, blockIndex);
+        }
+
+        std::fill(scalarBlockTypes.begin(), scalarBlockTypes.end(), 0);
+        std::fill(bitmaskBlockTypes.begin(), bitmaskBlockTypes.end(), 0);
+
+        const auto scalarStartTime = std::chrono::high_resolution_clock::now();
+        computeBlockTypesScalar(chunkIndex, blocks, scalarBlockTypes);
+        const auto bitmaskStartTime = std::chrono::high_resolution_clock::now();
+        computeBlockTypesBitmask(chunkIndex, blocks, bitmaskBlockTypes);
+        const auto endTime = std::chrono::high_resolution_clock::now();
+
+        scalarTime += bitmaskStartTime - scalarStartTime;
+        bitmaskTime += endTime - bitmaskStartTime;
+        comparison.bDoKernelsMatchReference = comparison.bDoKernelsMatchReference &&
+                                              scalarBlockTypes == referenceBlockTypes &&
+                                              bitmaskBlockTypes == referenceBlockTypes;
+    }
+
+    const auto comparedChunkCount = static_cast<float>(chunks.size());
+    comparison.scalarMicroseconds =
+        std::chrono::duration<float, std::micro>(scalarTime).count() / comparedChunkCount;
+    comparison.bitmaskMicroseconds =
+        std::chrono::duration<float, std::micro>(bitmaskTime).count() / comparedChunkCount;
+    return comparison;
+}
+
+bool VSChunkManager::validateLightInformation(std::size_t chunkIndex) const
+{
+    const std::atomic<bool> bShouldCancel = false;
+    const auto sunLight = computeSunLight(bShouldCancel, chunkIndex);
+    const auto blockLight = copyBlockLight(chunkIndex);
+
+    const auto* chunk = chunks[chunkIndex];
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    const glm::ivec3 chunkOrigin(
+        chunkCoordinates.x * chunkSize.x, 0, chunkCoordinates.y * chunkSize.z);
+
+    VSLightSampleCache lightSampleCache;
+    lightSampleCache.origin = chunkOrigin - glm::ivec3(1);
+    lightSampleCache.size = chunkSize + glm::ivec3(2);
+    lightSampleCache.samples.assign(
+        lightSampleCache.size.x * lightSampleCache.size.y * lightSampleCache.size.z,
+        VSLightSampleCache::unset);
+
+    std::vector<VSBlockID> blocks(getChunkBlockCount());
+    copyChunkBlocks(chunk, blocks.data());
+
+    for (int z = 0; z < chunkSize.z; z++)
+    {
+        for (int y = 0; y < chunkSize.y; y++)
+        {
+            for (int x = 0; x < chunkSize.x; x++)
+            {
+                if (blocks[blockCoordinatesToBlockIndex({x, y, z})] == VS_DEFAULT_BLOCK_ID)
+                {
+                    continue;
+                }
+
+                const auto offset = chunk->chunkLocation + glm::vec3(x, y, z) + glm::vec3(0.5F) -
+                                    glm::vec3(chunkSize) / 2.F;
+                if (getCachedLightInformation(
+                        lightSampleCache,
+                        chunkOrigin + glm::ivec3(x, y, z),
+                        blockLight,
+                        &sunLight) != getLightInformation(offset, blockLight, &sunLight))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+VSChunkManager::VSDistanceFieldComparison VSChunkManager::validateDistanceField(
+    std::size_t chunkIndex) const
+{
+    const std::atomic<bool> bShouldCancel = false;
+    const auto visibilities = computeReferenceVisibilities(chunkIndex);
+
+    std::vector<VSBlockID> blocks(getChunkBlockCount());
+    copyChunkBlocks(chunks[chunkIndex], blocks.data());
+
+    std::vector<float> bruteForceDistanceField(getChunkBlockCount());
+    std::vector<float> transformDistanceField(getChunkBlockCount());
+    const auto bruteForceStartTime = std::chrono::high_resolution_clock::now();
+    computeDistanceFieldBruteForce(
+        bShouldCancel, chunkIndex, blocks, visibilities, bruteForceDistanceField);
+    const auto transformStartTime = std::chrono::high_resolution_clock::now();
+    computeDistanceFieldTransform(bShouldCancel, chunkIndex, transformDistanceField);
+    const auto endTime = std::chrono::high_resolution_clock::now();
+
+    VSDistanceFieldComparison comparison;
+    comparison.bruteForceMicroseconds =
+        std::chrono::duration<float, std::micro>(transformStartTime - bruteForceStartTime)
+            .count();
+    comparison.transformMicroseconds =
+        std::chrono::duration<float, std::micro>(endTime - transformStartTime).count();
+
+    // Same as chunkUpdateShadow, the reference only lists non-air blocks
+    for (const auto blockIndex : *visibilities.front().visibleBlockIndices)
+    {
+        bruteForceDistanceField[blockIndex] = 0.F;
+        transformDistanceField[blockIndex] = 0.F;
+    }
+
+    // Both compute square roots of the same integer squared distances
+    constexpr float maxDifference = 1e-5F;
+    for (std::size_t blockIndex = 0; blockIndex < bruteForceDistanceField.size(); blockIndex++)
+    {
+        if (glm::abs(bruteForceDistanceField[blockIndex] - transformDistanceField[blockIndex]) >
+            maxDifference)
+        {
+            comparison.bDoKernelsMatch = false;
+            break;
+        }
+    }
+    return comparison;
+}
+
+bool VSChunkManager::validateShadowRegions(
+    const std::vector<std::pair<glm::ivec3, VSBlockID>>& edits)
+{
+    const std::atomic<bool> bShouldCancel = false;
+    std::vector<std::vector<float>> distanceFields(chunks.size());
+    for (std::size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+    {
+        distanceFields[chunkIndex].resize(getChunkBlockCount());
+        computeDistanceFieldTransform(bShouldCancel, chunkIndex, distanceFields[chunkIndex]);
+    }
+
+    // The edits setBlock queues, without the ones before
+    dequeueShadowEdits();
+    for (const auto& [location, blockID] : edits)
+    {
+        setBlock(glm::vec3(location), blockID);
+    }
+
+    // Box by box on top of the old distances, as uploadShadowRegion writes them
+    for (const auto& editBox : groupShadowEdits(dequeueShadowEdits()))
+    {
+        const auto boxSize = editBox.boxMax - editBox.boxMin;
+        std::vector<float> boxDistanceField(boxSize.x * boxSize.y * boxSize.z);
+        computeDistanceFieldBox(bShouldCancel, editBox.boxMin, editBox.boxMax, boxDistanceField);
+        for (int z = editBox.boxMin.z; z < editBox.boxMax.z; z++)
+        {
+            for (int y = editBox.boxMin.y; y < editBox.boxMax.y; y++)
+            {
+                for (int x = editBox.boxMin.x; x < editBox.boxMax.x; x++)
+                {
+                    const glm::ivec3 chunkCoordinates(x / chunkSize.x, 0, z / chunkSize.z);
+                    const auto chunkIndex =
+                        chunkCoordinatesToChunkIndex({chunkCoordinates.x, chunkCoordinates.z});
+                    const auto blockIndex = blockCoordinatesToBlockIndex(
+                        glm::ivec3(x, y, z) - chunkCoordinates * chunkSize);
+                    const auto location = glm::ivec3(x, y, z) - editBox.boxMin;
+                    const auto boxIndex =
+                        location.x + location.y * boxSize.x + location.z * boxSize.x * boxSize.y;
+                    distanceFields[chunkIndex][blockIndex] = boxDistanceField[boxIndex];
+                }
+            }
+        }
+    }
+
+    // Both are exact, the distances have to be identical
+    std::vector<float> distanceField(getChunkBlockCount());
+    for (std::size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+    {
+        computeDistanceFieldTransform(bShouldCancel, chunkIndex, distanceField);
+        if (distanceField != distanceFields[chunkIndex])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+VSChunkManager::VSDrawPathComparison VSChunkManager::compareDrawPaths(
+    const glm::vec3& viewPos,
+    const glm::mat4& VP,
+    const glm::ivec2& framebufferSize)
+{
+    VSDrawPathComparison comparison;
+    if (!bHasRenderResources || GLAD_GL_VERSION_4_3 == 0)
+    {
+        comparison.bDoPathsMatch = false;
+        return comparison;
+    }
+
+    // updateVisibleBlocks without the thread pool, shadows are not drawn
+    const std::atomic<bool> bShouldCancel = false;
+    std::atomic<bool> bIsReady = false;
+    for (std::size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+    {
+        auto visibilityResult = chunkUpdateVisibility(
+            bShouldCancel,
+            bIsReady,
+            chunkIndex,
+            false,
+            bIsBitmaskVisibilityEnabled,
+            bIsSkyLightEnabled);
+        chunks[chunkIndex]->visibleBlockInfos = std::move(visibilityResult.visibleBlockInfos);
+        uploadVisibleBlockInfos(chunks[chunkIndex]);
+    }
+
+    for (std::size_t i = 1; i < faceCombinationCount; i++)
+    {
+        drawRanges[i].clear();
+        collectDrawRanges(i, chunks);
+    }
+    buildDrawCommands();
+
+    GLuint framebuffer = 0;
+    std::array<GLuint, 2> renderbuffers{};
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(2, renderbuffers.data());
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, framebufferSize.x, framebufferSize.y);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+    glRenderbufferStorage(
+        GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, framebufferSize.x, framebufferSize.y);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+    glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+
+    // The state VSApp sets up
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glEnable(GL_CULL_FACE);
+
+    glActiveTexture(GL_TEXTURE0 + spriteTextureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, spriteTexture);
+
+    // Textured and lit, so the block ids and light words of the instances show
+    chunkShader->uniforms()
+        .setVec3("lightDir", glm::normalize(glm::vec3(-0.4F, 0.7F, -0.6F)))
+        .setVec3("lightColor", glm::vec3(1.F))
+        .setVec3("viewPos", viewPos)
+        .setVec3("origin", origin)
+        .setVec3("colorOverride", colorOverride)
+        .setMat4("VP", VP)
+        .setUVec3("worldSize", getWorldSize())
+        .setInt("spriteTexture", spriteTextureID)
+        .setFloat("time", 0.F)
+        .setBool("enableShadows", false)
+        .setBool("enableAO", true);
+
+    const auto pixelByteCount = static_cast<std::size_t>(framebufferSize.x * framebufferSize.y * 4);
+    std::array<std::vector<std::uint8_t>, 2> pixels;
+    std::array<std::uint32_t, 2> drawCallCounts{};
+    for (std::size_t pathIndex = 0; pathIndex < pixels.size(); pathIndex++)
+    {
+        glClearColor(0.F, 0.F, 0.F, 0.F);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        drawCallCount = 0;
+        if (pathIndex == 0)
+        {
+            drawInstanced();
+        }
+        else
+        {
+            drawMultiIndirect();
+        }
+        drawCallCounts[pathIndex] = drawCallCount;
+
+        pixels[pathIndex].resize(pixelByteCount);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(
+            0,
+            0,
+            framebufferSize.x,
+            framebufferSize.y,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            pixels[pathIndex].data());
+    }
+    glBindVertexArray(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(2, renderbuffers.data());
+    glDeleteFramebuffers(1, &framebuffer);
+
+    comparison.bDoPathsMatch = pixels[0] == pixels[1];
+    comparison.instancedDrawCallCount = drawCallCounts[0];
+    comparison.multiIndirectDrawCallCount = drawCallCounts[1];
+    for (std::size_t pixelIndex = 0; pixelIndex < pixelByteCount; pixelIndex += 4)
+    {
+        // Everything the chunks drew is opaque
+        if (pixels[0][pixelIndex + 3] != 0)
+        {
+            comparison.coveredPixelCount++;
+        }
+    }
+    return comparison;
+}
+
+VSChunkManager::VSWorldData VSChunkManager::getData() const
+{
+    VSChunkManager::VSWorldData worldData{};
+
+    worldData.chunkSize = chunkSize;
+    worldData.chunkCount = getChunkCount();
+    worldData.seed = worldSeed;
+
+    // Write BlockIDs to vector
+    worldData.blocks = std::vector<VSBlockID>(getTotalBlockCount());
+
+    auto* chunkData = worldData.blocks.data();
+    for (const auto* chunk : chunks)
+    {
+        copyChunkBlocks(chunk, chunkData);
+        chunkData += getChunkBlockCount();
+    }
+
+    return worldData;
+}
+
+void VSChunkManager::initFromData(const VSWorldData& data)
+{
+    setChunkDimensions(data.chunkSize, data.chunkCount);
+    worldSeed = data.seed;
+    worldDataFromFile = data;
+    bShouldInitializeFromData = true;
+}
+
+void VSChunkManager::cancelChunkUpdates()
+{
+    for (auto& [chunk, shadowBuildTask] : activeShadowBuildTasks)
+    {
+        cancelShadowBuildTask(shadowBuildTask);
+    }
+    activeShadowBuildTasks.clear();
+
+    for (const auto& [chunk, visibilityBuildUpdate] : activeVisibilityBuildTasks)
+    {
+        visibilityBuildUpdate->cancel();
+    }
+    activeVisibilityBuildTasks.clear();
+
+    for (auto& shadowRegionUpdate : activeShadowRegionUpdates)
+    {
+        cancelShadowBuildTask(shadowRegionUpdate);
+    }
+    activeShadowRegionUpdates.clear();
+}
+
+void VSChunkManager::initializeChunks()
+{
+    bool expected = true;
+    if (bShouldReinitializeChunks.load() == expected)
+    {
+        chunkSize = newChunkSize;
+        chunkCount = newChunkCount;
+        worldSize = newWorldSize;
+        worldSizeHalf = newWorldSizeHalf;
+
+        cancelChunkUpdates();
+
+        glm::ivec3 droppedShadowEdit;
+        while (pendingShadowEdits.try_dequeue(droppedShadowEdit))
+        {
+        }
+        pendingShadowEditCount = 0;
+
+        // Queued light edits refer to the old chunks
+        glm::ivec3 droppedLightEdit;
+        while (pendingLightEdits.try_dequeue(droppedLightEdit))
+        {
+        }
+
+        for (auto* chunk : chunks)
+        {
+            deleteChunk(chunk);
+        }
+        chunks.clear();
+        chunks.resize(chunkCount.x * chunkCount.y);
+
+        loadStartTime = std::chrono::high_resolution_clock::now();
+        bIsWaitingForFirstVisibleFrame = true;
+        firstVisibleFrameMilliseconds = 0.F;
+
+        for (int y = 0; y < chunkCount.x; y++)
+        {
+            for (int x = 0; x < chunkCount.x; x++)
+            {
+                VSChunk* newChunk = createChunk();
+                newChunk->chunkLocation =
+                    glm::vec3(
+                        chunkSize.x * (static_cast<float>(x) + 0.5F),
+                        0.F,
+                        chunkSize.z * (static_cast<float>(y) + 0.5F)) -
+                    glm::vec3(chunkSize.x * chunkCount.x, 0.F, chunkSize.z * chunkCount.y) / 2.F;
+                chunks[y * chunkCount.x + x] = newChunk;
+            }
+        }
+
+        if (!bHasRenderResources)
+        {
+            bShouldReinitializeChunks.compare_exchange_weak(expected, false);
+            return;
+        }
+
+        glDeleteTextures(1, &shadowTexture);
+
+        glGenTextures(1, &shadowTexture);
+        glBindTexture(GL_TEXTURE_3D, shadowTexture);
+        // Level 0 is sampled linearly, level 1 is only read with texelFetch
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, 1);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_BORDER);
+        // Decodes to more than maxShadowDistance, nothing outside the world casts shadows
+        glm::vec4 borderColor(1.F);
+        glTexParameterfv(GL_TEXTURE_3D, GL_TEXTURE_BORDER_COLOR, &borderColor[0]);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        for (int level = 0; level <= 1; level++)
+        {
+            glTexImage3D(
+                GL_TEXTURE_3D,
+                level,
+                GL_R8,
+                worldSize.x >> level,
+                worldSize.y >> level,
+                worldSize.z >> level,
+                0,
+                GL_RED,
+                GL_UNSIGNED_BYTE,
+                nullptr);
+        }
+
+        // Enough slots for every shadow update in flight and the uploads the GPU still reads
+        shadowUploadRing = std::make_unique<VSPixelUploadRing>(
+            2 * getMaxActiveUpdateCount(), getShadowRegionByteCount(chunkSize));
+
+        bShouldReinitializeChunks.compare_exchange_weak(expected, false);
+    }
+}
+
+VSChunkManager::VSChunk* VSChunkManager::createChunk() const
+{
+    auto* chunk = new VSChunk();
+
+    chunk->sections = std::vector<VSBlockStorage>(getChunkSectionCount());
+    for (auto& section : chunk->sections)
+    {
+        section.resize(getSectionBlockCount(), VS_DEFAULT_BLOCK_ID);
+    }
+    chunk->visibleBlockIndices = std::make_shared<const VSChunk::VSVisibleBlockIndices>();
+    chunk->bShouldRebuildNeighbourShadows = true;
+    chunk->blockLight.resize(getChunkBlockCount(), 0);
+    chunk->heightmap = std::vector<std::atomic<std::int16_t>>(chunkSize.x * chunkSize.z);
+    for (auto& columnHeight : chunk->heightmap)
+    {
+        columnHeight = 0;
+    }
+    chunk->brickBlockCounts =
+        std::vector<std::atomic<std::uint8_t>>(glm::compMul(getChunkBrickCount()));
+    for (auto& brickBlockCount : chunk->brickBlockCounts)
+    {
+        brickBlockCount = 0;
+    }
+    chunk->sunLight = std::make_shared<const std::vector<std::uint8_t>>();
+    chunk->lightColor.resize(getChunkBlockCount(), {0.F, 0.F, 0.F});
+
+    return chunk;
+}
+
+void VSChunkManager::deleteChunk(VSChunk* chunk)
+{
+    if (bHasRenderResources)
+    {
+        freeVisibleBlockInfos(chunk);
+        glDeleteVertexArrays(1, &chunk->greedyVertexArray);
+        glDeleteBuffers(1, &chunk->greedyVertexBuffer);
+        glDeleteBuffers(1, &chunk->greedyIndexBuffer);
+    }
+    delete chunk;
+}
+
+void VSChunkManager::updateShadowRegions(bool bAreShadowsEnabled)
+{
+    const auto shadowEdits = dequeueShadowEdits();
+    if (!shadowEdits.empty())
+    {
+        lastShadowRegionBlockCount = 0;
+    }
+
+    for (const auto& editBox : groupShadowEdits(shadowEdits))
+    {
+        const auto boxMin = editBox.boxMin;
+        const auto boxMax = editBox.boxMax;
+        const auto boxSize = boxMax - boxMin;
+
+        const auto minChunk = boxMin / glm::ivec3(chunkSize.x, 1, chunkSize.z);
+        const auto maxChunk = (boxMax - 1) / glm::ivec3(chunkSize.x, 1, chunkSize.z);
+        const bool bIsIncremental =
+            bAreShadowsEnabled && boxSize.x * boxSize.y * boxSize.z <= maxShadowRegionVolume;
+        for (int chunkZ = minChunk.z; chunkZ <= maxChunk.z; chunkZ++)
+        {
+            for (int chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++)
+            {
+                auto* const chunk = chunks[chunkCoordinatesToChunkIndex({chunkX, chunkZ})];
+                if (!bIsIncremental)
+                {
+                    chunk->bShouldRebuildShadows = true;
+                }
+                else if (activeShadowBuildTasks.count(chunk) != 0)
+                {
+                    // A full update may have read the blocks before the edit and would
+                    // overwrite the box when it finishes
+                    cancelShadowBuildTask(activeShadowBuildTasks[chunk]);
+                    activeShadowBuildTasks.erase(chunk);
+                    chunk->bShouldRebuildShadows = true;
+                }
+            }
+        }
+
+        if (bIsIncremental)
+        {
+            lastShadowRegionBlockCount += boxSize.x * boxSize.y * boxSize.z;
+            VSShadowBuildTask shadowRegionUpdate;
+            auto* const uploadData =
+                acquireShadowUploadSlot(boxSize, shadowRegionUpdate.uploadSlot);
+            shadowRegionUpdate.update = VSShadwoChunkUpdate::create(
+                VSApp::getInstance()->getThreadPool(),
+                [this, boxMin, boxMax, uploadData](
+                    const std::atomic<bool>& bShouldCancel,
+                    std::atomic<bool>& bIsReady,
+                    std::size_t /*chunkIndex*/) {
+                    const auto boxSize = boxMax - boxMin;
+                    std::vector<float> distanceField(boxSize.x * boxSize.y * boxSize.z);
+                    if (!computeDistanceFieldBox(bShouldCancel, boxMin, boxMax, distanceField))
+                    {
+                        return VSShadowRegionResult{};
+                    }
+                    auto result = packShadowRegion(boxMin, boxSize, distanceField, uploadData);
+                    bIsReady = true;
+                    return result;
+                },
+                chunkCoordinatesToChunkIndex({minChunk.x, minChunk.z}));
+            activeShadowRegionUpdates.push_back(std::move(shadowRegionUpdate));
+        }
+    }
+
+    // Upload in submission order, a later box may overlap an earlier one with newer blocks
+    while (!activeShadowRegionUpdates.empty() &&
+           activeShadowRegionUpdates.front().update->isReady())
+    {
+        uploadShadowRegion(activeShadowRegionUpdates.front());
+        activeShadowRegionUpdates.pop_front();
+    }
+}
+
+std::vector<glm::ivec3> VSChunkManager::dequeueShadowEdits()
+{
+    std::vector<glm::ivec3> shadowEdits(pendingShadowEdits.size_approx());
+    shadowEdits.resize(
+        pendingShadowEdits.try_dequeue_bulk(shadowEdits.begin(), shadowEdits.size()));
+    pendingShadowEditCount -= shadowEdits.size();
+    return shadowEdits;
+}
+
+std::vector<VSChunkManager::VSShadowEditBox> VSChunkManager::groupShadowEdits(
+    const std::vector<glm::ivec3>& edits) const
+{
+    // Boxes of edits further apart than this do not overlap
+    const glm::ivec3 maxGap(2 * maxShadowDistance);
+    const auto areClose = [&maxGap](const VSShadowEditBox& first, const VSShadowEditBox& second) {
+        return glm::all(glm::lessThanEqual(first.boxMin - maxGap, second.boxMax)) &&
+               glm::all(glm::lessThanEqual(second.boxMin - maxGap, first.boxMax));
+    };
+
+    // Bounds of the edits of each group first, editor strokes usually end up in one
+    std::vector<VSShadowEditBox> groups;
+    for (const auto& edit : edits)
+    {
+        const VSShadowEditBox editBox = {edit, edit};
+        const auto group = std::find_if(groups.begin(), groups.end(), [&](const auto& other) {
+            return areClose(other, editBox);
+        });
+        if (group == groups.end())
+        {
+            groups.push_back(editBox);
+        }
+        else
+        {
+            group->boxMin = glm::min(group->boxMin, edit);
+            group->boxMax = glm::max(group->boxMax, edit);
+        }
+    }
+
+    // A grown group can reach another one
+    bool bHasMerged = true;
+    while (bHasMerged)
+    {
+        bHasMerged = false;
+        for (std::size_t first = 0; first < groups.size() && !bHasMerged; first++)
+        {
+            for (std::size_t second = first + 1; second < groups.size(); second++)
+            {
+                if (areClose(groups[first], groups[second]))
+                {
+                    groups[first].boxMin = glm::min(groups[first].boxMin, groups[second].boxMin);
+                    groups[first].boxMax = glm::max(groups[first].boxMax, groups[second].boxMax);
+                    groups.erase(groups.begin() + second);
+                    bHasMerged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Clamped distances only change closer than maxShadowDistance to an edit or to a neighbour
+    // whose visibility it changed. The box is widened to whole cells of the coarse mip level.
+    const glm::ivec3 reach(maxShadowDistance);
+    for (auto& group : groups)
+    {
+        group.boxMin = (glm::max(group.boxMin - reach, glm::ivec3(0)) / 2) * 2;
+        group.boxMax = glm::min(((group.boxMax + reach + 2) / 2) * 2, worldSize);
+    }
+    return groups;
+}
+
+void VSChunkManager::updateShadows(std::size_t chunkIndex)
+{
+    auto* const chunk = chunks[chunkIndex];
+    bool expectedShadows = true;
+    // check if dirty after checking for shadows to avoid race conditions
+    // only keep a few updates per pool thread in flight
+    if (activeShadowBuildTasks.size() < getMaxActiveUpdateCount() &&
+        chunk->bShouldRebuildShadows.compare_exchange_weak(expectedShadows, false))
+    {
+        if (activeShadowBuildTasks.count(chunk) != 0)
+        {
+            cancelShadowBuildTask(activeShadowBuildTasks[chunk]);
+            activeShadowBuildTasks.erase(chunk);
+        }
+
+        // TODO this wont work anymore if the terrain becomes more complex
+        // overhangs or floating stuff will cause issues
+        const std::int32_t chunkRadius =
+            1;  // glm::min(1, 128 / static_cast<int>(glm::sqrt(chunkSize.x * chunkSize.x +
+        // chunkSize.z * chunkSize.z)));
+
+        // Take the visibility lists here, they are only replaced on this thread
+        const auto chunkCoords = chunkIndexToChunkCoordinates(chunkIndex);
+        std::vector<VSChunkVisibilitySnapshot> neighbourVisibilities;
+        for (int x = glm::max(chunkCoords.x - chunkRadius, 0);
+             x <= glm::min(chunkCoords.x + chunkRadius, chunkCount.x - 1);
+             x++)
+        {
+            for (int y = glm::max(chunkCoords.y - chunkRadius, 0);
+                 y <= glm::min(chunkCoords.y + chunkRadius, chunkCount.y - 1);
+                 y++)
+            {
+                const auto* neighbourChunk = chunks[chunkCoordinatesToChunkIndex({x, y})];
+                neighbourVisibilities.push_back(
+                    {neighbourChunk->chunkLocation, neighbourChunk->visibleBlockIndices});
+            }
+        }
+
+        VSShadowBuildTask shadowTask;
+        auto* const uploadData = acquireShadowUploadSlot(chunkSize, shadowTask.uploadSlot);
+        shadowTask.update = VSShadwoChunkUpdate::create(
+            VSApp::getInstance()->getThreadPool(),
+            [this,
+             chunkVisibility =
+                 VSChunkVisibilitySnapshot{chunk->chunkLocation, chunk->visibleBlockIndices},
+             neighbourVisibilities = std::move(neighbourVisibilities),
+             bShouldUseDistanceTransform = bIsDistanceTransformEnabled,
+             uploadData](
+                const std::atomic<bool>& bShouldCancel,
+                std::atomic<bool>& bIsReady,
+                std::size_t chunkIndex) {
+                return this->chunkUpdateShadow(
+                    bShouldCancel,
+                    bIsReady,
+                    chunkIndex,
+                    chunkVisibility,
+                    neighbourVisibilities,
+                    bShouldUseDistanceTransform,
+                    uploadData);
+            },
+            chunkIndex);
+
+        activeShadowBuildTasks.emplace(chunk, std::move(shadowTask));
+    }
+
+    if (activeShadowBuildTasks.count(chunk) != 0)
+    {
+        // Finished updates over the budget keep their place until a later frame
+        auto& shadowTask = activeShadowBuildTasks[chunk];
+        if (shadowTask.update->isReady() && hasShadowUploadBudget(chunkSize))
+        {
+            uploadShadowRegion(shadowTask);
+            activeShadowBuildTasks.erase(chunk);
+        }
+    }
+}
+
+std::size_t VSChunkManager::getShadowRegionByteCount(const glm::ivec3& boxSize)
+{
+    const auto blockCount = static_cast<std::size_t>(boxSize.x * boxSize.y * boxSize.z);
+    return blockCount + blockCount / 8;
+}
+
+std::uint8_t* VSChunkManager::acquireShadowUploadSlot(const glm::ivec3& boxSize, int& outSlot)
+{
+    outSlot = VSPixelUploadRing::invalidSlot;
+    if (shadowUploadRing == nullptr ||
+        getShadowRegionByteCount(boxSize) > shadowUploadRing->getSlotSize())
+    {
+        return nullptr;
+    }
+
+    outSlot = shadowUploadRing->acquire();
+    return outSlot != VSPixelUploadRing::invalidSlot ? shadowUploadRing->getSlotData(outSlot)
+                                                     : nullptr;
+}
+
+void VSChunkManager::cancelShadowBuildTask(VSShadowBuildTask& task)
+{
+    // cancel waits for a running worker, nothing writes to the slot afterwards
+    task.update->cancel();
+    if (task.uploadSlot != VSPixelUploadRing::invalidSlot)
+    {
+        shadowUploadRing->discard(task.uploadSlot);
+        task.uploadSlot = VSPixelUploadRing::invalidSlot;
+    }
+}
+
+bool VSChunkManager::hasShadowUploadBudget(const glm::ivec3& boxSize) const
+{
+    return shadowUploadByteCount == 0 ||
+           shadowUploadByteCount + getShadowRegionByteCount(boxSize) <=
+               maxShadowUploadBytesPerFrame;
+}
+
+VSChunkManager::VSShadowRegionResult VSChunkManager::packShadowRegion(
+    const glm::ivec3& boxMin,
+    const glm::ivec3& boxSize,
+    const std::vector<float>& distanceField,
+    std::uint8_t* uploadData)
+{
+    constexpr int maxStep = maxShadowDistance * shadowDistanceStepsPerBlock + shadowDistanceZero;
+
+    VSShadowRegionResult region;
+    region.boxMin = boxMin;
+    region.boxSize = boxSize;
+    auto* distances = uploadData;
+    if (distances == nullptr)
+    {
+        region.distances.resize(getShadowRegionByteCount(boxSize));
+        distances = region.distances.data();
+    }
+    auto* const coarseDistances = distances + distanceField.size();
+
+    for (std::size_t i = 0; i < distanceField.size(); i++)
+    {
+        // Rounded down, the ray march must not step past a surface
+        const auto step = static_cast<int>(glm::floor(
+            distanceField[i] * static_cast<float>(shadowDistanceStepsPerBlock) +
+            static_cast<float>(shadowDistanceZero)));
+        distances[i] = static_cast<std::uint8_t>(glm::clamp(step, 0, maxStep));
+    }
+
+    const auto coarseSize = boxSize / 2;
+    for (int z = 0; z < coarseSize.z; z++)
+    {
+        for (int y = 0; y < coarseSize.y; y++)
+        {
+            for (int x = 0; x < coarseSize.x; x++)
+            {
+                int cellMin = maxStep;
+                for (int cellZ = 0; cellZ < 2; cellZ++)
+                {
+                    for (int cellY = 0; cellY < 2; cellY++)
+                    {
+                        for (int cellX = 0; cellX < 2; cellX++)
+                        {
+                            cellMin = glm::min(
+                                cellMin,
+                                static_cast<int>(
+                                    distances
+                                        [(x * 2 + cellX) + (y * 2 + cellY) * boxSize.x +
+                                         (z * 2 + cellZ) * boxSize.x * boxSize.y]));
+                        }
+                    }
+                }
+
+                // Cells without any block within maxShadowDistance stay clamped
+                coarseDistances[x + y * coarseSize.x + z * coarseSize.x * coarseSize.y] =
+                    static_cast<std::uint8_t>(
+                        cellMin == maxStep ? maxStep
+                                           : glm::max(cellMin - shadowCoarseReachSteps, 0));
+            }
+        }
+    }
+
+    return region;
+}
+
+void VSChunkManager::uploadShadowRegion(VSShadowBuildTask& task)
+{
+    const auto region = task.update->getResult();
+    const auto blockCount = static_cast<std::size_t>(
+        region.boxSize.x * region.boxSize.y * region.boxSize.z);
+
+    // With a slot the pixel pointers are offsets into the bound unpack buffer
+    const std::uint8_t* distances = region.distances.data();
+    if (task.uploadSlot != VSPixelUploadRing::invalidSlot)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, shadowUploadRing->getBuffer());
+        distances = reinterpret_cast<const std::uint8_t*>(
+            shadowUploadRing->getSlotOffset(task.uploadSlot));
+    }
+
+    glBindTexture(GL_TEXTURE_3D, shadowTexture);
+    // Rows of one byte texels are not 4 byte aligned for every box
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(
+        GL_TEXTURE_3D,
+        0,
+        region.boxMin.x,
+        region.boxMin.y,
+        region.boxMin.z,
+        region.boxSize.x,
+        region.boxSize.y,
+        region.boxSize.z,
+        GL_RED,
+        GL_UNSIGNED_BYTE,
+        distances);
+    glTexSubImage3D(
+        GL_TEXTURE_3D,
+        1,
+        region.boxMin.x / 2,
+        region.boxMin.y / 2,
+        region.boxMin.z / 2,
+        region.boxSize.x / 2,
+        region.boxSize.y / 2,
+        region.boxSize.z / 2,
+        GL_RED,
+        GL_UNSIGNED_BYTE,
+        distances + blockCount);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (task.uploadSlot != VSPixelUploadRing::invalidSlot)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        shadowUploadRing->release(task.uploadSlot);
+        task.uploadSlot = VSPixelUploadRing::invalidSlot;
+    }
+
+    shadowUploadByteCount += getShadowRegionByteCount(region.boxSize);
+}
+
+VSChunkManager::VSShadowRegionResult VSChunkManager::chunkUpdateShadow(
+    const std::atomic<bool>& bShouldCancel,
+    std::atomic<bool>& bIsReady,
+    std::size_t chunkIndex,
+    const VSChunkVisibilitySnapshot& chunkVisibility,
+    const std::vector<VSChunkVisibilitySnapshot>& neighbourVisibilities,
+    bool bShouldUseDistanceTransform,
+    std::uint8_t* uploadData) const
+{
+    auto* const chunk = chunks[chunkIndex];
+
+    std::vector<VSBlockID> blocks(getChunkBlockCount());
+    copyChunkBlocks(chunk, blocks.data());
+
+    std::vector<float> chunkDistanceField;
+    chunkDistanceField.resize(getChunkBlockCount());
+
+    const auto kernelStart = std::chrono::high_resolution_clock::now();
+    const bool bIsComplete =
+        bShouldUseDistanceTransform
+            ? computeDistanceFieldTransform(bShouldCancel, chunkIndex, chunkDistanceField)
+            : computeDistanceFieldBruteForce(
+                  bShouldCancel, chunkIndex, blocks, neighbourVisibilities, chunkDistanceField);
+    if (!bIsComplete)
+    {
+        return {};
+    }
+    shadowKernelNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::high_resolution_clock::now() - kernelStart)
+                                   .count();
+    shadowKernelRunCount++;
+
+    // Only visible blocks sit on the surface
+    for (const auto blockIndex : *chunkVisibility.visibleBlockIndices)
+    {
+        if (blocks[blockIndex] != VS_DEFAULT_BLOCK_ID)
+        {
+            chunkDistanceField[blockIndex] = 0.F;
+        }
+    }
+
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    auto region = packShadowRegion(
+        glm::ivec3(chunkCoordinates.x * chunkSize.x, 0, chunkCoordinates.y * chunkSize.z),
+        chunkSize,
+        chunkDistanceField,
+        uploadData);
+
+    bIsReady = true;
+
+    return region;
+}
+
+bool VSChunkManager::computeDistanceFieldBruteForce(
+    const std::atomic<bool>& bShouldCancel,
+    std::size_t chunkIndex,
+    const std::vector<VSBlockID>& blocks,
+    const std::vector<VSChunkVisibilitySnapshot>& neighbourVisibilities,
+    std::vector<float>& outDistanceField) const
+{
+    std::vector<glm::vec3> relevantVisibleBlocks;
+
+    for (const auto& neighbourVisibility : neighbourVisibilities)
+    {
+        // abort calculations if canceled
+        if (bShouldCancel)
+        {
+            return false;
+        }
+
+        const auto neighbourToWorld = neighbourVisibility.chunkLocation + glm::vec3(0.5F) -
+                                      glm::vec3(chunkSize) / 2.F;
+        for (const auto blockIndex : *neighbourVisibility.visibleBlockIndices)
+        {
+            relevantVisibleBlocks.push_back(
+                neighbourToWorld + glm::vec3(blockIndexToBlockCoordinates(blockIndex)));
+        }
+    }
+
+    auto* const chunk = chunks[chunkIndex];
+
+    const auto chunkToWorld = chunk->chunkLocation + glm::vec3(0.5F) - glm::vec3(chunkSize) / 2.F;
+
+    for (std::size_t sectionIndex = 0; sectionIndex < chunk->sections.size(); sectionIndex++)
+    {
+        const auto& section = chunk->sections[sectionIndex];
+        const int sectionBegin = sectionIndex * sectionHeight;
+        const int sectionEnd = glm::min(sectionBegin + sectionHeight, chunkSize.y);
+
+        // Solid sections contain no air, visible blocks are set by chunkUpdateShadow
+        if (section.isUniform() && !section.isFilledWith(VS_DEFAULT_BLOCK_ID))
+        {
+            for (int z = 0; z < chunkSize.z; z++)
+            {
+                // All rows of a section at one z are contiguous
+                const auto sectionBlocks = outDistanceField.begin() +
+                                           blockCoordinatesToBlockIndex({0, sectionBegin, z});
+                const auto sectionRowBlockCount = (sectionEnd - sectionBegin) * chunkSize.x;
+                std::fill(sectionBlocks, sectionBlocks + sectionRowBlockCount, -0.5F);
+            }
+            continue;
+        }
+
+        for (int z = 0; z < chunkSize.z; z++)
+        {
+            for (int y = sectionBegin; y < sectionEnd; y++)
+            {
+                // abort calculations if canceled
+                if (bShouldCancel)
+                {
+                    return false;
+                }
+
+                for (int x = 0; x < chunkSize.x; x++)
+                {
+                    const auto blockIndex = blockCoordinatesToBlockIndex({x, y, z});
+                    glm::vec3 samplePos = chunkToWorld + glm::vec3(x, y, z);
+
+                    float distance = std::numeric_limits<float>::max();
+
+                    if (blocks[blockIndex] != VS_DEFAULT_BLOCK_ID)
+                    {
+                        distance = -0.5F;
+                    }
+                    else
+                    {
+                        for (const auto& blockCandidate : relevantVisibleBlocks)
+                        {
+                            distance =
+                                glm::min(distance, glm::length2(samplePos - blockCandidate));
+                        }
+                        distance = glm::min(
+                            glm::sqrt(distance), static_cast<float>(maxShadowDistance));
+                    }
+
+                    outDistanceField[blockIndex] = distance;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+std::vector<VSChunkManager::VSChunkVisibilitySnapshot> VSChunkManager::
+    computeReferenceVisibilities(std::size_t chunkIndex) const
+{
+    // The neighbours of updateShadows
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    std::vector<std::size_t> chunkIndices = {chunkIndex};
+    for (int x = glm::max(chunkCoordinates.x - 1, 0);
+         x <= glm::min(chunkCoordinates.x + 1, chunkCount.x - 1);
+         x++)
+    {
+        for (int y = glm::max(chunkCoordinates.y - 1, 0);
+             y <= glm::min(chunkCoordinates.y + 1, chunkCount.y - 1);
+             y++)
+        {
+            if (glm::ivec2(x, y) != chunkCoordinates)
+            {
+                chunkIndices.push_back(chunkCoordinatesToChunkIndex({x, y}));
+            }
+        }
+    }
+
+    std::vector<VSChunkVisibilitySnapshot> visibilities;
+    std::vector<VSBlockID> blocks(getChunkBlockCount());
+    for (const auto otherChunkIndex : chunkIndices)
+    {
+        copyChunkBlocks(chunks[otherChunkIndex], blocks.data());
+
+        VSChunk::VSVisibleBlockIndices visibleBlockIndices;
+        for (std::size_t blockIndex = 0; blockIndex < blocks.size(); blockIndex++)
+        {
+            if (blocks[blockIndex] != VS_DEFAULT_BLOCK_ID &&
+                isBlockVisible(blocks, otherChunkIndex, blockIndex) != 0)
+            {
+                visibleBlockIndices.push_back(blockIndex);
+            }
+        }
+        visibilities.push_back(
+            {chunks[otherChunkIndex]->chunkLocation,
+             std::make_shared<const VSChunk::VSVisibleBlockIndices>(
+                 std::move(visibleBlockIndices))});
+    }
+    return visibilities;
+}
+
+bool VSChunkManager::computeDistanceFieldTransform(
+    const std::atomic<bool>& bShouldCancel,
+    std::size_t chunkIndex,
+    std::vector<float>& outDistanceField) const
+{
+    // The box layout of a chunk matches its block indices
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    const glm::ivec3 chunkOrigin(
+        chunkCoordinates.x * chunkSize.x, 0, chunkCoordinates.y * chunkSize.z);
+    return computeDistanceFieldBox(
+        bShouldCancel, chunkOrigin, chunkOrigin + chunkSize, outDistanceField);
+}
+
+bool VSChunkManager::computeDistanceFieldBox(
+    const std::atomic<bool>& bShouldCancel,
+    const glm::ivec3& boxMin,
+    const glm::ivec3& boxMax,
+    std::vector<float>& outDistanceField) const
+{
+    // Blocks further away than maxShadowDistance do not change the clamped distances
+    const glm::ivec3 border(maxShadowDistance);
+    const auto regionMin = glm::max(boxMin - border, glm::ivec3(0));
+    const auto regionMax = glm::min(boxMax + border, worldSize);
+    const auto regionSize = regionMax - regionMin;
+
+    const auto regionIndex = [&regionSize](int x, int y, int z) {
+        return x + y * regionSize.x + z * regionSize.x * regionSize.y;
+    };
+
+    std::vector<std::uint8_t> solidBlocks(regionSize.x * regionSize.y * regionSize.z, 0);
+    std::vector<VSBlockID> chunkBlocks(getChunkBlockCount());
+    const auto minChunk = regionMin / glm::ivec3(chunkSize.x, 1, chunkSize.z);
+    const auto maxChunk = (regionMax - 1) / glm::ivec3(chunkSize.x, 1, chunkSize.z);
+    for (int chunkZ = minChunk.z; chunkZ <= maxChunk.z; chunkZ++)
+    {
+        for (int chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++)
+        {
+            if (bShouldCancel)
+            {
+                return false;
+            }
+
+            copyChunkBlocks(
+                chunks[chunkCoordinatesToChunkIndex({chunkX, chunkZ})], chunkBlocks.data());
+
+            const glm::ivec3 otherOrigin(chunkX * chunkSize.x, 0, chunkZ * chunkSize.z);
+            const auto overlapMin = glm::max(regionMin, otherOrigin);
+            const auto overlapMax = glm::min(regionMax, otherOrigin + chunkSize);
+            for (int z = overlapMin.z; z < overlapMax.z; z++)
+            {
+                for (int y = overlapMin.y; y < overlapMax.y; y++)
+                {
+                    for (int x = overlapMin.x; x < overlapMax.x; x++)
+                    {
+                        const auto blockIndex = blockCoordinatesToBlockIndex(
+                            glm::ivec3(x, y, z) - otherOrigin);
+                        if (chunkBlocks[blockIndex] != VS_DEFAULT_BLOCK_ID)
+                        {
+                            solidBlocks[regionIndex(
+                                x - regionMin.x, y - regionMin.y, z - regionMin.z)] = 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Squared distance to the nearest visible block, infinity until a pass finds one.
+    // Visible follows isBlockVisible: a block at the world border only if the block above it is
+    // air, any other one if one of its neighbours is air. Neighbours outside the region are
+    // maxShadowDistance away from the box and cannot change its clamped distances.
+    std::vector<float> squaredDistances(
+        solidBlocks.size(), std::numeric_limits<float>::infinity());
+    const auto worldMax = worldSize - 1;
+    for (int z = 0; z < regionSize.z; z++)
+    {
+        for (int y = 0; y < regionSize.y; y++)
+        {
+            for (int x = 0; x < regionSize.x; x++)
+            {
+                const glm::ivec3 location(x, y, z);
+                if (solidBlocks[regionIndex(x, y, z)] == 0)
+                {
+                    continue;
+                }
+
+                const auto blockCoordinates = regionMin + location;
+                bool bIsVisible = false;
+                if (glm::any(glm::equal(blockCoordinates, glm::ivec3(0))) ||
+                    glm::any(glm::equal(blockCoordinates, worldMax)))
+                {
+                    bIsVisible = y + 1 < regionSize.y && solidBlocks[regionIndex(x, y + 1, z)] == 0;
+                }
+                else
+                {
+                    for (const auto& offset : blockLightNeighbourOffsets)
+                    {
+                        const auto neighbour = location + offset;
+                        if (glm::all(glm::greaterThanEqual(neighbour, glm::ivec3(0))) &&
+                            glm::all(glm::lessThan(neighbour, regionSize)) &&
+                            solidBlocks[regionIndex(neighbour.x, neighbour.y, neighbour.z)] == 0)
+                        {
+                            bIsVisible = true;
+                            break;
+                        }
+                    }
+                }
+
+                if (bIsVisible)
+                {
+                    squaredDistances[regionIndex(x, y, z)] = 0.F;
+                }
+            }
+        }
+    }
+
+    const auto boxSize = boxMax - boxMin;
+    const auto boxOffset = boxMin - regionMin;
+    const auto boxIndex = [&boxSize](int x, int y, int z) {
+        return x + y * boxSize.x + z * boxSize.x * boxSize.y;
+    };
+
+    // Separable: the 3D transform is a 1D transform along x, then y, then z
+    VSDistanceTransformScratch scratch;
+    scratch.resize(glm::max(regionSize.x, glm::max(regionSize.y, regionSize.z)));
+    for (int z = 0; z < regionSize.z; z++)
+    {
+        for (int y = 0; y < regionSize.y; y++)
+        {
+            distanceTransformLine(
+                &squaredDistances[regionIndex(0, y, z)], regionSize.x, 1, scratch);
+        }
+    }
+    if (bShouldCancel)
+    {
+        return false;
+    }
+    for (int z = 0; z < regionSize.z; z++)
+    {
+        for (int x = 0; x < regionSize.x; x++)
+        {
+            distanceTransformLine(
+                &squaredDistances[regionIndex(x, 0, z)], regionSize.y, regionSize.x, scratch);
+        }
+    }
+    if (bShouldCancel)
+    {
+        return false;
+    }
+    // Only the columns of the box are needed after the last pass
+    for (int y = 0; y < regionSize.y; y++)
+    {
+        for (int x = boxOffset.x; x < boxOffset.x + boxSize.x; x++)
+        {
+            distanceTransformLine(
+                &squaredDistances[regionIndex(x, y, 0)],
+                regionSize.z,
+                regionSize.x * regionSize.y,
+                scratch);
+        }
+    }
+
+    constexpr auto maxDistance = static_cast<float>(maxShadowDistance);
+    for (int z = 0; z < boxSize.z; z++)
+    {
+        for (int y = 0; y < boxSize.y; y++)
+        {
+            for (int x = 0; x < boxSize.x; x++)
+            {
+                const auto location = boxOffset + glm::ivec3(x, y, z);
+                const auto blockIndex = regionIndex(location.x, location.y, location.z);
+                if (solidBlocks[blockIndex] != 0)
+                {
+                    // Surface blocks are 0, hidden ones inside the terrain
+                    outDistanceField[boxIndex(x, y, z)] =
+                        squaredDistances[blockIndex] == 0.F ? 0.F : -0.5F;
+                }
+                else
+                {
+                    // also clamps the infinity of regions without any visible block
+                    outDistanceField[boxIndex(x, y, z)] =
+                        glm::min(glm::sqrt(squaredDistances[blockIndex]), maxDistance);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void VSChunkManager::VSDistanceTransformScratch::resize(int count)
+{
+    values.resize(count);
+    parabolaVertices.resize(count);
+    parabolaBoundaries.resize(count + 1);
+}
+
+void VSChunkManager::distanceTransformLine(
+    float* squaredDistances,
+    int count,
+    int stride,
+    VSDistanceTransformScratch& scratch)
+{
+    // Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled Functions": the result is
+    // the lower envelope of the parabolas (q - v)^2 + f(v) rooted at every sample v.
+    // All inputs are integers far below 2^24, so the floats stay exact.
+    auto& values = scratch.values;
+    auto& vertices = scratch.parabolaVertices;
+    auto& boundaries = scratch.parabolaBoundaries;
+    for (int q = 0; q < count; q++)
+    {
+        values[q] = squaredDistances[q * stride];
+    }
+
+    // Samples without a finite value do not contribute a parabola
+    int envelopeEnd = -1;
+    for (int q = 0; q < count; q++)
+    {
+        if (values[q] == std::numeric_limits<float>::infinity())
+        {
+            continue;
+        }
+
+        float boundary = -std::numeric_limits<float>::infinity();
+        while (envelopeEnd >= 0)
+        {
+            const int v = vertices[envelopeEnd];
+            boundary = ((values[q] + static_cast<float>(q * q)) -
+                        (values[v] + static_cast<float>(v * v))) /
+                       static_cast<float>(2 * (q - v));
+            if (boundary > boundaries[envelopeEnd])
+            {
+                break;
+            }
+            envelopeEnd--;
+            boundary = -std::numeric_limits<float>::infinity();
+        }
+
+        envelopeEnd++;
+        vertices[envelopeEnd] = q;
+        boundaries[envelopeEnd] = boundary;
+    }
+
+    if (envelopeEnd < 0)
+    {
+        return;
+    }
+    boundaries[envelopeEnd + 1] = std::numeric_limits<float>::infinity();
+
+    int parabola = 0;
+    for (int q = 0; q < count; q++)
+    {
+        while (boundaries[parabola + 1] < static_cast<float>(q))
+        {
+            parabola++;
+        }
+        const int v = vertices[parabola];
+        squaredDistances[q * stride] = static_cast<float>((q - v) * (q - v)) + values[v];
+    }
+}
+
+void VSChunkManager::updateVisibleBlocks(std::size_t chunkIndex)
+{
+    auto* const chunk = chunks[chunkIndex];
+    bool bIsDirtyExpected = true;
+    // check if dirty after checking for shadows to avoid race conditions
+    // only keep a few updates per pool thread in flight
+    if (activeVisibilityBuildTasks.size() < getMaxActiveUpdateCount() &&
+        chunk->bIsDirty.compare_exchange_weak(bIsDirtyExpected, false))
+    {
+        if (activeVisibilityBuildTasks.count(chunk) != 0)
+        {
+            activeVisibilityBuildTasks[chunk]->cancel();
+            activeVisibilityBuildTasks.erase(chunk);
+        }
+
+        const auto visibilityUpdate = VSVisibilityChunkUpdate::create(
+            VSApp::getInstance()->getThreadPool(),
+            [this,
+             bShouldBuildGreedyMesh = bIsGreedyMeshingEnabled,
+             bShouldUseBitmaskKernel = bIsBitmaskVisibilityEnabled,
+             bShouldComputeSkyLight = bIsSkyLightEnabled](
+                const std::atomic<bool>& bShouldCancel,
+                std::atomic<bool>& bIsReady,
+                std::size_t chunkIndex) {
+                return this->chunkUpdateVisibility(
+                    bShouldCancel,
+                    bIsReady,
+                    chunkIndex,
+                    bShouldBuildGreedyMesh,
+                    bShouldUseBitmaskKernel,
+                    bShouldComputeSkyLight);
+            },
+            chunkIndex);
+
+        activeVisibilityBuildTasks.emplace(chunk, visibilityUpdate);
+    }
+
+    if (activeVisibilityBuildTasks.count(chunk) != 0)
+    {
+        const auto visiblityTask = activeVisibilityBuildTasks[chunk];
+        if (visiblityTask->isReady())
+        {
+            auto visibilityResult = visiblityTask->getResult();
+            chunk->visibleBlockInfos = std::move(visibilityResult.visibleBlockInfos);
+            chunk->visibleBlockIndices = std::make_shared<const VSChunk::VSVisibleBlockIndices>(
+                std::move(visibilityResult.visibleBlockIndices));
+            std::atomic_store(
+                &chunk->sunLight,
+                std::make_shared<const std::vector<std::uint8_t>>(
+                    std::move(visibilityResult.sunLight)));
+            activeVisibilityBuildTasks.erase(chunk);
+
+            uploadVisibleBlockInfos(chunk);
+            uploadGreedyMesh(chunk, visibilityResult.greedyMesh);
+
+            // update shadows for us and neighbours, small edits are handled by
+            // updateShadowRegions instead
+            // TODO duplicate code (see updateShadows)
+            if (chunk->bShouldRebuildNeighbourShadows.exchange(false))
+            {
+                const auto chunkCoords = chunkIndexToChunkCoordinates(chunkIndex);
+                const std::int32_t chunkRadius = 1;
+                for (int x = glm::max(chunkCoords.x - chunkRadius, 0);
+                     x <= glm::min(chunkCoords.x + chunkRadius, chunkCount.x - 1);
+                     x++)
+                {
+                    for (int y = glm::max(chunkCoords.y - chunkRadius, 0);
+                         y <= glm::min(chunkCoords.y + chunkRadius, chunkCount.y - 1);
+                         y++)
+                    {
+                        auto* neighbourChunk = chunks[chunkCoordinatesToChunkIndex({x, y})];
+                        neighbourChunk->bShouldRebuildShadows = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void VSChunkManager::uploadVisibleBlockInfos(VSChunk* chunk)
+{
+    // Free everything first so a chunk can reuse its own old ranges
+    freeVisibleBlockInfos(chunk);
+
+    for (std::size_t i = 1; i < faceCombinationCount; i++)
+    {
+        const auto& visibleBlockInfos = chunk->visibleBlockInfos[i];
+        auto& range = chunk->visibleBlockInfoRanges[i];
+
+        range = visibleBlockInfoBuffer->allocate(visibleBlockInfos.size());
+        visibleBlockInfoBuffer->write(range, visibleBlockInfos.data());
+
+        instanceUploadByteCount += visibleBlockInfos.size() * sizeof(VSChunk::VSVisibleBlockInfo);
+    }
+}
+
+void VSChunkManager::uploadGreedyMesh(VSChunk* chunk, const VSChunk::VSGreedyMesh& greedyMesh)
+{
+    chunk->greedyIndexCount = greedyMesh.indices.size();
+    chunk->greedyVertexCount = greedyMesh.vertices.size();
+
+    if (greedyMesh.indices.empty())
+    {
+        return;
+    }
+
+    if (chunk->greedyVertexArray == 0)
+    {
+        using VSGreedyVertex = VSChunk::VSGreedyVertex;
+
+        glGenVertexArrays(1, &chunk->greedyVertexArray);
+        glBindVertexArray(chunk->greedyVertexArray);
+
+        glGenBuffers(1, &chunk->greedyVertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk->greedyVertexBuffer);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(
+            0,
+            3,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(VSGreedyVertex),
+            (void*)offsetof(VSGreedyVertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(
+            1,
+            3,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(VSGreedyVertex),
+            (void*)offsetof(VSGreedyVertex, normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(
+            2,
+            2,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(VSGreedyVertex),
+            (void*)offsetof(VSGreedyVertex, texCoord));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(
+            3,
+            1,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(VSGreedyVertex),
+            (void*)offsetof(VSGreedyVertex, lightLevel));
+        glEnableVertexAttribArray(4);
+        glVertexAttribIPointer(
+            4,
+            1,
+            GL_UNSIGNED_INT,
+            sizeof(VSGreedyVertex),
+            (void*)offsetof(VSGreedyVertex, blockIDAndLightColor));
+
+        glGenBuffers(1, &chunk->greedyIndexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk->greedyIndexBuffer);
+    }
+    else
+    {
+        glBindVertexArray(chunk->greedyVertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk->greedyVertexBuffer);
+    }
+
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        greedyMesh.vertices.size() * sizeof(VSChunk::VSGreedyVertex),
+        greedyMesh.vertices.data(),
+        GL_STATIC_DRAW);
+    glBufferData(
+        GL_ELEMENT_ARRAY_BUFFER,
+        greedyMesh.indices.size() * sizeof(GLuint),
+        greedyMesh.indices.data(),
+        GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+}
+
+void VSChunkManager::freeVisibleBlockInfos(VSChunk* chunk)
+{
+    for (std::size_t i = 1; i < faceCombinationCount; i++)
+    {
+        visibleBlockInfoBuffer->free(chunk->visibleBlockInfoRanges[i]);
+    }
+}
+
+VSChunkManager::VSChunk::VSVisibilityResult VSChunkManager::chunkUpdateVisibility(
+    const std::atomic<bool>& bShouldCancel,
+    std::atomic<bool>& bIsReady,
+    std::size_t chunkIndex,
+    bool bShouldBuildGreedyMesh,
+    bool bShouldUseBitmaskKernel,
+    bool bShouldComputeSkyLight) const
+{
+    auto* const chunk = chunks[chunkIndex];
+
+    const auto chunkBlockCount = getChunkBlockCount();
+
+    auto result = VSChunkManager::VSChunk::VSVisibilityResult();
+
+    std::array<std::vector<std::uint32_t>, 6> faceKeys;
+    if (bShouldBuildGreedyMesh)
+    {
+        for (auto& keys : faceKeys)
+        {
+            keys.resize(chunkBlockCount, 0);
+        }
+    }
+
+    // Unpack once, the packed storage is only read through its accessors
+    std::vector<VSBlockID> blocks(chunkBlockCount);
+    copyChunkBlocks(chunk, blocks.data());
+
+    // Visible faces of every block, see VSCubeFace
+    std::vector<std::uint8_t> blockTypes(chunkBlockCount, 0);
+
+    const auto kernelStart = std::chrono::high_resolution_clock::now();
+    if (bShouldUseBitmaskKernel)
+    {
+        computeBlockTypesBitmask(chunkIndex, blocks, blockTypes);
+    }
+    else
+    {
+        computeBlockTypesScalar(chunkIndex, blocks, blockTypes);
+    }
+    visibilityKernelNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::high_resolution_clock::now() - kernelStart)
+                                       .count();
+    visibilityKernelRunCount++;
+
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    const glm::ivec3 chunkOrigin(
+        chunkCoordinates.x * chunkSize.x, 0, chunkCoordinates.y * chunkSize.z);
+
+    VSSunLightRegion sunLightRegion;
+    if (bShouldComputeSkyLight)
+    {
+        sunLightRegion = computeSunLight(bShouldCancel, chunkIndex);
+        if (bShouldCancel)
+        {
+            return {};
+        }
+
+        result.sunLight.resize((chunkBlockCount + 1) / 2, 0);
+        for (int z = 0; z < chunkSize.z; z++)
+        {
+            for (int y = 0; y < chunkSize.y; y++)
+            {
+                for (int x = 0; x < chunkSize.x; x++)
+                {
+                    const auto blockIndex = blockCoordinatesToBlockIndex({x, y, z});
+                    const auto level = sunLightRegion.get(chunkOrigin + glm::ivec3(x, y, z));
+                    result.sunLight[blockIndex / 2] |= level << ((blockIndex % 2) * 4);
+                }
+            }
+        }
+    }
+
+    const auto* sunLight = bShouldComputeSkyLight ? &sunLightRegion : nullptr;
+
+    const auto blockLight = copyBlockLight(chunkIndex);
+
+    VSLightSampleCache lightSampleCache;
+    lightSampleCache.origin = chunkOrigin - glm::ivec3(1);
+    lightSampleCache.size = chunkSize + glm::ivec3(2);
+    lightSampleCache.samples.assign(
+        lightSampleCache.size.x * lightSampleCache.size.y * lightSampleCache.size.z,
+        VSLightSampleCache::unset);
+
+    for (std::size_t sectionIndex = 0; sectionIndex < chunk->sections.size(); sectionIndex++)
+    {
+        // Nothing to draw in empty sections
+        if (chunk->sections[sectionIndex].isFilledWith(VS_DEFAULT_BLOCK_ID))
+        {
+            continue;
+        }
+
+        const int sectionBegin = sectionIndex * sectionHeight;
+        const int sectionEnd = glm::min(sectionBegin + sectionHeight, chunkSize.y);
+
+        for (int z = 0; z < chunkSize.z; z++)
+        {
+            if (bShouldCancel)
+            {
+                return {};
+            }
+
+            for (int y = sectionBegin; y < sectionEnd; y++)
+            {
+                for (int x = 0; x < chunkSize.x; x++)
+                {
+                    const auto blockIndex = blockCoordinatesToBlockIndex({x, y, z});
+
+                    const auto blockType = blockTypes[blockIndex];
+                    if (blockType != 0)
+                    {
+                        const auto offset = chunk->chunkLocation + glm::vec3(x, y, z) +
+                                            glm::vec3(0.5F) - glm::vec3(chunkSize) / 2.F;
+
+                        const auto lightInfo = getCachedLightInformation(
+                            lightSampleCache,
+                            chunkOrigin + glm::ivec3(x, y, z),
+                            blockLight,
+                            sunLight);
+
+                        const auto blockInfo = packVisibleBlockInfo(
+                            glm::ivec3(glm::floor(offset)) + worldSizeHalf,
+                            blocks[blockIndex],
+                            lightInfo,
+                            blockLight.getBlockColor(chunkOrigin + glm::ivec3(x, y, z)));
+                        result.visibleBlockInfos[blockType].emplace_back(blockInfo);
+                        result.visibleBlockIndices.push_back(blockIndex);
+
+                        if (bShouldBuildGreedyMesh)
+                        {
+                            // Faces can only be merged if block id, light and color match
+                            const auto lightColor =
+                                (blockInfo.lightTopBottomAndColorRG >> 24U) |
+                                (((blockInfo.lightFrontBackAndColorB >> 24U) & 0xFU) << 8U);
+                            const std::array<std::uint32_t, 3> lightWords = {
+                                blockInfo.lightRightLeftAndID,
+                                blockInfo.lightTopBottomAndColorRG,
+                                blockInfo.lightFrontBackAndColorB};
+
+                            for (std::size_t face = 0; face < faceKeys.size(); face++)
+                            {
+                                if ((blockType & (1U << lightInformationFaces[face])) != 0)
+                                {
+                                    const auto faceLight =
+                                        (lightWords[face / 2] >> ((face % 2) * 12U)) & 0xFFFU;
+                                    faceKeys[face][blockIndex] = blocks[blockIndex] |
+                                                                 (faceLight << 8U) |
+                                                                 (lightColor << 20U);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Sections are visited bottom to top, sort to get plain block index order
+    std::sort(result.visibleBlockIndices.begin(), result.visibleBlockIndices.end());
+
+    if (bShouldBuildGreedyMesh)
+    {
+        result.greedyMesh = buildGreedyMesh(bShouldCancel, chunk, faceKeys);
+    }
+
+    bIsReady = true;
+
+    return result;
+};
+
+VSChunkManager::VSChunk::VSGreedyMesh VSChunkManager::buildGreedyMesh(
+    const std::atomic<bool>& bShouldCancel,
+    const VSChunk* chunk,
+    const std::array<std::vector<std::uint32_t>, 6>& faceKeys) const
+{
+    VSChunk::VSGreedyMesh mesh;
+
+    const auto chunkMin = chunk->chunkLocation - glm::vec3(chunkSize) / 2.F;
+
+    for (std::size_t face = 0; face < faceKeys.size(); face++)
+    {
+        // Axis of the face normal and the two axes spanning the face. The first and second axis
+        // match the corner order of getLightInformation (bit 0 first, bit 1 second axis).
+        const int normalAxis = static_cast<int>(face / 2);
+        const int firstAxis = normalAxis == 0 ? 1 : 0;
+        const int secondAxis = normalAxis == 2 ? 1 : 2;
+        const bool bIsPositiveFace = face % 2 == 0;
+
+        glm::vec3 normal(0.F);
+        normal[normalAxis] = bIsPositiveFace ? 1.F : -1.F;
+
+        // Quads are wound counter clockwise seen from outside. first x second points along +x
+        // and +z but along -y (x cross z), so the winding has to be flipped for some faces.
+        const bool bIsFlipped = (normalAxis != 1) != bIsPositiveFace;
+
+        const int firstSize = chunkSize[firstAxis];
+        const int secondSize = chunkSize[secondAxis];
+        std::vector<std::uint32_t> sliceKeys(firstSize * secondSize);
+
+        for (int slice = 0; slice < chunkSize[normalAxis]; slice++)
+        {
+            if (bShouldCancel)
+            {
+                return {};
+            }
+
+            glm::ivec3 blockCoordinates(0);
+            blockCoordinates[normalAxis] = slice;
+            for (int second = 0; second < secondSize; second++)
+            {
+                blockCoordinates[secondAxis] = second;
+                for (int first = 0; first < firstSize; first++)
+                {
+                    blockCoordinates[firstAxis] = first;
+                    sliceKeys[first + second * firstSize] =
+                        faceKeys[face][blockCoordinatesToBlockIndex(blockCoordinates)];
+                }
+            }
+
+            for (int second = 0; second < secondSize; second++)
+            {
+                for (int first = 0; first < firstSize; first++)
+                {
+                    const auto key = sliceKeys[first + second * firstSize];
+                    if (key == 0)
+                    {
+                        continue;
+                    }
+
+                    // Only faces with the same light at all corners are merged, interpolating a
+                    // light gradient over a larger quad would not match the per block result
+                    const auto faceLight = (key >> 8U) & 0xFFFU;
+                    const bool bCanMerge = faceLight == (faceLight & 7U) * 0x249U;
+
+                    int width = 1;
+                    int height = 1;
+                    if (bCanMerge)
+                    {
+                        while (first + width < firstSize &&
+                               sliceKeys[first + width + second * firstSize] == key)
+                        {
+                            width++;
+                        }
+
+                        for (; second + height < secondSize; height++)
+                        {
+                            const auto rowBegin =
+                                sliceKeys.begin() + first + (second + height) * firstSize;
+                            const bool bIsRowMergeable =
+                                std::all_of(rowBegin, rowBegin + width, [key](std::uint32_t other) {
+                                    return other == key;
+                                });
+                            if (!bIsRowMergeable)
+                            {
+                                break;
+                            }
+                        }
+                    }
+
+                    for (int row = 0; row < height; row++)
+                    {
+                        const auto rowBegin =
+                            sliceKeys.begin() + first + (second + row) * firstSize;
+                        std::fill(rowBegin, rowBegin + width, 0U);
+                    }
+
+                    // Corner c of the quad, bit 0 selects the first, bit 1 the second axis
+                    glm::vec3 quadOrigin = chunkMin;
+                    quadOrigin[normalAxis] += slice + (bIsPositiveFace ? 1.F : 0.F);
+                    quadOrigin[firstAxis] += first;
+                    quadOrigin[secondAxis] += second;
+
+                    std::array<float, 4> cornerLight{};
+                    const auto firstVertex = static_cast<GLuint>(mesh.vertices.size());
+                    for (std::uint32_t corner = 0; corner < 4; corner++)
+                    {
+                        const float firstExtent = (corner & 1U) != 0 ? width : 0.F;
+                        const float secondExtent = (corner & 2U) != 0 ? height : 0.F;
+
+                        auto position = quadOrigin;
+                        position[firstAxis] += firstExtent;
+                        position[secondAxis] += secondExtent;
+
+                        // Same uv layout as the cube models, see getLight in Chunk.vs
+                        const auto texCoord = normalAxis == 0
+                                                  ? glm::vec2(secondExtent, firstExtent)
+                                                  : glm::vec2(firstExtent, secondExtent);
+
+                        cornerLight[corner] =
+                            lightLevels[(faceLight >> (corner * 3U)) & 7U] / lightLevels.back();
+
+                        mesh.vertices.push_back(
+                            {position,
+                             normal,
+                             texCoord,
+                             cornerLight[corner],
+                             (key & 0xFFU) | ((key >> 20U) << 8U)});
+                    }
+
+                    // Split along the brighter diagonal like the cube models do
+                    std::array<GLuint, 6> quadIndices =
+                        cornerLight[0] + cornerLight[3] > cornerLight[1] + cornerLight[2]
+                            ? std::array<GLuint, 6>{0, 1, 3, 0, 3, 2}
+                            : std::array<GLuint, 6>{1, 3, 2, 1, 2, 0};
+                    if (bIsFlipped)
+                    {
+                        std::swap(quadIndices[1], quadIndices[2]);
+                        std::swap(quadIndices[4], quadIndices[5]);
+                    }
+                    for (const auto index : quadIndices)
+                    {
+                        mesh.indices.push_back(firstVertex + index);
+                    }
+                }
+            }
+        }
+    }
+
+    return mesh;
+}
+
+void VSChunkManager::computeBlockTypesScalar(
+    std::size_t chunkIndex,
+    const std::vector<VSBlockID>& blocks,
+    std::vector<std::uint8_t>& blockTypes) const
+{
+    const auto* chunk = chunks[chunkIndex];
+
+    for (std::size_t sectionIndex = 0; sectionIndex < chunk->sections.size(); sectionIndex++)
+    {
+        const auto& section = chunk->sections[sectionIndex];
+
+        if (section.isFilledWith(VS_DEFAULT_BLOCK_ID))
+        {
+            continue;
+        }
+
+        // Blocks inside a uniform (solid) section are enclosed by blocks of the same section,
+        // so only the outer shell of the section can be visible
+        const bool bIsSolidSection = section.isUniform();
+
+        const int sectionBegin = sectionIndex * sectionHeight;
+        const int sectionEnd = glm::min(sectionBegin + sectionHeight, chunkSize.y);
+
+        for (int z = 0; z < chunkSize.z; z++)
+        {
+            for (int y = sectionBegin; y < sectionEnd; y++)
+            {
+                const bool bIsShellRow = !bIsSolidSection || z == 0 || z == chunkSize.z - 1 ||
+                                         y == sectionBegin || y == sectionEnd - 1;
+                const int xStep = bIsShellRow ? 1 : chunkSize.x - 1;
+
+                for (int x = 0; x < chunkSize.x; x += xStep)
+                {
+                    const auto blockIndex = blockCoordinatesToBlockIndex({x, y, z});
+
+                    if (blocks[blockIndex] != VS_DEFAULT_BLOCK_ID)
+                    {
+                        blockTypes[blockIndex] = isBlockVisible(blocks, chunkIndex, blockIndex);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void VSChunkManager::computeBlockTypesBitmask(
+    std::size_t chunkIndex,
+    const std::vector<VSBlockID>& blocks,
+    std::vector<std::uint8_t>& blockTypes) const
+{
+    using VSWord = std::uint64_t;
+    constexpr int wordBits = 64;
+
+    const int width = chunkSize.x;
+    const int height = chunkSize.y;
+    const int depth = chunkSize.z;
+
+    // One bit per block of an x row, bit x + 1 is block x. Bit 0 and bit width + 1 as well as the
+    // rows at z = -1 and z = depth hold the neighbour chunks' blocks (apron), the rows at y = -1
+    // and y = height stay empty.
+    const int wordsPerRow = (width + 2 + wordBits - 1) / wordBits;
+    const int paddedHeight = height + 2;
+    const auto rowOffset = [wordsPerRow, paddedHeight](int y, int z) {
+        return static_cast<std::size_t>(((z + 1) * paddedHeight + (y + 1)) * wordsPerRow);
+    };
+
+    std::vector<VSWord> occupancy(rowOffset(-1, depth + 1), 0);
+    const auto setOccupied = [&occupancy](std::size_t row, int x) {
+        occupancy[row + (x + 1) / wordBits] |= VSWord(1) << ((x + 1) % wordBits);
+    };
+
+    for (int z = 0; z < depth; z++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            const auto row = rowOffset(y, z);
+            const auto* blockRow = blocks.data() + blockCoordinatesToBlockIndex({0, y, z});
+            for (int x = 0; x < width; x++)
+            {
+                if (blockRow[x] != VS_DEFAULT_BLOCK_ID)
+                {
+                    setOccupied(row, x);
+                }
+            }
+        }
+    }
+
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    const auto getNeighbourChunk = [this, &chunkCoordinates](const glm::ivec2& offset) {
+        const auto neighbourCoordinates = chunkCoordinates + offset;
+        const bool bIsInWorld = neighbourCoordinates.x >= 0 && neighbourCoordinates.y >= 0 &&
+                                neighbourCoordinates.x < chunkCount.x &&
+                                neighbourCoordinates.y < chunkCount.y;
+        return bIsInWorld ? chunks[chunkCoordinatesToChunkIndex(neighbourCoordinates)] : nullptr;
+    };
+
+    // Calls setApronOccupied(i, y) for every non-air block neighbourCoords(i, y) with i below
+    // length. Each section of the neighbour is locked once for its part of the border plane.
+    const auto addApron = [this, height](
+                              const VSChunk* neighbourChunk,
+                              int length,
+                              const auto& neighbourCoords,
+                              const auto& setApronOccupied) {
+        if (neighbourChunk == nullptr)
+        {
+            return;
+        }
+
+        for (std::size_t sectionIndex = 0; sectionIndex < neighbourChunk->sections.size();
+             sectionIndex++)
+        {
+            const auto& storage = neighbourChunk->sections[sectionIndex];
+            if (storage.isFilledWith(VS_DEFAULT_BLOCK_ID))
+            {
+                continue;
+            }
+
+            const VSBlockStorage::VSReadLock section(storage);
+            const int sectionBegin = sectionIndex * sectionHeight;
+            const int sectionEnd = glm::min(sectionBegin + sectionHeight, height);
+            for (int y = sectionBegin; y < sectionEnd; y++)
+            {
+                for (int i = 0; i < length; i++)
+                {
+                    if (section.get(blockCoordinatesToSectionBlockIndex(neighbourCoords(i, y))) !=
+                        VS_DEFAULT_BLOCK_ID)
+                    {
+                        setApronOccupied(i, y);
+                    }
+                }
+            }
+        }
+    };
+
+    // Apron, the chunks at the world border have no neighbours and are handled below
+    const auto* rightChunk = getNeighbourChunk({1, 0});
+    const auto* leftChunk = getNeighbourChunk({-1, 0});
+    const auto* frontChunk = getNeighbourChunk({0, 1});
+    const auto* backChunk = getNeighbourChunk({0, -1});
+    addApron(
+        rightChunk,
+        depth,
+        [](int z, int y) { return glm::ivec3(0, y, z); },
+        [&](int z, int y) { setOccupied(rowOffset(y, z), width); });
+    addApron(
+        leftChunk,
+        depth,
+        [width](int z, int y) { return glm::ivec3(width - 1, y, z); },
+        [&](int z, int y) { setOccupied(rowOffset(y, z), -1); });
+    addApron(
+        frontChunk,
+        width,
+        [](int x, int y) { return glm::ivec3(x, y, 0); },
+        [&](int x, int y) { setOccupied(rowOffset(y, depth), x); });
+    addApron(
+        backChunk,
+        width,
+        [depth](int x, int y) { return glm::ivec3(x, y, depth - 1); },
+        [&](int x, int y) { setOccupied(rowOffset(y, -1), x); });
+
+    std::vector<VSWord> interiorMask(wordsPerRow, 0);
+    std::vector<VSWord> worldBorderMask(wordsPerRow, 0);
+    for (int x = 0; x < width; x++)
+    {
+        interiorMask[(x + 1) / wordBits] |= VSWord(1) << ((x + 1) % wordBits);
+    }
+    if (chunkCoordinates.x == 0)
+    {
+        worldBorderMask[0] |= VSWord(1) << 1;
+    }
+    if (chunkCoordinates.x == chunkCount.x - 1)
+    {
+        worldBorderMask[width / wordBits] |= VSWord(1) << (width % wordBits);
+    }
+
+    for (int z = 0; z < depth; z++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            const auto* row = occupancy.data() + rowOffset(y, z);
+            const auto* topRow = occupancy.data() + rowOffset(y + 1, z);
+            const auto* bottomRow = occupancy.data() + rowOffset(y - 1, z);
+            const auto* frontRow = occupancy.data() + rowOffset(y, z + 1);
+            const auto* backRow = occupancy.data() + rowOffset(y, z - 1);
+
+            const bool bIsWorldBorderRow =
+                y == 0 || y == height - 1 || (z == 0 && chunkCoordinates.y == 0) ||
+                (z == depth - 1 && chunkCoordinates.y == chunkCount.y - 1);
+
+            for (int word = 0; word < wordsPerRow; word++)
+            {
+                const auto occupied = row[word] & interiorMask[word];
+                if (occupied == 0)
+                {
+                    continue;
+                }
+
+                // Neighbours at x + 1 and x - 1 moved onto the block's bit
+                const VSWord nextWord = word + 1 < wordsPerRow ? row[word + 1] : 0;
+                const VSWord previousWord = word > 0 ? row[word - 1] : 0;
+                const auto rightNeighbours = (row[word] >> 1) | (nextWord << (wordBits - 1));
+                const auto leftNeighbours = (row[word] << 1) | (previousWord >> (wordBits - 1));
+
+                std::array<VSWord, 6> faces{};
+                faces[VSCubeFace::Right] = occupied & ~rightNeighbours;
+                faces[VSCubeFace::Left] = occupied & ~leftNeighbours;
+                faces[VSCubeFace::Top] = occupied & ~topRow[word];
+                faces[VSCubeFace::Bottom] = occupied & ~bottomRow[word];
+                faces[VSCubeFace::Front] = occupied & ~frontRow[word];
+                faces[VSCubeFace::Back] = occupied & ~backRow[word];
+
+                // Blocks at the world border are drawn as full cubes if the block above is air,
+                // see isBorderBlockVisible
+                const auto worldBorder = bIsWorldBorderRow ? occupied
+                                                           : occupied & worldBorderMask[word];
+                const auto fullCubes = y + 1 < height ? worldBorder & faces[VSCubeFace::Top] : 0;
+
+                VSWord visible = 0;
+                for (auto& face : faces)
+                {
+                    face = (face & ~worldBorder) | fullCubes;
+                    visible |= face;
+                }
+
+                while (visible != 0)
+                {
+                    const auto bit = countTrailingZeros(visible);
+                    visible &= visible - 1;
+
+                    std::uint8_t blockType = 0;
+                    for (std::size_t face = 0; face < faces.size(); face++)
+                    {
+                        blockType |= ((faces[face] >> bit) & 1U) << face;
+                    }
+
+                    const int x = word * wordBits + bit - 1;
+                    blockTypes[blockCoordinatesToBlockIndex({x, y, z})] = blockType;
+                }
+            }
+        }
+    }
+}
+
+std::uint8_t VSChunkManager::isBlockVisible(
+    const std::vector<VSBlockID>& blocks,
+    std::size_t chunkIndex,
+    std::size_t blockIndex) const
+{
+    const auto blockCoords = blockIndexToBlockCoordinates(blockIndex);
+
+    if (blockCoords.x == 0 || blockCoords.x == chunkSize.x - 1 || blockCoords.y == 0 ||
+        blockCoords.y == chunkSize.y - 1 || blockCoords.z == 0 || blockCoords.z == chunkSize.z - 1)
+    {
+        return isBorderBlockVisible(chunkIndex, blockCoords);
+    }
+    return isCenterBlockVisible(blocks, blockCoords);
+}
+
+std::uint8_t VSChunkManager::isCenterBlockVisible(
+    const std::vector<VSBlockID>& blocks,
+    const glm::ivec3& blockCoordinates) const
+{
+    const auto right = glm::ivec3(blockCoordinates.x + 1, blockCoordinates.y, blockCoordinates.z);
+    const auto left = glm::ivec3(blockCoordinates.x - 1, blockCoordinates.y, blockCoordinates.z);
+
+    const auto top = glm::ivec3(blockCoordinates.x, blockCoordinates.y + 1, blockCoordinates.z);
+    const auto bottom = glm::ivec3(blockCoordinates.x, blockCoordinates.y - 1, blockCoordinates.z);
+
+    const auto front = glm::ivec3(blockCoordinates.x, blockCoordinates.y, blockCoordinates.z + 1);
+    // TODO is + 1 or -1 back?
+    const auto back = glm::ivec3(blockCoordinates.x, blockCoordinates.y, blockCoordinates.z - 1);
+
+    std::uint8_t encoded = 0;
+    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(right)] == VS_DEFAULT_BLOCK_ID)
+               << VSCubeFace::Right;
+    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(left)] == VS_DEFAULT_BLOCK_ID)
+               << VSCubeFace::Left;
+    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(top)] == VS_DEFAULT_BLOCK_ID)
+               << VSCubeFace::Top;
+    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(bottom)] == VS_DEFAULT_BLOCK_ID)
+               << VSCubeFace::Bottom;
+    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(front)] == VS_DEFAULT_BLOCK_ID)
+               << VSCubeFace::Front;
+    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(back)] == VS_DEFAULT_BLOCK_ID)
+               << VSCubeFace::Back;
+
+    return encoded;
+}
+
+std::uint8_t VSChunkManager::isBorderBlockVisible(
+    std::size_t chunkIndex,
+    const glm::ivec3& blockCoordinates) const
+{
+    const auto blockWorldCoordinates =
+        blockCoordinatesToWorldCoordinates(chunkIndex, blockCoordinates);
+    if (isAtWorldBorder(blockWorldCoordinates))
+    {
+        if (blockWorldCoordinates.y + 1 < worldSizeHalf.y &&
+            getBlock(blockWorldCoordinates + glm::ivec3(0, 1, 0)) == VS_DEFAULT_BLOCK_ID)
+        {
+            // always use a full block at the world border for now
+            return 63;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    const auto right = blockWorldCoordinates + glm::ivec3(1, 0, 0);
+
+    const auto left = blockWorldCoordinates + glm::ivec3(-1, 0, 0);
+
+    const auto top = blockWorldCoordinates + glm::ivec3(0, 1, 0);
+
+    const auto bottom = blockWorldCoordinates + glm::ivec3(0, -1, 0);
+
+    const auto front = blockWorldCoordinates + glm::ivec3(0, 0, 1);
+
+    // TODO is + 1 or -1 back?
+    const auto back = blockWorldCoordinates + glm::ivec3(0, 0, -1);
+
+    std::uint8_t encoded = 0;
+    encoded |= static_cast<int>(getBlock(right) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Right;
+    encoded |= static_cast<int>(getBlock(left) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Left;
+    encoded |= static_cast<int>(getBlock(top) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Top;
+    encoded |= static_cast<int>(getBlock(bottom) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Bottom;
+    encoded |= static_cast<int>(getBlock(front) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Front;
+    encoded |= static_cast<int>(getBlock(back) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Back;
+
+    return encoded;
+}
+
+bool VSChunkManager::isAtWorldBorder(const glm::ivec3& blockWorldCoordinates) const
 {
-    return drawnBlockCount;
+    return blockWorldCoordinates.x == -worldSizeHalf.x ||
+           blockWorldCoordinates.x == worldSizeHalf.x - 1 ||
+           blockWorldCoordinates.y == -worldSizeHalf.y ||
+           blockWorldCoordinates.y == worldSizeHalf.y - 1 ||
+           blockWorldCoordinates.z == -worldSizeHalf.z ||
+           blockWorldCoordinates.z == worldSizeHalf.z - 1;
 }
 
-std::size_t VSChunkManager::getTotalChunkCount() const
+
+std::array<std::uint32_t, 6> VSChunkManager::getLightInformation(
+    const glm::vec3& blockCoordinates,
+    const VSBlockLightRegion& blockLight,
+    const VSSunLightRegion* sunLight) const
 {
-    return glm::compMul(chunkCount);
+    std::array<std::uint32_t, 6> result;
+    for (std::size_t face = 0; face < result.size(); face++)
+    {
+        result[face] = getLightInformationForFace(
+            blockCoordinates, lightInformationCorners[face], blockLight, sunLight);
+    }
+    return result;
 }
 
-std::size_t VSChunkManager::getDrawCallCount() const
+std::array<std::uint32_t, 6> VSChunkManager::getCachedLightInformation(
+    VSLightSampleCache& cache,
+    const glm::ivec3& zeroBaseLocation,
+    const VSBlockLightRegion& blockLight,
+    const VSSunLightRegion* sunLight) const
 {
-    return drawCallCount;
+    // Samples of the 3x3x3 blocks around the block, x fastest
+    std::array<std::uint32_t, 27> neighbourhood;
+    for (int z = 0; z < 3; z++)
+    {
+        for (int y = 0; y < 3; y++)
+        {
+            for (int x = 0; x < 3; x++)
+            {
+                const auto sampleLocation = zeroBaseLocation + glm::ivec3(x - 1, y - 1, z - 1);
+                const auto cacheLocation = sampleLocation - cache.origin;
+                auto& sample = cache.samples
+                    [cacheLocation.x + cacheLocation.y * cache.size.x +
+                     cacheLocation.z * cache.size.x * cache.size.y];
+                if (sample == VSLightSampleCache::unset)
+                {
+                    sample = computeLightSample(sampleLocation, blockLight, sunLight);
+                }
+                neighbourhood[x + y * 3 + z * 9] = sample;
+            }
+        }
+    }
+
+    std::array<std::uint32_t, 6> result;
+    for (std::size_t face = 0; face < result.size(); face++)
+    {
+        const auto& corners = lightInformationCorners[face];
+        std::uint32_t faceLight = 0;
+        for (std::size_t corner = 0; corner < corners.size(); corner++)
+        {
+            std::uint32_t sampleSum = 0;
+            for (const auto& sampleOffset : corners)
+            {
+                // corner + sampleOffset is -1, 0 or 1 on every axis
+                const auto offset = glm::ivec3(corners[corner] + sampleOffset) + 1;
+                sampleSum += neighbourhood[offset.x + offset.y * 3 + offset.z * 9];
+            }
+            faceLight |= cornerSampleSumToLight(sampleSum) << (corner * 8U);
+        }
+        result[face] = faceLight;
+    }
+    return result;
 }
 
-bool VSChunkManager::shouldReinitializeChunks() const
+std::uint16_t VSChunkManager::computeLightSample(
+    const glm::ivec3& zeroBaseLocation,
+    const VSBlockLightRegion& blockLight,
+    const VSSunLightRegion* sunLight) const
 {
-    return bShouldReinitializeChunks.load();
+    if (!isZeroBaseLocationInBounds(zeroBaseLocation))
+    {
+        return 0;
+    }
+
+    if (!blockLight.isAir[blockLight.getIndex(zeroBaseLocation)])
+    {
+        return 0;
+    }
+
+    const std::uint32_t sunLightLevel =
+        sunLight != nullptr ? sunLight->get(zeroBaseLocation) : maxSunLight;
+    return static_cast<std::uint16_t>(
+        blockLight.getLevel(zeroBaseLocation) * blockLightSampleWeight +
+        sunLightLevel * sunLightSampleWeight);
 }
 
-bool VSChunkManager::isLocationInBounds(const glm::vec3& location) const
+std::uint32_t VSChunkManager::cornerSampleSumToLight(std::uint32_t sampleSum)
 {
-    return (
-        (location.x >= -worldSizeHalf.x && location.x < worldSizeHalf.x) &&
-        (location.y >= -worldSizeHalf.y && location.y < worldSizeHalf.y) &&
-        (location.z >= -worldSizeHalf.z && location.z < worldSizeHalf.z));
+    // average of four samples clamped to the light value 32, scaled to 0-255
+    constexpr std::uint32_t maxSampleSum = 32 * lightSampleScale * 4;
+    return glm::min(sampleSum, maxSampleSum) * 255U / maxSampleSum;
 }
 
-VSChunkManager::VSTraceResult
-VSChunkManager::lineTrace(const glm::vec3& start, const glm::vec3& end) const
+VSChunkManager::VSChunk::VSVisibleBlockInfo VSChunkManager::packVisibleBlockInfo(
+    const glm::ivec3& zeroBaseLocation,
+    VSBlockID blockID,
+    const std::array<std::uint32_t, 6>& lightInformation,
+    const glm::vec3& lightColor)
 {
-    const glm::vec3 startToEnd = end - start;
-
-    const float maxRayLength = glm::length(startToEnd);
+    assert(zeroBaseLocation.x < maxWorldWidth && zeroBaseLocation.y < maxWorldHeight);
+    assert(zeroBaseLocation.z < maxWorldWidth);
 
-    const auto rayDir = startToEnd / maxRayLength;
+    // 4 bits per color channel, light colors are sums of 0-255 emission colors
+    const auto color = glm::uvec3(glm::round(glm::clamp(lightColor, 0.F, 255.F) / 255.F * 15.F));
 
-    float t = 0.F;
+    return {
+        static_cast<std::uint32_t>(zeroBaseLocation.x) |
+            (static_cast<std::uint32_t>(zeroBaseLocation.y) << 11U) |
+            (static_cast<std::uint32_t>(zeroBaseLocation.z) << 19U),
+        packFaceLight(lightInformation[0]) | (packFaceLight(lightInformation[1]) << 12U) |
+            (static_cast<std::uint32_t>(blockID) << 24U),
+        packFaceLight(lightInformation[2]) | (packFaceLight(lightInformation[3]) << 12U) |
+            (color.r << 24U) | (color.g << 28U),
+        packFaceLight(lightInformation[4]) | (packFaceLight(lightInformation[5]) << 12U) |
+            (color.b << 24U)};
+}
 
-    while (!bShouldReinitializeChunks && t < maxRayLength)
+std::uint32_t VSChunkManager::packFaceLight(std::uint32_t faceLight)
+{
+    std::uint32_t result = 0;
+    for (std::uint32_t corner = 0; corner < 4; corner++)
     {
-        const auto samplePos = start + rayDir * t;
-        if (!bShouldReinitializeChunks && isLocationInBounds(samplePos))
+        const auto lightValue =
+            static_cast<float>((faceLight >> (corner * 8U)) & 0xFFU) / 255.F * 32.F;
+
+        std::uint32_t nearestLevel = 0;
+        for (std::uint32_t level = 1; level < lightLevels.size(); level++)
         {
-            const auto blockSample = getBlock(samplePos);
-            if (blockSample != VS_DEFAULT_BLOCK_ID)
+            if (glm::abs(lightLevels[level] - lightValue) <
+                glm::abs(lightLevels[nearestLevel] - lightValue))
             {
-                const auto centerToHitPos = glm::fract(samplePos) - 0.5F;
+                nearestLevel = level;
+            }
+        }
+
+        result |= nearestLevel << (corner * 3U);
+    }
+    return result;
+}
 
-                glm::vec3 d = glm::abs(centerToHitPos) - 0.5F;
-                const auto distToSurface = length(glm::max(d, glm::vec3(0.F))) +
-                                           glm::min(glm::max(glm::max(d.x, d.y), d.z), 0.F);
+std::uint8_t VSChunkManager::getBlockLightEmission(VSBlockID blockID)
+{
+    if (blockID >= blockEmission.size())
+    {
+        return 0;
+    }
+    return static_cast<std::uint8_t>(
+        glm::min(glm::ceil(blockEmission[blockID]), static_cast<float>(maxBlockLight)));
+}
 
-                auto interSectionPos = samplePos - rayDir * distToSurface;
+bool VSChunkManager::isBlockOpaque(VSBlockID blockID)
+{
+    return blockID != VS_DEFAULT_BLOCK_ID;
+}
 
-                // calc normals
+bool VSChunkManager::shouldUpdateBlockLight(
+    const glm::ivec3& zeroBaseLocation,
+    VSBlockID previousBlockID,
+    VSBlockID blockID) const
+{
+    if (previousBlockID == blockID)
+    {
+        return false;
+    }
 
-                auto normal = glm::vec3(0, 0, 0);
+    if (getBlockLightEmission(previousBlockID) != 0 || getBlockLightEmission(blockID) != 0)
+    {
+        return true;
+    }
 
-                if (d.x > d.y && d.x > d.z)
-                {
-                    normal = {glm::sign(centerToHitPos.x) * 1.F, 0.F, 0.F};
-                    interSectionPos.x = glm::round(interSectionPos.x);
-                    if (centerToHitPos.x < 0)
-                    {
-                        interSectionPos.x -= 0.00001F;
-                    }
-                }
+    std::shared_lock lock(blockLightMutex);
 
-                if (d.y > d.x && d.y > d.z)
-                {
-                    normal = {0.F, glm::sign(centerToHitPos.y) * 1.F, 0.F};
-                    interSectionPos.y = glm::round(interSectionPos.y);
-                    if (centerToHitPos.y < 0)
-                    {
-                        interSectionPos.y -= 0.00001F;
-                    }
-                }
+    // An opaque block in a lit spot takes the light away
+    const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(zeroBaseLocation);
+    if (isBlockOpaque(blockID) && chunks[chunkIndex]->blockLight[blockIndex] != 0)
+    {
+        return true;
+    }
 
-                if (d.z > d.x && d.z > d.y)
+    // Removing an opaque block lets light of the neighbours in
+    if (isBlockOpaque(previousBlockID) && !isBlockOpaque(blockID))
+    {
+        for (const auto& offset : blockLightNeighbourOffsets)
+        {
+            const auto neighbourLocation = zeroBaseLocation + offset;
+            if (isZeroBaseLocationInBounds(neighbourLocation))
+            {
+                const auto [neighbourChunkIndex, neighbourBlockIndex] =
+                    worldCoordinatesToChunkAndBlockIndex(neighbourLocation);
+                if (chunks[neighbourChunkIndex]->blockLight[neighbourBlockIndex] != 0)
                 {
-                    normal = {0.F, 0.F, glm::sign(centerToHitPos.z) * 1.F};
-                    interSectionPos.z = glm::round(interSectionPos.z);
-                    if (centerToHitPos.z < 0)
-                    {
-                        interSectionPos.z -= 0.00001F;
-                    }
+                    return true;
                 }
-
-                return VSChunkManager::VSTraceResult{true, interSectionPos, normal, blockSample};
             }
         }
-        t += 0.0075F;
     }
 
-    return {false, {}, {}, VS_DEFAULT_BLOCK_ID};
+    return false;
 }
 
-VSChunkManager::VSWorldData VSChunkManager::getData() const
+bool VSChunkManager::isZeroBaseLocationInBounds(const glm::ivec3& zeroBaseLocation) const
 {
-    VSChunkManager::VSWorldData worldData{};
-
-    worldData.chunkSize = chunkSize;
-    worldData.chunkCount = getChunkCount();
-
-    // Write BlockIDs to vector
-    worldData.blocks = std::vector<VSBlockID>();
+    return glm::all(glm::greaterThanEqual(zeroBaseLocation, glm::ivec3(0))) &&
+           glm::all(glm::lessThan(zeroBaseLocation, worldSize));
+}
 
-    for (const auto* chunk : chunks)
+void VSChunkManager::setBlockLight(
+    std::size_t chunkIndex,
+    std::size_t blockIndex,
+    const glm::ivec3& zeroBaseLocation,
+    std::uint8_t level,
+    const glm::vec3& color)
+{
+    auto* const chunk = chunks[chunkIndex];
+    chunk->blockLight[blockIndex] = level;
+    chunk->lightColor[blockIndex] = color;
+    chunk->bIsDirty = true;
+
+    // Faces of the neighbour chunk sample this block too
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    const auto blockX = zeroBaseLocation.x - chunkCoordinates.x * chunkSize.x;
+    const auto blockZ = zeroBaseLocation.z - chunkCoordinates.y * chunkSize.z;
+    if (blockX == 0 && chunkCoordinates.x > 0)
     {
-        worldData.blocks.insert(worldData.blocks.end(), chunk->blocks.begin(), chunk->blocks.end());
+        chunks[chunkCoordinatesToChunkIndex(chunkCoordinates - glm::ivec2(1, 0))]->bIsDirty = true;
+    }
+    if (blockX == chunkSize.x - 1 && chunkCoordinates.x < chunkCount.x - 1)
+    {
+        chunks[chunkCoordinatesToChunkIndex(chunkCoordinates + glm::ivec2(1, 0))]->bIsDirty = true;
+    }
+    if (blockZ == 0 && chunkCoordinates.y > 0)
+    {
+        chunks[chunkCoordinatesToChunkIndex(chunkCoordinates - glm::ivec2(0, 1))]->bIsDirty = true;
+    }
+    if (blockZ == chunkSize.z - 1 && chunkCoordinates.y < chunkCount.y - 1)
+    {
+        chunks[chunkCoordinatesToChunkIndex(chunkCoordinates + glm::ivec2(0, 1))]->bIsDirty = true;
     }
-
-    return worldData;
 }
 
-void VSChunkManager::initFromData(const VSWorldData& data)
+void VSChunkManager::propagateBlockLight()
 {
-    setChunkDimensions(data.chunkSize, data.chunkCount);
-    worldDataFromFile = data;
-    bShouldInitializeFromData = true;
-}
+    assert(debug_isMainThread());
 
-void VSChunkManager::initializeChunks()
-{
-    bool expected = true;
-    if (bShouldReinitializeChunks.load() == expected)
+    lightEdits.resize(pendingLightEdits.size_approx());
+    lightEdits.resize(pendingLightEdits.try_dequeue_bulk(lightEdits.begin(), lightEdits.size()));
+    if (lightEdits.empty())
     {
-        chunkSize = newChunkSize;
-        chunkCount = newChunkCount;
-        worldSize = newWorldSize;
-        worldSizeHalf = newWorldSizeHalf;
+        return;
+    }
+
+    std::unique_lock lock(blockLightMutex);
 
-        for (const auto& [chunk, shadowBuildUpdate] : activeShadowBuildTasks)
+    std::size_t changedBlockCount = 0;
+    lightRemovalQueue.clear();
+    lightAddQueue.clear();
+
+    // Remove the light of every edited block and of everything that got its light from there.
+    // Blocks that are brighter than the light being removed (or emit light themselves) are lit
+    // by something else, they refill the removed area in the add pass.
+    for (const auto& editLocation : lightEdits)
+    {
+        const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(editLocation);
+        const auto level = chunks[chunkIndex]->blockLight[blockIndex];
+        if (level != 0)
         {
-            shadowBuildUpdate->cancel();
+            setBlockLight(chunkIndex, blockIndex, editLocation, 0, glm::vec3(0.F));
+            lightRemovalQueue.push_back({editLocation, level});
+            changedBlockCount++;
         }
-        activeShadowBuildTasks.clear();
+    }
 
-        for (const auto& [chunk, visibilityBuildUpdate] : activeVisibilityBuildTasks)
+    for (std::size_t i = 0; i < lightRemovalQueue.size(); i++)
+    {
+        const auto removal = lightRemovalQueue[i];
+        for (const auto& offset : blockLightNeighbourOffsets)
         {
-            visibilityBuildUpdate->cancel();
+            const auto neighbourLocation = removal.zeroBaseLocation + offset;
+            if (!isZeroBaseLocationInBounds(neighbourLocation))
+            {
+                continue;
+            }
+
+            const auto [chunkIndex, blockIndex] =
+                worldCoordinatesToChunkAndBlockIndex(neighbourLocation);
+            const auto neighbourLevel = chunks[chunkIndex]->blockLight[blockIndex];
+            if (neighbourLevel == 0)
+            {
+                continue;
+            }
+
+            if (neighbourLevel < removal.level &&
+                getBlockLightEmission(getChunkBlock(chunks[chunkIndex], blockIndex)) == 0)
+            {
+                setBlockLight(chunkIndex, blockIndex, neighbourLocation, 0, glm::vec3(0.F));
+                lightRemovalQueue.push_back({neighbourLocation, neighbourLevel});
+                changedBlockCount++;
+            }
+            else
+            {
+                lightAddQueue.push_back(neighbourLocation);
+            }
         }
-        activeVisibilityBuildTasks.clear();
+    }
 
-        for (auto* chunk : chunks)
+    // Seed emitters and let the light of the neighbours into blocks that became transparent.
+    // The current block is used since later edits of the same frame may have replaced it.
+    for (const auto& editLocation : lightEdits)
+    {
+        const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(editLocation);
+        const auto blockID = getChunkBlock(chunks[chunkIndex], blockIndex);
+        const auto emission = getBlockLightEmission(blockID);
+        if (emission > chunks[chunkIndex]->blockLight[blockIndex])
         {
-            deleteChunk(chunk);
+            setBlockLight(
+                chunkIndex,
+                blockIndex,
+                editLocation,
+                emission,
+                blockEmissionColors[blockID]);
+            lightAddQueue.push_back(editLocation);
+            changedBlockCount++;
         }
-        chunks.clear();
-        chunks.resize(chunkCount.x * chunkCount.y);
 
-        for (int y = 0; y < chunkCount.x; y++)
+        if (!isBlockOpaque(blockID))
         {
-            for (int x = 0; x < chunkCount.x; x++)
+            for (const auto& offset : blockLightNeighbourOffsets)
             {
-                VSChunk* newChunk = createChunk();
-                newChunk->chunkLocation =
-                    glm::vec3(
-                        chunkSize.x * (static_cast<float>(x) + 0.5F),
-                        0.F,
-                        chunkSize.z * (static_cast<float>(y) + 0.5F)) -
-                    glm::vec3(chunkSize.x * chunkCount.x, 0.F, chunkSize.z * chunkCount.y) / 2.F;
-                chunks[y * chunkCount.x + x] = newChunk;
+                const auto neighbourLocation = editLocation + offset;
+                if (isZeroBaseLocationInBounds(neighbourLocation))
+                {
+                    lightAddQueue.push_back(neighbourLocation);
+                }
             }
         }
+    }
 
-        glDeleteTextures(1, &shadowTexture);
+    // Spread the light through air, one level less per step
+    for (std::size_t i = 0; i < lightAddQueue.size(); i++)
+    {
+        const auto location = lightAddQueue[i];
+        const auto [chunkIndex, blockIndex] = worldCoordinatesToChunkAndBlockIndex(location);
+        const auto level = chunks[chunkIndex]->blockLight[blockIndex];
+        if (level <= 1)
+        {
+            continue;
+        }
+        const auto color = chunks[chunkIndex]->lightColor[blockIndex];
 
-        glGenTextures(1, &shadowTexture);
-        glBindTexture(GL_TEXTURE_3D, shadowTexture);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, 0);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_BORDER);
-        glm::vec3 borderColor(std::numeric_limits<float>::max());
-        glTexParameterfv(GL_TEXTURE_3D, GL_TEXTURE_BORDER_COLOR, &borderColor[0]);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexImage3D(
-            GL_TEXTURE_3D,
-            0,
-            GL_R16F,
-            worldSize.x,
-            worldSize.y,
-            worldSize.z,
-            0,
-            GL_RED,
-            GL_FLOAT,
-            nullptr);
+        for (const auto& offset : blockLightNeighbourOffsets)
+        {
+            const auto neighbourLocation = location + offset;
+            if (!isZeroBaseLocationInBounds(neighbourLocation))
+            {
+                continue;
+            }
 
-        bShouldReinitializeChunks.compare_exchange_weak(expected, false);
+            const auto [neighbourChunkIndex, neighbourBlockIndex] =
+                worldCoordinatesToChunkAndBlockIndex(neighbourLocation);
+            auto* const neighbourChunk = chunks[neighbourChunkIndex];
+            if (neighbourChunk->blockLight[neighbourBlockIndex] + 1 < level &&
+                !isBlockOpaque(getChunkBlock(neighbourChunk, neighbourBlockIndex)))
+            {
+                setBlockLight(
+                    neighbourChunkIndex,
+                    neighbourBlockIndex,
+                    neighbourLocation,
+                    static_cast<std::uint8_t>(level - 1),
+                    color);
+                lightAddQueue.push_back(neighbourLocation);
+                changedBlockCount++;
+            }
+        }
     }
+
+    lightUpdateBlockCount = changedBlockCount;
 }
 
-VSChunkManager::VSChunk* VSChunkManager::createChunk() const
+std::uint8_t VSChunkManager::VSSunLightRegion::get(const glm::ivec3& zeroBaseLocation) const
 {
-    auto* chunk = new VSChunk();
-
-    chunk->blocks.resize(getChunkBlockCount(), VS_DEFAULT_BLOCK_ID);
-    chunk->bIsBlockVisible.resize(getChunkBlockCount(), false);
-    chunk->lightLevel.resize(getChunkBlockCount(), 0.F);
-    chunk->lightColor.resize(getChunkBlockCount(), {0.F, 0.F, 0.F});
-
-    return chunk;
+    const auto regionLocation = zeroBaseLocation - origin;
+    return levels
+        [regionLocation.x + regionLocation.y * size.x + regionLocation.z * size.x * size.y];
 }
 
-void VSChunkManager::deleteChunk(VSChunk* chunk)
+std::size_t VSChunkManager::VSBlockLightRegion::getIndex(const glm::ivec3& zeroBaseLocation) const
 {
-    delete chunk;
+    const auto regionLocation = zeroBaseLocation - origin;
+    return regionLocation.x + regionLocation.y * size.x + regionLocation.z * size.x * size.y;
 }
 
-void VSChunkManager::updateShadows(std::size_t chunkIndex)
+std::uint8_t
+VSChunkManager::VSBlockLightRegion::getLevel(const glm::ivec3& zeroBaseLocation) const
 {
-    auto* const chunk = chunks[chunkIndex];
-    bool expectedShadows = true;
-    // check if dirty after checking for shadows to avoid race conditions
-    // only allow hardware_concurrency active chunk updates
-    if (activeShadowBuildTasks.size() < maxShadowUpdateThreads &&
-        chunk->bShouldRebuildShadows.compare_exchange_weak(expectedShadows, false))
-    {
-        if (activeShadowBuildTasks.count(chunk) != 0)
-        {
-            activeShadowBuildTasks[chunk]->cancel();
-            activeShadowBuildTasks.erase(chunk);
-        }
-
-        const auto shadowUpdate = VSShadwoChunkUpdate::create(
-            [this](
-                const std::atomic<bool>& bShouldCancel,
-                std::atomic<bool>& bIsReady,
-                std::size_t chunkIndex) {
-                return this->chunkUpdateShadow(bShouldCancel, bIsReady, chunkIndex);
-            },
-            chunkIndex);
-
-        activeShadowBuildTasks.emplace(chunk, shadowUpdate);
-    }
-
-    if (activeShadowBuildTasks.count(chunk) != 0)
-    {
-        const auto shadowTask = activeShadowBuildTasks[chunk];
-        if (shadowTask->isReady())
-        {
-            const auto chunkDistanceField = shadowTask->getResult();
-            activeShadowBuildTasks.erase(chunk);
-
-            const auto textureBlockLocation = chunk->chunkLocation +
-                                              (glm::vec3(worldSize.x, 0.F, worldSize.z) / 2.F) -
-                                              (glm::vec3(chunkSize.x, 0.F, chunkSize.z) / 2.F);
-
-            glBindTexture(GL_TEXTURE_3D, shadowTexture);
-
-            glTexSubImage3D(
-                GL_TEXTURE_3D,
-                0,
-                textureBlockLocation.x,
-                textureBlockLocation.y,
-                textureBlockLocation.z,
-                chunkSize.x,
-                chunkSize.y,
-                chunkSize.z,
-                GL_RED,
-                GL_FLOAT,
-                chunkDistanceField.data());
-        }
-    }
+    return levels[getIndex(zeroBaseLocation)];
 }
 
-std::vector<float> VSChunkManager::chunkUpdateShadow(
-    const std::atomic<bool>& bShouldCancel,
-    std::atomic<bool>& bIsReady,
-    std::size_t chunkIndex) const
+glm::vec3
+VSChunkManager::VSBlockLightRegion::getBlockColor(const glm::ivec3& zeroBaseLocation) const
 {
-    const auto chunkCoords = chunkIndexToChunkCoordinates(chunkIndex);
-
-    std::vector<VSChunk::VSVisibleBlockInfo> relevantVisibleBlocks;
+    // Only air and emitters have a level, locations outside the world stay 0
+    glm::vec3 colorSum(0.F);
+    std::uint32_t levelSum = 0;
+    const auto addSample = [&](const glm::ivec3& location) {
+        const auto index = getIndex(location);
+        const auto level = levels[index];
+        const auto color = colors[index];
+        colorSum += glm::vec3(color & 0xFFU, (color >> 8U) & 0xFFU, (color >> 16U) & 0xFFU) *
+                    static_cast<float>(level);
+        levelSum += level;
+    };
+
+    addSample(zeroBaseLocation);
+    for (const auto& offset : blockLightNeighbourOffsets)
+    {
+        addSample(zeroBaseLocation + offset);
+    }
 
-    // TODO this wont work anymore if the terrain becomes more complex
-    // overhangs or floating stuff will cause issues
-    const std::int32_t chunkRadius =
-        1;  // glm::min(1, 128 / static_cast<int>(glm::sqrt(chunkSize.x * chunkSize.x +
-    // chunkSize.z * chunkSize.z)));
+    return levelSum != 0 ? colorSum / static_cast<float>(levelSum) : glm::vec3(0.F);
+}
 
-    for (int x = glm::max(chunkCoords.x - chunkRadius, 0);
-         x <= glm::min(chunkCoords.x + chunkRadius, chunkCount.x - 1);
-         x++)
+VSChunkManager::VSBlockLightRegion VSChunkManager::copyBlockLight(std::size_t chunkIndex) const
+{
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    const glm::ivec3 chunkOrigin(
+        chunkCoordinates.x * chunkSize.x, 0, chunkCoordinates.y * chunkSize.z);
+
+    VSBlockLightRegion region;
+    region.origin = chunkOrigin - glm::ivec3(1);
+    region.size = chunkSize + glm::ivec3(2);
+    const auto regionBlockCount =
+        static_cast<std::size_t>(region.size.x) * region.size.y * region.size.z;
+    region.levels.assign(regionBlockCount, 0);
+    region.colors.assign(regionBlockCount, 0);
+    region.isAir.assign(regionBlockCount, false);
+
+    // The chunk and its eight neighbours, every section is locked once for its overlap
+    const auto regionMin = glm::max(region.origin, glm::ivec3(0));
+    const auto regionMax = glm::min(region.origin + region.size, worldSize);
+    const auto minChunk = regionMin / glm::ivec3(chunkSize.x, 1, chunkSize.z);
+    const auto maxChunk = (regionMax - 1) / glm::ivec3(chunkSize.x, 1, chunkSize.z);
+
+    std::shared_lock lock(blockLightMutex);
+    for (int chunkZ = minChunk.z; chunkZ <= maxChunk.z; chunkZ++)
     {
-        for (int y = glm::max(chunkCoords.y - chunkRadius, 0);
-             y <= glm::min(chunkCoords.y + chunkRadius, chunkCount.y - 1);
-             y++)
+        for (int chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++)
         {
-            // abort calculations if canceled
-            if (bShouldCancel)
-            {
-                return {};
-            }
-            const auto* neighbourChunk = chunks[chunkCoordinatesToChunkIndex({x, y})];
-            for (const auto& visibleBlockInfos : neighbourChunk->visibleBlockInfos)
+            const auto* chunk = chunks[chunkCoordinatesToChunkIndex({chunkX, chunkZ})];
+            const glm::ivec3 otherOrigin(chunkX * chunkSize.x, 0, chunkZ * chunkSize.z);
+            const auto overlapMin = glm::max(regionMin, otherOrigin);
+            const auto overlapMax = glm::min(regionMax, otherOrigin + chunkSize);
+
+            for (std::size_t sectionIndex = 0; sectionIndex < chunk->sections.size();
+                 sectionIndex++)
             {
-                relevantVisibleBlocks.insert(
-                    relevantVisibleBlocks.end(),
-                    visibleBlockInfos.begin(),
-                    visibleBlockInfos.end());
+                const VSBlockStorage::VSReadLock section(chunk->sections[sectionIndex]);
+                const int sectionBegin = sectionIndex * sectionHeight;
+                const int sectionEnd = glm::min(sectionBegin + sectionHeight, chunkSize.y);
+                for (int z = overlapMin.z; z < overlapMax.z; z++)
+                {
+                    for (int y = sectionBegin; y < sectionEnd; y++)
+                    {
+                        for (int x = overlapMin.x; x < overlapMax.x; x++)
+                        {
+                            const glm::ivec3 blockCoords(x - otherOrigin.x, y, z - otherOrigin.z);
+                            const auto blockIndex = blockCoordinatesToBlockIndex(blockCoords);
+                            const auto regionIndex = region.getIndex({x, y, z});
+                            region.isAir[regionIndex] =
+                                section.get(blockCoordinatesToSectionBlockIndex(blockCoords)) ==
+                                VS_DEFAULT_BLOCK_ID;
+
+                            const auto level = chunk->blockLight[blockIndex];
+                            region.levels[regionIndex] = level;
+                            if (level != 0)
+                            {
+                                const auto color = glm::uvec3(glm::round(
+                                    glm::clamp(chunk->lightColor[blockIndex], 0.F, 255.F)));
+                                region.colors[regionIndex] =
+                                    color.r | (color.g << 8U) | (color.b << 16U);
+                            }
+                        }
+                    }
+                }
             }
         }
     }
+    return region;
+}
 
-    auto* const chunk = chunks[chunkIndex];
-
-    std::vector<float> chunkDistanceField;
-    chunkDistanceField.resize(getChunkBlockCount());
+std::int16_t VSChunkManager::getColumnHeight(int x, int z) const
+{
+    const auto chunkCoordinates = worldCoordinatesToChunkCoordinates({x, 0, z});
+    const auto* chunk = chunks[chunkCoordinatesToChunkIndex(chunkCoordinates)];
+    return chunk->heightmap
+        [(x - chunkCoordinates.x * chunkSize.x) +
+         (z - chunkCoordinates.y * chunkSize.z) * chunkSize.x];
+}
 
-    const auto chunkToWorld = chunk->chunkLocation + glm::vec3(0.5F) - glm::vec3(chunkSize) / 2.F;
+void VSChunkManager::updateColumnHeight(VSChunk* chunk, std::size_t blockIndex, VSBlockID blockID)
+{
+    const auto blockCoordinates = blockIndexToBlockCoordinates(blockIndex);
+    auto& columnHeight = chunk->heightmap[blockCoordinates.x + blockCoordinates.z * chunkSize.x];
 
-    for (std::size_t blockIndex = 0; blockIndex < getChunkBlockCount(); blockIndex++)
+    if (isBlockOpaque(blockID))
     {
-        // abort calculations if canceled
-        if (bShouldCancel)
+        if (blockCoordinates.y >= columnHeight)
         {
-            return {};
+            columnHeight = static_cast<std::int16_t>(blockCoordinates.y + 1);
         }
-        glm::vec3 samplePos = chunkToWorld + glm::vec3(blockIndexToBlockCoordinates(blockIndex));
-
-        float distance = std::numeric_limits<float>::max();
+        return;
+    }
 
-        if (chunk->blocks[blockIndex] != VS_DEFAULT_BLOCK_ID)
+    // The highest block was removed, search the next one below. Every section is locked once.
+    if (blockCoordinates.y + 1 == columnHeight)
+    {
+        int y = blockCoordinates.y - 1;
+        while (y >= 0)
         {
-            if (chunk->bIsBlockVisible[blockIndex])
-            {
-                distance = 0.F;
-            }
-            else
+            const int sectionIndex = y / sectionHeight;
+            const int sectionBegin = sectionIndex * sectionHeight;
+            const VSBlockStorage::VSReadLock section(chunk->sections[sectionIndex]);
+            while (y >= sectionBegin &&
+                   !isBlockOpaque(section.get(blockCoordinatesToSectionBlockIndex(
+                       {blockCoordinates.x, y, blockCoordinates.z}))))
             {
-                distance = -0.5F;
+                y--;
             }
-        }
-        else
-        {
-            for (const auto& blockCandidate : relevantVisibleBlocks)
+            if (y >= sectionBegin)
             {
-                distance =
-                    glm::min(distance, glm::length2(samplePos - blockCandidate.locationWorldSpace));
+                break;
             }
-            distance = glm::sqrt(distance);
         }
-
-        chunkDistanceField[blockIndex] = distance;
+        columnHeight = static_cast<std::int16_t>(y + 1);
     }
-
-    bIsReady = true;
-
-    return chunkDistanceField;
 }
 
-void VSChunkManager::updateVisibleBlocks(std::size_t chunkIndex)
+VSChunkManager::VSSunLightRegion VSChunkManager::computeSunLight(
+    const std::atomic<bool>& bShouldCancel,
+    std::size_t chunkIndex) const
 {
-    auto* const chunk = chunks[chunkIndex];
-    bool bIsDirtyExpected = true;
-    // check if dirty after checking for shadows to avoid race conditions
-    // only allow hardware_concurrency active chunk updates
-    if (activeVisibilityBuildTasks.size() < maxShadowUpdateThreads &&
-        chunk->bIsDirty.compare_exchange_weak(bIsDirtyExpected, false))
+    const auto chunkCoordinates = chunkIndexToChunkCoordinates(chunkIndex);
+    const glm::ivec3 chunkOrigin(
+        chunkCoordinates.x * chunkSize.x, 0, chunkCoordinates.y * chunkSize.z);
+
+    // Sunlight reaches at most maxSunLight - 1 blocks below the heightmap, so everything that
+    // lights the chunk or its direct neighbours lies within maxSunLight blocks
+    const glm::ivec3 border(maxSunLight, 0, maxSunLight);
+    const auto regionMin = glm::max(chunkOrigin - border, glm::ivec3(0));
+    const auto regionMax = glm::min(chunkOrigin + chunkSize + border, worldSize);
+
+    VSSunLightRegion region;
+    region.origin = regionMin;
+    region.size = regionMax - regionMin;
+    region.levels.resize(region.size.x * region.size.y * region.size.z, 0);
+
+    const auto regionIndex = [&region](int x, int y, int z) {
+        return x + y * region.size.x + z * region.size.x * region.size.y;
+    };
+
+    std::vector<std::int16_t> columnHeights(region.size.x * region.size.z);
+    for (int z = 0; z < region.size.z; z++)
     {
-        if (activeVisibilityBuildTasks.count(chunk) != 0)
+        for (int x = 0; x < region.size.x; x++)
         {
-            activeVisibilityBuildTasks[chunk]->cancel();
-            activeVisibilityBuildTasks.erase(chunk);
+            columnHeights[x + z * region.size.x] =
+                getColumnHeight(region.origin.x + x, region.origin.z + z);
         }
+    }
 
-        const auto visibilityUpdate = VSVisibilityChunkUpdate::create(
-            [this](
-                const std::atomic<bool>& bShouldCancel,
-                std::atomic<bool>& bIsReady,
-                std::size_t chunkIndex) {
-                return this->chunkUpdateVisibility(bShouldCancel, bIsReady, chunkIndex);
-            },
-            chunkIndex);
-
-        activeVisibilityBuildTasks.emplace(chunk, visibilityUpdate);
+    // Air above the heightmap is in full sunlight
+    for (int z = 0; z < region.size.z; z++)
+    {
+        for (int x = 0; x < region.size.x; x++)
+        {
+            for (int y = columnHeights[x + z * region.size.x]; y < region.size.y; y++)
+            {
+                region.levels[regionIndex(x, y, z)] = maxSunLight;
+            }
+        }
     }
 
-    if (activeVisibilityBuildTasks.count(chunk) != 0)
+    // Air below the heightmap, unpacked from the chunks the region overlaps
+    std::vector<bool> isAir(region.levels.size(), false);
+    std::vector<VSBlockID> chunkBlocks(getChunkBlockCount());
+    const auto minChunk = regionMin / glm::ivec3(chunkSize.x, 1, chunkSize.z);
+    const auto maxChunk = (regionMax - 1) / glm::ivec3(chunkSize.x, 1, chunkSize.z);
+    for (int chunkZ = minChunk.z; chunkZ <= maxChunk.z; chunkZ++)
     {
-        const auto visiblityTask = activeVisibilityBuildTasks[chunk];
-        if (visiblityTask->isReady())
+        for (int chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++)
         {
-            chunk->visibleBlockInfos = visiblityTask->getResult();
-            activeVisibilityBuildTasks.erase(chunk);
+            if (bShouldCancel)
+            {
+                return {};
+            }
 
-            // update shadows for us and neighbours
-            // TODO duplicate code (see updateShadows)
-            const auto chunkCoords = chunkIndexToChunkCoordinates(chunkIndex);
-            const std::int32_t chunkRadius = 1;
-            for (int x = glm::max(chunkCoords.x - chunkRadius, 0);
-                 x <= glm::min(chunkCoords.x + chunkRadius, chunkCount.x - 1);
-                 x++)
-            {
-                for (int y = glm::max(chunkCoords.y - chunkRadius, 0);
-                     y <= glm::min(chunkCoords.y + chunkRadius, chunkCount.y - 1);
-                     y++)
+            copyChunkBlocks(
+                chunks[chunkCoordinatesToChunkIndex({chunkX, chunkZ})], chunkBlocks.data());
+
+            const glm::ivec3 otherOrigin(chunkX * chunkSize.x, 0, chunkZ * chunkSize.z);
+            const auto overlapMin = glm::max(regionMin, otherOrigin);
+            const auto overlapMax = glm::min(regionMax, otherOrigin + chunkSize);
+            for (int z = overlapMin.z; z < overlapMax.z; z++)
+            {
+                for (int x = overlapMin.x; x < overlapMax.x; x++)
                 {
-                    auto* neighbourChunk = chunks[chunkCoordinatesToChunkIndex({x, y})];
-                    neighbourChunk->bShouldRebuildShadows = true;
+                    const auto columnHeight =
+                        columnHeights[(x - regionMin.x) + (z - regionMin.z) * region.size.x];
+                    for (int y = 0; y < columnHeight; y++)
+                    {
+                        const auto blockIndex = blockCoordinatesToBlockIndex(
+                            {x - otherOrigin.x, y, z - otherOrigin.z});
+                        isAir[regionIndex(x - regionMin.x, y, z - regionMin.z)] =
+                            !isBlockOpaque(chunkBlocks[blockIndex]);
+                    }
                 }
             }
         }
     }
-}
 
-VSChunkManager::VSChunk::VSVisibleBlockInfos VSChunkManager::chunkUpdateVisibility(
-    const std::atomic<bool>& bShouldCancel,
-    std::atomic<bool>& bIsReady,
-    std::size_t chunkIndex) const
-{
-    auto* const chunk = chunks[chunkIndex];
+    // Only sunlit blocks next to a shadowed column can light anything, each column seeds the
+    // range up to the highest neighbour column
+    const std::array<glm::ivec2, 4> columnNeighbourOffsets = {
+        glm::ivec2(1, 0),
+        glm::ivec2(-1, 0),
+        glm::ivec2(0, 1),
+        glm::ivec2(0, -1)};
+    std::vector<int> queue;
+    for (int z = 0; z < region.size.z; z++)
+    {
+        for (int x = 0; x < region.size.x; x++)
+        {
+            const int columnHeight = columnHeights[x + z * region.size.x];
+            int seedEnd = columnHeight;
+            for (const auto& offset : columnNeighbourOffsets)
+            {
+                const auto neighbourX = x + offset.x;
+                const auto neighbourZ = z + offset.y;
+                if (neighbourX >= 0 && neighbourX < region.size.x && neighbourZ >= 0 &&
+                    neighbourZ < region.size.z)
+                {
+                    seedEnd = glm::max(
+                        seedEnd,
+                        static_cast<int>(columnHeights[neighbourX + neighbourZ * region.size.x]));
+                }
+            }
 
-    const auto chunkBlockCount = getChunkBlockCount();
+            for (int y = columnHeight; y < seedEnd; y++)
+            {
+                queue.push_back(regionIndex(x, y, z));
+            }
+        }
+    }
 
-    auto result = VSChunkManager::VSChunk::VSVisibleBlockInfos();
+    if (bShouldCancel)
+    {
+        return {};
+    }
 
-    for (int blockIndex = 0; blockIndex < static_cast<int>(chunkBlockCount); blockIndex++)
+    const std::array<int, 6> neighbourOffsets = {
+        1,
+        -1,
+        region.size.x,
+        -region.size.x,
+        region.size.x * region.size.y,
+        -region.size.x * region.size.y};
+    for (std::size_t i = 0; i < queue.size(); i++)
     {
-        if (bShouldCancel)
+        const auto index = queue[i];
+        const auto level = region.levels[index];
+        if (level <= 1)
         {
-            return {};
+            continue;
         }
 
-        if (chunk->blocks[blockIndex] != VS_DEFAULT_BLOCK_ID)
+        const int x = index % region.size.x;
+        const int y = (index / region.size.x) % region.size.y;
+        const int z = index / (region.size.x * region.size.y);
+        const std::array<bool, 6> bIsNeighbourInRegion = {
+            x + 1 < region.size.x,
+            x > 0,
+            y + 1 < region.size.y,
+            y > 0,
+            z + 1 < region.size.z,
+            z > 0};
+
+        for (std::size_t neighbour = 0; neighbour < neighbourOffsets.size(); neighbour++)
         {
-            const auto blockType = isBlockVisible(chunkIndex, blockIndex);
-            if (blockType != 0)
+            if (!bIsNeighbourInRegion[neighbour])
             {
-                const auto offset = chunk->chunkLocation +
-                                    glm::vec3(blockIndexToBlockCoordinates(blockIndex)) +
-                                    glm::vec3(0.5F) - glm::vec3(chunkSize) / 2.F;
-
-                const auto lighInfo = getLightInformation(offset);
-
-                const auto blockInfo = VSChunk::VSVisibleBlockInfo{
-                    offset,
-                    chunk->blocks[blockIndex],
-                    lighInfo[0],
-                    lighInfo[1],
-                    lighInfo[2],
-                    lighInfo[3],
-                    lighInfo[4],
-                    lighInfo[5],
-                    chunk->lightColor[blockIndex]};
-                result[blockType].emplace_back(blockInfo);
-                chunk->bIsBlockVisible[blockIndex] = true;
+                continue;
             }
-            else
+
+            const auto neighbourIndex = index + neighbourOffsets[neighbour];
+            if (isAir[neighbourIndex] && region.levels[neighbourIndex] + 1 < level)
             {
-                chunk->bIsBlockVisible[blockIndex] = false;
+                region.levels[neighbourIndex] = static_cast<std::uint8_t>(level - 1);
+                queue.push_back(neighbourIndex);
             }
         }
-        else
-        {
-            chunk->bIsBlockVisible[blockIndex] = false;
-        }
     }
 
-    bIsReady = true;
-
-    return result;
-};
-
-std::uint8_t VSChunkManager::isBlockVisible(std::size_t chunkIndex, std::size_t blockIndex) const
-{
-    const auto blockCoords = blockIndexToBlockCoordinates(blockIndex);
-
-    if (blockCoords.x == 0 || blockCoords.x == chunkSize.x - 1 || blockCoords.y == 0 ||
-        blockCoords.y == chunkSize.y - 1 || blockCoords.z == 0 || blockCoords.z == chunkSize.z - 1)
-    {
-        return isBorderBlockVisible(chunkIndex, blockCoords);
-    }
-    return isCenterBlockVisible(chunkIndex, blockCoords);
+    return region;
 }
 
-std::uint8_t VSChunkManager::isCenterBlockVisible(
-    std::size_t chunkIndex,
-    const glm::ivec3& blockCoordinates) const
+std::uint32_t VSChunkManager::getLightInformationForFace(
+    const glm::vec3& blockWorldCoordinates,
+    const std::array<glm::vec3, 4>& corners,
+    const VSBlockLightRegion& blockLight,
+    const VSSunLightRegion* sunLight) const
 {
-    const auto& blocks = chunks[chunkIndex]->blocks;
-
-    const auto right = glm::ivec3(blockCoordinates.x + 1, blockCoordinates.y, blockCoordinates.z);
-    const auto left = glm::ivec3(blockCoordinates.x - 1, blockCoordinates.y, blockCoordinates.z);
+    std::uint32_t result = 0;
+    int currentOffset = 0;
+    for (const auto& corner : corners)
+    {
+        const auto currentCorner = blockWorldCoordinates + corner;
+        std::uint32_t sampleSum = 0;
 
-    const auto top = glm::ivec3(blockCoordinates.x, blockCoordinates.y + 1, blockCoordinates.z);
-    const auto bottom = glm::ivec3(blockCoordinates.x, blockCoordinates.y - 1, blockCoordinates.z);
+        for (const auto& sampleOffsets : corners)
+        {
+            const auto sample = currentCorner + sampleOffsets;
+            // TODO code dupe getBlock()
+            sampleSum += computeLightSample(
+                glm::ivec3(glm::floor(sample)) + worldSizeHalf, blockLight, sunLight);
+        }
 
-    const auto front = glm::ivec3(blockCoordinates.x, blockCoordinates.y, blockCoordinates.z + 1);
-    // TODO is + 1 or -1 back?
-    const auto back = glm::ivec3(blockCoordinates.x, blockCoordinates.y, blockCoordinates.z - 1);
+        result |= (cornerSampleSumToLight(sampleSum) << currentOffset);
 
-    std::uint8_t encoded = 0;
-    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(right)] == VS_DEFAULT_BLOCK_ID)
-               << VSCubeFace::Right;
-    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(left)] == VS_DEFAULT_BLOCK_ID)
-               << VSCubeFace::Left;
-    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(top)] == VS_DEFAULT_BLOCK_ID)
-               << VSCubeFace::Top;
-    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(bottom)] == VS_DEFAULT_BLOCK_ID)
-               << VSCubeFace::Bottom;
-    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(front)] == VS_DEFAULT_BLOCK_ID)
-               << VSCubeFace::Front;
-    encoded |= static_cast<int>(blocks[blockCoordinatesToBlockIndex(back)] == VS_DEFAULT_BLOCK_ID)
-               << VSCubeFace::Back;
+        currentOffset += 8;
+    }
+    return result;
+}
 
-    return encoded;
+std::size_t VSChunkManager::getMaxActiveUpdateCount() const
+{
+    return VSApp::getInstance()->getThreadPool()->getThreadCount() * maxActiveUpdatesPerThread;
 }
 
-std::uint8_t VSChunkManager::isBorderBlockVisible(
-    std::size_t chunkIndex,
-    const glm::ivec3& blockCoordinates) const
+std::size_t VSChunkManager::getChunkSectionCount() const
 {
-    const auto blockWorldCoordinates =
-        blockCoordinatesToWorldCoordinates(chunkIndex, blockCoordinates);
-    if (isAtWorldBorder(blockWorldCoordinates))
-    {
-        if (blockWorldCoordinates.y + 1 < worldSizeHalf.y &&
-            getBlock(blockWorldCoordinates + glm::ivec3(0, 1, 0)) == VS_DEFAULT_BLOCK_ID)
-        {
-            // always use a full block at the world border for now
-            return 63;
-        }
-        else
-        {
-            return 0;
-        }
-    }
+    return (chunkSize.y + sectionHeight - 1) / sectionHeight;
+}
 
-    const auto right = blockWorldCoordinates + glm::ivec3(1, 0, 0);
+std::size_t VSChunkManager::getSectionBlockCount() const
+{
+    return chunkSize.x * sectionHeight * chunkSize.z;
+}
 
-    const auto left = blockWorldCoordinates + glm::ivec3(-1, 0, 0);
+glm::ivec3 VSChunkManager::getChunkBrickCount() const
+{
+    return (chunkSize + brickSize - 1) / brickSize;
+}
 
-    const auto top = blockWorldCoordinates + glm::ivec3(0, 1, 0);
+std::size_t VSChunkManager::blockCoordinatesToBrickIndex(const glm::ivec3& blockCoords) const
+{
+    const auto brickCount = getChunkBrickCount();
+    const auto brick = blockCoords / brickSize;
 
-    const auto bottom = blockWorldCoordinates + glm::ivec3(0, -1, 0);
+    return brick.x + brick.y * brickCount.x + brick.z * brickCount.x * brickCount.y;
+}
 
-    const auto front = blockWorldCoordinates + glm::ivec3(0, 0, 1);
+std::tuple<std::size_t, std::size_t>
+VSChunkManager::blockIndexToSectionAndSectionBlockIndex(std::size_t blockIndex) const
+{
+    const int width = chunkSize.x;
+    const int height = chunkSize.y;
 
-    // TODO is + 1 or -1 back?
-    const auto back = blockWorldCoordinates + glm::ivec3(0, 0, -1);
+    const std::size_t x = blockIndex % width;
+    const std::size_t y = (blockIndex / width) % height;
+    const std::size_t z = blockIndex / (width * height);
 
-    std::uint8_t encoded = 0;
-    encoded |= static_cast<int>(getBlock(right) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Right;
-    encoded |= static_cast<int>(getBlock(left) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Left;
-    encoded |= static_cast<int>(getBlock(top) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Top;
-    encoded |= static_cast<int>(getBlock(bottom) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Bottom;
-    encoded |= static_cast<int>(getBlock(front) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Front;
-    encoded |= static_cast<int>(getBlock(back) == VS_DEFAULT_BLOCK_ID) << VSCubeFace::Back;
+    return {y / sectionHeight, x + (y % sectionHeight) * width + z * width * sectionHeight};
+}
 
-    return encoded;
+std::size_t
+VSChunkManager::blockCoordinatesToSectionBlockIndex(const glm::ivec3& blockCoords) const
+{
+    return blockCoords.x + (blockCoords.y % sectionHeight) * chunkSize.x +
+           blockCoords.z * chunkSize.x * sectionHeight;
 }
 
-bool VSChunkManager::isAtWorldBorder(const glm::ivec3& blockWorldCoordinates) const
+VSBlockID VSChunkManager::getChunkBlock(const VSChunk* chunk, std::size_t blockIndex) const
 {
-    return blockWorldCoordinates.x == -worldSizeHalf.x ||
-           blockWorldCoordinates.x == worldSizeHalf.x - 1 ||
-           blockWorldCoordinates.y == -worldSizeHalf.y ||
-           blockWorldCoordinates.y == worldSizeHalf.y - 1 ||
-           blockWorldCoordinates.z == -worldSizeHalf.z ||
-           blockWorldCoordinates.z == worldSizeHalf.z - 1;
+    const auto [sectionIndex, sectionBlockIndex] =
+        blockIndexToSectionAndSectionBlockIndex(blockIndex);
+    return chunk->sections[sectionIndex].get(sectionBlockIndex);
 }
 
+VSBlockID VSChunkManager::setChunkBlock(VSChunk* chunk, std::size_t blockIndex, VSBlockID blockID)
+{
+    const auto [sectionIndex, sectionBlockIndex] =
+        blockIndexToSectionAndSectionBlockIndex(blockIndex);
+    return chunk->sections[sectionIndex].set(sectionBlockIndex, blockID);
+}
 
-std::array<std::uint32_t, 6>
-VSChunkManager::getLightInformation(const glm::vec3& blockCoordinates) const
+void VSChunkManager::copyChunkBlocks(const VSChunk* chunk, VSBlockID* outBlockIDs) const
 {
-    std::array<std::uint32_t, 6> result;
+    std::vector<VSBlockID> sectionBlocks(getSectionBlockCount());
+
+    for (std::size_t sectionIndex = 0; sectionIndex < chunk->sections.size(); sectionIndex++)
+    {
+        const auto& section = chunk->sections[sectionIndex];
+        const int sectionBegin = sectionIndex * sectionHeight;
+        const int sectionEnd = glm::min(sectionBegin + sectionHeight, chunkSize.y);
 
-    const auto right = getLightInformationForFace(
-        blockCoordinates,
-        {glm::vec3{0.5F, -0.5F, -0.5F},
-         glm::vec3{0.5F, 0.5F, -0.5F},
-         glm::vec3{0.5F, -0.5F, 0.5F},
-         glm::vec3{0.5F, 0.5F, 0.5F}});
-    result[0] = right;
-
-    const auto left = getLightInformationForFace(
-        blockCoordinates,
-        {glm::vec3{-0.5F, -0.5F, -0.5F},
-         glm::vec3{-0.5F, 0.5F, -0.5F},
-         glm::vec3{-0.5F, -0.5F, 0.5F},
-         glm::vec3{-0.5F, 0.5F, 0.5F}});
-    result[1] = left;
-
-    const auto top = getLightInformationForFace(
-        blockCoordinates,
-        {glm::vec3{-0.5F, 0.5F, -0.5F},
-         glm::vec3{0.5F, 0.5F, -0.5F},
-         glm::vec3{-0.5F, 0.5F, 0.5F},
-         glm::vec3{0.5F, 0.5F, 0.5F}});
-    result[2] = top;
-
-    const auto bottom = getLightInformationForFace(
-        blockCoordinates,
-        {glm::vec3{-0.5F, -0.5F, -0.5F},
-         glm::vec3{0.5F, -0.5F, -0.5F},
-         glm::vec3{-0.5F, -0.5F, 0.5F},
-         glm::vec3{0.5F, -0.5F, 0.5F}});
-    result[3] = bottom;
-
-    const auto front = getLightInformationForFace(
-        blockCoordinates,
-        {glm::vec3{-0.5F, -0.5F, 0.5F},
-         glm::vec3{0.5F, -0.5F, 0.5F},
-         glm::vec3{-0.5F, 0.5F, 0.5F},
-         glm::vec3{0.5F, 0.5F, 0.5F}});
-    result[4] = front;
-
-    const auto back = getLightInformationForFace(
-        blockCoordinates,
-        {glm::vec3{-0.5F, -0.5F, -0.5F},
-         glm::vec3{0.5F, -0.5F, -0.5F},
-         glm::vec3{-0.5F, 0.5F, -0.5F},
-         glm::vec3{0.5F, 0.5F, -0.5F}});
-    result[5] = back;
+        if (section.isUniform())
+        {
+            std::fill(sectionBlocks.begin(), sectionBlocks.end(), section.getUniformBlockID());
+        }
+        else
+        {
+            section.copyTo(sectionBlocks.data());
+        }
 
-    return result;
+        // Sections are stored x, y, z as well, so every x row can be copied as a whole
+        for (int z = 0; z < chunkSize.z; z++)
+        {
+            for (int y = sectionBegin; y < sectionEnd; y++)
+            {
+                const auto sectionRow =
+                    sectionBlocks.begin() + (y - sectionBegin) * chunkSize.x +
+                    z * chunkSize.x * sectionHeight;
+                std::copy(
+                    sectionRow,
+                    sectionRow + chunkSize.x,
+                    outBlockIDs + blockCoordinatesToBlockIndex({0, y, z}));
+            }
+        }
+    }
 }
 
-std::uint32_t VSChunkManager::getLightInformationForFace(
-    const glm::vec3& blockWorldCoordinates,
-    const std::array<glm::vec3, 4>& corners) const
+void VSChunkManager::assignChunkBlocks(VSChunk* chunk, const VSBlockID* blockIDs)
 {
-    std::uint32_t result = 0;
-    int currentOffset = 0;
-    for (const auto& corner : corners)
+    std::vector<VSBlockID> sectionBlocks(getSectionBlockCount());
+
+    for (std::size_t sectionIndex = 0; sectionIndex < chunk->sections.size(); sectionIndex++)
     {
-        const auto currentCorner = blockWorldCoordinates + corner;
-        float lightValue = 0;
+        const int sectionBegin = sectionIndex * sectionHeight;
+        const int sectionEnd = glm::min(sectionBegin + sectionHeight, chunkSize.y);
 
-        for (const auto& sampleOffsets : corners)
+        std::fill(sectionBlocks.begin(), sectionBlocks.end(), VS_DEFAULT_BLOCK_ID);
+
+        for (int z = 0; z < chunkSize.z; z++)
         {
-            const auto sample = currentCorner + sampleOffsets;
-            if (isLocationInBounds(sample))
+            for (int y = sectionBegin; y < sectionEnd; y++)
             {
-                // TODO code dupe getBlock()
-                const auto zeroBaseLocation = glm::ivec3(glm::floor(sample)) + worldSizeHalf;
-                const auto [chunkIndex, blockIndex] =
-                    worldCoordinatesToChunkAndBlockIndex(zeroBaseLocation);
-                lightValue += chunks[chunkIndex]->blocks[blockIndex] != VS_DEFAULT_BLOCK_ID
-                                  ? 0.F
-                                  : chunks[chunkIndex]->lightLevel[blockIndex] + 8.F;
+                const auto* chunkRow = blockIDs + blockCoordinatesToBlockIndex({0, y, z});
+                std::copy(
+                    chunkRow,
+                    chunkRow + chunkSize.x,
+                    sectionBlocks.begin() + (y - sectionBegin) * chunkSize.x +
+                        z * chunkSize.x * sectionHeight);
             }
         }
-        lightValue /= corners.size();
 
-        std::uint8_t lightValueDeNorm = (glm::clamp(lightValue, 0.F, 32.F) / 32.F) * 255.F;
+        chunk->sections[sectionIndex].assign(sectionBlocks.data(), sectionBlocks.size());
+    }
 
-        result |= (lightValueDeNorm << currentOffset);
+    std::vector<std::uint8_t> brickBlockCounts(chunk->brickBlockCounts.size(), 0);
+    for (int z = 0; z < chunkSize.z; z++)
+    {
+        for (int y = 0; y < chunkSize.y; y++)
+        {
+            for (int x = 0; x < chunkSize.x; x++)
+            {
+                if (blockIDs[blockCoordinatesToBlockIndex({x, y, z})] != VS_DEFAULT_BLOCK_ID)
+                {
+                    brickBlockCounts[blockCoordinatesToBrickIndex({x, y, z})]++;
+                }
+            }
+        }
+    }
+    for (std::size_t brickIndex = 0; brickIndex < brickBlockCounts.size(); brickIndex++)
+    {
+        chunk->brickBlockCounts[brickIndex] = brickBlockCounts[brickIndex];
+    }
 
-        currentOffset += 8;
+    for (int z = 0; z < chunkSize.z; z++)
+    {
+        for (int x = 0; x < chunkSize.x; x++)
+        {
+            int y = chunkSize.y - 1;
+            while (y >= 0 && !isBlockOpaque(blockIDs[blockCoordinatesToBlockIndex({x, y, z})]))
+            {
+                y--;
+            }
+            chunk->heightmap[x + z * chunkSize.x] = static_cast<std::int16_t>(y + 1);
+        }
     }
-    return result;
 }
 
 std::size_t VSChunkManager::chunkCoordinatesToChunkIndex(const glm::ivec2& chunkCoordinates) const
@@ -39,8 +39,8 @@ void VSWorld::removeDrawable(IVSDrawable* drawable)
 
 void VSWorld::update()
 {
-    chunkManager->updateChunks();
-    previewChunkManager->updateChunks();
+    chunkManager->updateChunks(camera);
+    previewChunkManager->updateChunks(camera);
 }
 
 void VSWorld::draw(VSWorld* world)
@@ -72,101 +72,19 @@ void VSWorld::setCameraController(VSCameraController* newCameraController)
 glm::ivec3
 VSWorld::intersectRayWithBlock(glm::vec3 rayOrigin, glm::vec3 rayDirection, bool returnPrev)
 {
-    // Map to block coordinates
-    rayOrigin += getChunkManager()->getWorldSize() / 2;
-
-    rayDirection = glm::normalize(rayDirection);
-    int i = 0;
-    glm::ivec3 size = getChunkManager()->getWorldSize();
-    glm::ivec3 location(std::floor(rayOrigin.x), std::floor(rayOrigin.y), std::floor(rayOrigin.z));
-    glm::ivec3 previous(location);
-
-    // Voxel traversal algorithm
-    // Direction of increments
-    float stepX = (rayDirection.x >= 0) ? 1 : -1;
-    float stepY = (rayDirection.y >= 0) ? 1 : -1;
-    float stepZ = (rayDirection.z >= 0) ? 1 : -1;
-
-    // Distance to nearest voxel boundaries
-    float nextVoxelX =
-        location.x + stepX;  // times bin size if we ever decide to have different size than one
-    float nextVoxelY = location.y + stepY;
-    float nextVoxelZ = location.z + stepZ;
-
-    // The value of t at which the ray crosses the first vertical voxel boundary
-    float tMaxX = (rayDirection.x != 0) ? (nextVoxelX - rayOrigin.x) / rayDirection.x
-                                        : std::numeric_limits<float>::max();
-    float tMaxY = (rayDirection.y != 0) ? (nextVoxelY - rayOrigin.y) / rayDirection.y
-                                        : std::numeric_limits<float>::max();
-    float tMaxZ = (rayDirection.z != 0) ? (nextVoxelZ - rayOrigin.z) / rayDirection.z
-                                        : std::numeric_limits<float>::max();
-
-    float tDeltaX =
-        (rayDirection.x != 0) ? stepX / rayDirection.x : std::numeric_limits<float>::max();
-    float tDeltaY =
-        (rayDirection.y != 0) ? stepY / rayDirection.y : std::numeric_limits<float>::max();
-    float tDeltaZ =
-        (rayDirection.z != 0) ? stepZ / rayDirection.z : std::numeric_limits<float>::max();
-
-    while (i++ < 100)
+    const auto traceResult =
+        getChunkManager()->traceRay(rayOrigin, rayDirection, maxIntersectRayDistance);
+    if (!traceResult.bHasHit)
     {
-        location =
-            glm::ivec3(std::floor(rayOrigin.x), std::floor(rayOrigin.y), std::floor(rayOrigin.z));
-        if (location.x >= size.x || location.y >= size.y || location.z >= size.z)
-        {
-            // do nothing
-        }
-        else if (location.x < 0 || location.y < 0 || location.z < 0)
-        {
-            // do nothing
-        }
-        else
-        {
-            VSBlockID blockID = getChunkManager()->getBlock(location);
-            if (blockID != 0)
-            {
-                // back to world coordinates
-                if (returnPrev)
-                {
-                    return (previous - getChunkManager()->getWorldSize() / 2);
-                }
-                else
-                {
-                    return (location - getChunkManager()->getWorldSize() / 2);
-                }
-            }
-        }
-
-        previous = location;
-        if (tMaxX < tMaxY)
-        {
-            if (tMaxX < tMaxZ)
-            {
-                rayOrigin.x += stepX;
-                tMaxX += tDeltaX;
-            }
-            else
-            {
-                rayOrigin.z += stepZ;
-                tMaxZ += tDeltaZ;
-            }
-        }
-        else
-        {
-            if (tMaxY < tMaxZ)
-            {
-                rayOrigin.y += stepY;
-                tMaxY += tDeltaY;
-            }
-            else
-            {
-                rayOrigin.z += stepZ;
-                tMaxZ += tDeltaZ;
-            }
-        }
+        return glm::ivec3();
     }
 
-    return glm::vec3();
+    // The block in front of the hit face is the one the ray passed through before
+    if (returnPrev)
+    {
+        return traceResult.blockLocation + glm::ivec3(traceResult.hitNormal);
+    }
+    return traceResult.blockLocation;
 }
 
 glm::vec3 VSWorld::getDirectLightDir() const
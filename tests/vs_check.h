@@ -0,0 +1,37 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+
+// Headless checks of the world code, run by the voxelscape_checks executable (see
+// CMakeLists.txt). Checks register themselves with VS_CHECK and fail by throwing, which
+// VS_CHECK_EXPECT does with the failed condition and its location.
+namespace VSCheck
+{
+    using VSCheckFunction = std::function<void()>;
+
+    // Every registered check by name
+    std::map<std::string, VSCheckFunction>& getChecks();
+
+    struct VSCheckRegistration
+    {
+        VSCheckRegistration(const char* name, VSCheckFunction check);
+    };
+
+    [[noreturn]] void fail(const std::string& message, const char* file, int line);
+}  // namespace VSCheck
+
+#define VS_CHECK(name)                                                                             \
+    static void name();                                                                            \
+    static const VSCheck::VSCheckRegistration name##Registration(#name, &name);                    \
+    static void name()
+
+#define VS_CHECK_EXPECT(condition)                                                                 \
+    do                                                                                             \
+    {                                                                                              \
+        if (!(condition))                                                                          \
+        {                                                                                          \
+            VSCheck::fail(#condition, __FILE__, __LINE__);                                         \
+        }                                                                                          \
+    } while (false)
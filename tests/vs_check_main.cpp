@@ -0,0 +1,69 @@
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "core/vs_app.h"
+#include "core/vs_log.h"
+
+#include "vs_check.h"
+
+namespace VSCheck
+{
+    std::map<std::string, VSCheckFunction>& getChecks()
+    {
+        static std::map<std::string, VSCheckFunction> checks;
+        return checks;
+    }
+
+    VSCheckRegistration::VSCheckRegistration(const char* name, VSCheckFunction check)
+    {
+        getChecks().emplace(name, std::move(check));
+    }
+
+    void fail(const std::string& message, const char* file, int line)
+    {
+        throw std::runtime_error(std::string(file) + ":" + std::to_string(line) + ": " + message);
+    }
+}  // namespace VSCheck
+
+// Runs the check named by the first argument, or all of them without one
+int main(int argc, char** argv)
+{
+    // Only for the thread pool, no window is created
+    VSApp app;
+
+    std::ostringstream logStream;
+    VSLog::init(logStream);
+
+    int failedCheckCount = 0;
+    int checkCount = 0;
+    for (const auto& [name, check] : VSCheck::getChecks())
+    {
+        if (argc > 1 && name != argv[1])
+        {
+            continue;
+        }
+
+        checkCount++;
+        try
+        {
+            check();
+            std::cout << "[passed] " << name << "\n";
+        }
+        catch (const std::exception& exception)
+        {
+            failedCheckCount++;
+            std::cout << "[failed] " << name << ": " << exception.what() << "\n";
+        }
+    }
+
+    if (checkCount == 0)
+    {
+        std::cout << "No check named " << (argc > 1 ? argv[1] : "") << "\n";
+        return 1;
+    }
+
+    return failedCheckCount == 0 ? 0 : 1;
+}
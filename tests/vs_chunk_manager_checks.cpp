@@ -0,0 +1,281 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "world/generator/vs_terrain.h"
+#include "world/vs_chunk_manager.h"
+
+#include "vs_check.h"
+
+namespace
+{
+    constexpr std::uint32_t worldSeed = 1234;
+
+    void buildWorld(VSChunkManager& chunkManager)
+    {
+        chunkManager.setChunkDimensions({32, 128, 32}, {4, 4});
+        chunkManager.initializeChunks();
+        VSTerrainGeneration::buildMountains(&chunkManager, worldSeed);
+    }
+}  // namespace
+
+VS_CHECK(brick_counts_after_concurrent_edits)
+{
+    VSChunkManager chunkManager(false);
+    buildWorld(chunkManager);
+    VS_CHECK_EXPECT(chunkManager.validateBrickCounts());
+
+    // Every thread toggles blocks of the same small box, so writes to one block race
+    constexpr int editThreadCount = 4;
+    constexpr int editCount = 20000;
+    const glm::ivec3 editMin = {-6, 0, -6};
+    const glm::ivec3 editSize = {12, 12, 12};
+
+    std::vector<std::thread> editThreads;
+    for (int threadIndex = 0; threadIndex < editThreadCount; threadIndex++)
+    {
+        editThreads.emplace_back([&chunkManager, &editMin, &editSize, threadIndex]() {
+            std::mt19937 randomEngine(threadIndex);
+            std::uniform_int_distribution<int> offsetDistribution(0, editSize.x - 1);
+            for (int editIndex = 0; editIndex < editCount; editIndex++)
+            {
+                const auto location =
+                    editMin + glm::ivec3(
+                                  offsetDistribution(randomEngine),
+                                  offsetDistribution(randomEngine),
+                                  offsetDistribution(randomEngine));
+                const VSBlockID blockID = editIndex % 2 == 0 ? 1 : VS_DEFAULT_BLOCK_ID;
+                chunkManager.setBlock(glm::vec3(location), blockID);
+            }
+        });
+    }
+
+    // Structures write on the pool meanwhile, across the same box
+    const VSChunkManager::VSBuildingData build = {
+        editSize, std::vector<VSBlockID>(glm::compMul(editSize), 2)};
+    for (int placeIndex = 0; placeIndex < 20; placeIndex++)
+    {
+        chunkManager.placeStructures(
+            {{editMin, &build, placeIndex % 2 == 0}, {editMin + 32, &build, true}});
+        chunkManager.fillBlocks(editMin, editMin + editSize, VS_DEFAULT_BLOCK_ID);
+    }
+
+    for (auto& editThread : editThreads)
+    {
+        editThread.join();
+    }
+
+    VS_CHECK_EXPECT(chunkManager.validateBrickCounts());
+}
+
+VS_CHECK(trace_batch_matches_single_rays)
+{
+    VSChunkManager chunkManager(false);
+    buildWorld(chunkManager);
+
+    const auto worldSize = glm::vec3(chunkManager.getWorldSize());
+    std::mt19937 randomEngine(7);
+    std::uniform_real_distribution<float> unitDistribution(0.F, 1.F);
+    std::normal_distribution<float> directionDistribution;
+
+    constexpr std::size_t rayCount = 20000;
+    std::vector<VSChunkManager::VSRay> rays(rayCount);
+    for (auto& ray : rays)
+    {
+        ray.origin = glm::vec3(
+                         unitDistribution(randomEngine),
+                         unitDistribution(randomEngine),
+                         unitDistribution(randomEngine)) *
+                         worldSize -
+                     worldSize / 2.F;
+        ray.direction = glm::vec3(
+            directionDistribution(randomEngine),
+            directionDistribution(randomEngine),
+            directionDistribution(randomEngine));
+        ray.maxDistance = glm::length(worldSize);
+    }
+
+    std::vector<VSChunkManager::VSTraceResult> batchResults(rayCount);
+    chunkManager.traceRays(rays.data(), rayCount, batchResults.data());
+
+    std::size_t hitCount = 0;
+    for (std::size_t rayIndex = 0; rayIndex < rayCount; rayIndex++)
+    {
+        const auto& ray = rays[rayIndex];
+        const auto result = chunkManager.traceRay(ray.origin, ray.direction, ray.maxDistance);
+        const auto& batchResult = batchResults[rayIndex];
+        VS_CHECK_EXPECT(result.bHasHit == batchResult.bHasHit);
+        VS_CHECK_EXPECT(result.blockLocation == batchResult.blockLocation);
+        VS_CHECK_EXPECT(result.blockID == batchResult.blockID);
+        hitCount += result.bHasHit;
+    }
+
+    // The world is mostly solid below and air above, rays have to hit and miss
+    VS_CHECK_EXPECT(hitCount > 0 && hitCount < rayCount);
+}
+
+VS_CHECK(trace_benchmark)
+{
+    VSChunkManager chunkManager(false);
+    buildWorld(chunkManager);
+
+    const auto result =
+        chunkManager.runTraceBenchmark(100000, glm::normalize(glm::vec3(0.3F, 1.F, 0.2F)));
+    std::cout << "traceRay: " << result.raysPerSecond / 1e6F << " M rays/s, traceRays: "
+              << result.batchedRaysPerSecond / 1e6F
+              << " M rays/s, isSunVisible: " << result.sunQueriesPerSecond / 1e6F
+              << " M queries/s\n";
+    VS_CHECK_EXPECT(result.raysPerSecond > 0.F && result.batchedRaysPerSecond > 0.F);
+}
+
+VS_CHECK(visibility_kernels_match_reference)
+{
+    VSChunkManager chunkManager(false);
+    buildWorld(chunkManager);
+
+    auto comparison = chunkManager.compareVisibilityKernels();
+    std::cout << "Generated world: scalar " << comparison.scalarMicroseconds << " us, bitmask "
+              << comparison.bitmaskMicroseconds << " us per chunk\n";
+    VS_CHECK_EXPECT(comparison.bDoKernelsMatchReference);
+
+    // Random blocks, with widths that need several words per row
+    struct VSChunkDimensions
+    {
+        glm::ivec3 chunkSize;
+        glm::ivec2 chunkCount;
+    };
+    const VSChunkDimensions chunkDimensions[] = {
+        {{32, 64, 32}, {2, 2}}, {{62, 32, 62}, {2, 2}}, {{126, 32, 126}, {2, 2}}};
+
+    std::mt19937 randomEngine(11);
+    for (const auto& dimensions : chunkDimensions)
+    {
+        chunkManager.setChunkDimensions(dimensions.chunkSize, dimensions.chunkCount);
+        chunkManager.initializeChunks();
+
+        const auto worldSize = chunkManager.getWorldSize();
+        std::vector<VSBlockID> blocks(glm::compMul(worldSize));
+        for (auto& blockID : blocks)
+        {
+            blockID = randomEngine() % 3 == 0 ? 1 : VS_DEFAULT_BLOCK_ID;
+        }
+        chunkManager.setBlocks(-worldSize / 2, worldSize, blocks.data());
+
+        comparison = chunkManager.compareVisibilityKernels();
+        std::cout << "Random " << dimensions.chunkSize.x << " wide chunks: scalar "
+                  << comparison.scalarMicroseconds << " us, bitmask "
+                  << comparison.bitmaskMicroseconds << " us per chunk\n";
+        VS_CHECK_EXPECT(comparison.bDoKernelsMatchReference);
+    }
+}
+
+VS_CHECK(cached_light_matches_reference)
+{
+    VSChunkManager chunkManager(false);
+    buildWorld(chunkManager);
+
+    // A corner chunk at the world border and one surrounded by neighbours
+    VS_CHECK_EXPECT(chunkManager.validateLightInformation(0));
+    VS_CHECK_EXPECT(chunkManager.validateLightInformation(5));
+}
+
+VS_CHECK(shadow_transform_matches_brute_force)
+{
+    VSChunkManager chunkManager(false);
+    buildWorld(chunkManager);
+
+    // The brute force kernel is slow, a corner chunk at the world border and one surrounded by
+    // neighbours
+    for (const std::size_t chunkIndex : {0, 5})
+    {
+        const auto comparison = chunkManager.validateDistanceField(chunkIndex);
+        std::cout << "Generated chunk " << chunkIndex << ": brute force "
+                  << comparison.bruteForceMicroseconds << " us, transform "
+                  << comparison.transformMicroseconds << " us\n";
+        VS_CHECK_EXPECT(comparison.bDoKernelsMatch);
+    }
+
+    // Random blocks put hidden and visible blocks against every world border
+    constexpr int chunkCountXZ = 4;
+    chunkManager.setChunkDimensions({16, 32, 16}, {chunkCountXZ, chunkCountXZ});
+    chunkManager.initializeChunks();
+
+    const auto worldSize = chunkManager.getWorldSize();
+    std::vector<VSBlockID> blocks(glm::compMul(worldSize));
+    std::mt19937 randomEngine(13);
+    for (auto& blockID : blocks)
+    {
+        blockID = randomEngine() % 3 == 0 ? 1 : VS_DEFAULT_BLOCK_ID;
+    }
+    chunkManager.setBlocks(-worldSize / 2, worldSize, blocks.data());
+
+    for (std::size_t chunkIndex = 0; chunkIndex < chunkCountXZ * chunkCountXZ; chunkIndex++)
+    {
+        const auto comparison = chunkManager.validateDistanceField(chunkIndex);
+        std::cout << "Random chunk " << chunkIndex << ": brute force "
+                  << comparison.bruteForceMicroseconds << " us, transform "
+                  << comparison.transformMicroseconds << " us\n";
+        VS_CHECK_EXPECT(comparison.bDoKernelsMatch);
+    }
+}
+
+namespace
+{
+    // A few frames of strokes of close edits anywhere in the world, against the world border
+    // too. The edits of distant strokes get separate boxes.
+    void validateShadowStrokes(VSChunkManager& chunkManager, std::mt19937& randomEngine)
+    {
+        const auto worldSize = chunkManager.getWorldSize();
+        std::uniform_int_distribution<int> strokeDistribution(-3, 3);
+        for (int frameIndex = 0; frameIndex < 6; frameIndex++)
+        {
+            std::vector<std::pair<glm::ivec3, VSBlockID>> edits;
+            for (int strokeIndex = 0; strokeIndex < 1 + frameIndex % 4; strokeIndex++)
+            {
+                const glm::ivec3 strokeCenter(
+                    randomEngine() % worldSize.x,
+                    randomEngine() % worldSize.y,
+                    randomEngine() % worldSize.z);
+                for (int editIndex = 0; editIndex < 20; editIndex++)
+                {
+                    const auto location = glm::clamp(
+                        strokeCenter + glm::ivec3(
+                                           strokeDistribution(randomEngine),
+                                           strokeDistribution(randomEngine),
+                                           strokeDistribution(randomEngine)),
+                        glm::ivec3(0),
+                        worldSize - 1);
+                    const VSBlockID blockID = randomEngine() % 2 == 0 ? 1 : VS_DEFAULT_BLOCK_ID;
+                    edits.emplace_back(location - worldSize / 2, blockID);
+                }
+            }
+            VS_CHECK_EXPECT(chunkManager.validateShadowRegions(edits));
+        }
+    }
+}  // namespace
+
+VS_CHECK(shadow_regions_match_full_rebuild)
+{
+    VSChunkManager chunkManager(false);
+    buildWorld(chunkManager);
+
+    std::mt19937 randomEngine(17);
+    validateShadowStrokes(chunkManager, randomEngine);
+
+    // Sparse random blocks leave most distances short of maxShadowDistance, so a box that is too
+    // small shows up
+    chunkManager.setChunkDimensions({32, 64, 32}, {2, 2});
+    chunkManager.initializeChunks();
+
+    const auto worldSize = chunkManager.getWorldSize();
+    std::vector<VSBlockID> blocks(glm::compMul(worldSize));
+    for (auto& blockID : blocks)
+    {
+        blockID = randomEngine() % 64 == 0 ? 1 : VS_DEFAULT_BLOCK_ID;
+    }
+    chunkManager.setBlocks(-worldSize / 2, worldSize, blocks.data());
+    validateShadowStrokes(chunkManager, randomEngine);
+}
@@ -0,0 +1,96 @@
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "world/generator/vs_heightmap.h"
+
+#include "vs_check.h"
+
+namespace
+{
+    // Settings of the terrain builders, world height 128
+    VSHeightmap heightmaps[] = {
+        VSHeightmap(32, 3, 0.005F, 32, 2.F, 0.5F, 1),
+        VSHeightmap(64, 2, 0.02F, 64, 2.F, 0.125F, 2),
+        VSHeightmap(128, 4, 0.01F, 128, 1.F, 0.5F, 3),
+        VSHeightmap(12, 2, 0.02F, 10.F, 0.5F, 2.F, 4)};
+}  // namespace
+
+VS_CHECK(heightmap_single_matches_tile)
+{
+    // Odd width so the last step of a row has unused lanes, negative like most of a world
+    const glm::ivec2 tileMin = {-261, -75};
+    const glm::ivec2 tileSize = {67, 33};
+
+    std::vector<float> heights(static_cast<std::size_t>(tileSize.x) * tileSize.y);
+    std::vector<int> voxelHeights(heights.size());
+    for (auto& heightmap : heightmaps)
+    {
+        heightmap.getHeights(tileMin, tileSize, heights.data());
+        heightmap.getVoxelHeights(tileMin, tileSize, voxelHeights.data());
+
+        for (int y = 0; y < tileSize.y; y++)
+        {
+            for (int x = 0; x < tileSize.x; x++)
+            {
+                const auto sampleIndex = x + y * tileSize.x;
+                const float height = heightmap.getHeight(tileMin.x + x, tileMin.y + y);
+                VS_CHECK_EXPECT(std::memcmp(&height, &heights[sampleIndex], sizeof(float)) == 0);
+                VS_CHECK_EXPECT(
+                    heightmap.getVoxelHeight(tileMin.x + x, tileMin.y + y) ==
+                    voxelHeights[sampleIndex]);
+            }
+        }
+    }
+}
+
+// Voxel heights are compared by runBenchmark, see noise_benchmark
+VS_CHECK(heightmap_matches_reference)
+{
+    // Chunk sized tiles around the origin, both signs of the noise coordinates
+    const glm::ivec2 tileSize = {32, 32};
+    std::vector<float> heights(static_cast<std::size_t>(tileSize.x) * tileSize.y);
+    for (const auto& heightmap : heightmaps)
+    {
+        for (int tileY = -4; tileY < 4; tileY++)
+        {
+            for (int tileX = -4; tileX < 4; tileX++)
+            {
+                const glm::ivec2 tileMin = glm::ivec2(tileX, tileY) * tileSize;
+                heightmap.getHeights(tileMin, tileSize, heights.data());
+
+                for (int y = 0; y < tileSize.y; y++)
+                {
+                    for (int x = 0; x < tileSize.x; x++)
+                    {
+                        const auto sampleIndex = x + y * tileSize.x;
+                        const float reference =
+                            heightmap.getReferenceHeight(tileMin.x + x, tileMin.y + y);
+                        VS_CHECK_EXPECT(
+                            std::abs(heights[sampleIndex] - reference) <=
+                            VSHeightmap::maxReferenceError);
+                    }
+                }
+            }
+        }
+    }
+}
+
+VS_CHECK(noise_benchmark)
+{
+    for (const auto& heightmap : heightmaps)
+    {
+        const auto result = heightmap.runBenchmark({32, 32}, 256);
+        std::cout << "glm::perlin: " << result.samplesPerSecond / 1e6F
+                  << " M samples/s, getHeights: " << result.batchedSamplesPerSecond / 1e6F
+                  << " M samples/s, max error " << result.maxError << ", voxel mismatches "
+                  << result.voxelHeightMismatchRatio * 100.F << "%\n";
+        VS_CHECK_EXPECT(result.maxError <= VSHeightmap::maxReferenceError);
+        VS_CHECK_EXPECT(
+            result.voxelHeightMismatchRatio <= VSHeightmap::maxVoxelHeightMismatchRatio);
+        VS_CHECK_EXPECT(result.maxVoxelHeightDifference <= 1);
+    }
+}
@@ -0,0 +1,82 @@
+#include <glad/glad.h>
+// Include glfw3.h after our OpenGL definitions
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+#include "world/generator/vs_terrain.h"
+#include "world/vs_chunk_manager.h"
+
+#include "vs_check.h"
+
+namespace
+{
+    constexpr std::uint32_t worldSeed = 1234;
+
+    // A hidden window for the GL context, the checks render to offscreen framebuffers.
+    // Terminates GLFW when a check returns or fails.
+    struct VSHiddenContext
+    {
+        GLFWwindow* window = nullptr;
+
+        VSHiddenContext()
+        {
+            if (glfwInit() == 0)
+            {
+                return;
+            }
+
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+            window = glfwCreateWindow(64, 64, "voxelscape_checks", nullptr, nullptr);
+            if (window != nullptr)
+            {
+                glfwMakeContextCurrent(window);
+            }
+        }
+
+        ~VSHiddenContext()
+        {
+            if (window != nullptr)
+            {
+                glfwDestroyWindow(window);
+            }
+            glfwTerminate();
+        }
+
+        VSHiddenContext(VSHiddenContext const&) = delete;
+        VSHiddenContext& operator=(VSHiddenContext const&) = delete;
+    };
+}  // namespace
+
+// Needs a display, without a GPU run it under xvfb-run. ctest picks Mesa's llvmpipe.
+VS_CHECK(draw_paths_render_identically)
+{
+    const VSHiddenContext context;
+    VS_CHECK_EXPECT(context.window != nullptr);
+    VS_CHECK_EXPECT(gladLoadGL() != 0);
+    VS_CHECK_EXPECT(GLAD_GL_VERSION_4_3 != 0);
+
+    // Destroyed before the context
+    VSChunkManager chunkManager(true);
+    chunkManager.setChunkDimensions({32, 128, 32}, {4, 4});
+    chunkManager.initializeChunks();
+    VSTerrainGeneration::buildMountains(&chunkManager, worldSeed);
+
+    // Looking down at the whole world from above a corner
+    const auto worldSize = glm::vec3(chunkManager.getWorldSize());
+    const auto viewPos = worldSize * glm::vec3(0.75F, 0.6F, 0.75F);
+    const auto VP = glm::perspective(glm::radians(60.F), 1.F, 0.1F, 1000.F) *
+                    glm::lookAt(viewPos, glm::vec3(0.F), glm::vec3(0.F, 1.F, 0.F));
+
+    const auto comparison = chunkManager.compareDrawPaths(viewPos, VP, {256, 256});
+    std::cout << "Instanced: " << comparison.instancedDrawCallCount
+              << " draw calls, multi draw indirect: " << comparison.multiIndirectDrawCallCount
+              << " draw calls, " << comparison.coveredPixelCount << " covered pixels\n";
+    VS_CHECK_EXPECT(comparison.coveredPixelCount > 0);
+    VS_CHECK_EXPECT(comparison.multiIndirectDrawCallCount == 1);
+    VS_CHECK_EXPECT(comparison.bDoPathsMatch);
+}
@@ -0,0 +1,68 @@
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+#include "world/generator/vs_terrain.h"
+#include "world/vs_chunk_manager.h"
+
+#include "vs_check.h"
+
+namespace
+{
+    // Golden hashes of every biome at one seed and size. A change of the generation that is
+    // meant to change the worlds has to update them in the same commit.
+    constexpr std::uint32_t goldenSeed = 1234;
+    constexpr glm::ivec3 goldenChunkSize = {32, 128, 32};
+    constexpr glm::ivec2 goldenChunkCount = {4, 4};
+
+    struct VSGoldenWorld
+    {
+        const char* biomeName;
+        void (*build)(VSChunkManager* chunkManager, std::uint32_t seed);
+        std::uint64_t blockHash;
+    };
+
+    const VSGoldenWorld goldenWorlds[] = {
+        {"standard", &VSTerrainGeneration::buildStandard, 0x63219A9CD8F6861EULL},
+        {"mountains", &VSTerrainGeneration::buildMountains, 0x086D883F1C4342B4ULL},
+        {"desert", &VSTerrainGeneration::buildDesert, 0xB8D9B4439BC89CF5ULL}};
+}  // namespace
+
+VS_CHECK(terrain_golden_hashes)
+{
+    VSChunkManager chunkManager(false);
+
+    bool bHasFailed = false;
+    for (const auto& goldenWorld : goldenWorlds)
+    {
+        chunkManager.setChunkDimensions(goldenChunkSize, goldenChunkCount);
+        chunkManager.initializeChunks();
+        goldenWorld.build(&chunkManager, goldenSeed);
+
+        const auto blockHash = chunkManager.computeBlockHash();
+        std::cout << goldenWorld.biomeName << " seed " << goldenSeed << ": block hash 0x"
+                  << std::hex << std::setw(16) << std::setfill('0') << blockHash << std::dec
+                  << "\n";
+        bHasFailed = bHasFailed || blockHash != goldenWorld.blockHash;
+    }
+
+    VS_CHECK_EXPECT(!bHasFailed);
+}
+
+VS_CHECK(terrain_same_seed_same_world)
+{
+    VSChunkManager chunkManager(false);
+
+    for (const auto& goldenWorld : goldenWorlds)
+    {
+        chunkManager.setChunkDimensions(goldenChunkSize, goldenChunkCount);
+        chunkManager.initializeChunks();
+        goldenWorld.build(&chunkManager, goldenSeed + 1);
+        const auto firstBlockHash = chunkManager.computeBlockHash();
+
+        chunkManager.setChunkDimensions(goldenChunkSize, goldenChunkCount);
+        chunkManager.initializeChunks();
+        goldenWorld.build(&chunkManager, goldenSeed + 1);
+        VS_CHECK_EXPECT(chunkManager.computeBlockHash() == firstBlockHash);
+    }
+}